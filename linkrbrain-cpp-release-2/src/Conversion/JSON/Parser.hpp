@@ -0,0 +1,379 @@
+#ifndef CPPP____INCLUDE____CONVERSION__JSON__PARSER_HPP
+#define CPPP____INCLUDE____CONVERSION__JSON__PARSER_HPP
+
+
+#include "Types/Variant.hpp"
+#include "Exceptions/GenericExceptions.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+
+
+namespace Conversion::JSON {
+
+
+    // single-pass recursive descent parser, writing straight into a variant
+    //
+    // Follows RFC 8259, with the exception of `NaN`, `Infinity` & `-Infinity`, which are
+    // accepted because `Writer` spells non-finite floating values that way, so that what
+    // it writes can be read back. Nesting depth & document size are limited, so that
+    // request bodies cannot exhaust the stack or the memory of the server.
+
+    class Parser {
+    public:
+
+        static const size_t default_max_depth = 512;
+
+        Parser(const size_t max_depth=default_max_depth, const size_t max_size=std::numeric_limits<size_t>::max()) :
+            _max_depth(max_depth),
+            _max_size(max_size) {}
+
+        void parse(const std::string_view source, Types::Variant& destination) {
+            if (source.size() > _max_size) {
+                throw Exceptions::BadDataException("JSON document is too large", {
+                    {"size", (int64_t) source.size()},
+                    {"max_size", (int64_t) _max_size}
+                });
+            }
+            _begin = _current = source.data();
+            _end = source.data() + source.size();
+            _depth = 0;
+            skip_whitespace();
+            parse_value(destination);
+            skip_whitespace();
+            if (_current != _end) {
+                fail("unexpected data after value");
+            }
+        }
+
+        inline const size_t get_max_depth() const {
+            return _max_depth;
+        }
+        inline const size_t get_max_size() const {
+            return _max_size;
+        }
+
+    private:
+
+        [[noreturn]] void fail(const std::string& reason) const {
+            throw Exceptions::BadDataException("Error while parsing JSON: " + reason, {
+                {"offset", (int64_t) (_current - _begin)},
+                {"depth", (int64_t) _depth}
+            });
+        }
+
+        inline void skip_whitespace() {
+            while (_current != _end && (*_current == ' ' || *_current == '\n' || *_current == '\r' || *_current == '\t')) {
+                ++_current;
+            }
+        }
+        inline void expect(const char* literal, const size_t size) {
+            if ((size_t) (_end - _current) < size || std::string_view(_current, size) != std::string_view(literal, size)) {
+                fail("invalid literal");
+            }
+            _current += size;
+        }
+        static inline const bool is_digit(const char c) {
+            return c >= '0' && c <= '9';
+        }
+        static inline const bool is_number_start(const char c) {
+            return is_digit(c) || c == '-';
+        }
+
+        void parse_value(Types::Variant& destination) {
+            if (_current == _end) {
+                fail("unexpected end of data");
+            }
+            switch (*_current) {
+                case '{':
+                    parse_object(destination);
+                    break;
+                case '[':
+                    parse_array(destination);
+                    break;
+                case '"':
+                    parse_string(destination.emplace<Types::Variant::String>());
+                    break;
+                case 't':
+                    expect("true", 4);
+                    destination.emplace<Types::Variant::Boolean>(true);
+                    break;
+                case 'f':
+                    expect("false", 5);
+                    destination.emplace<Types::Variant::Boolean>(false);
+                    break;
+                case 'n':
+                    expect("null", 4);
+                    destination.emplace<Types::Variant::Null>();
+                    break;
+                case 'N':
+                    expect("NaN", 3);
+                    destination.emplace<Types::Variant::Floating>(std::numeric_limits<double>::quiet_NaN());
+                    break;
+                case 'I':
+                    expect("Infinity", 8);
+                    destination.emplace<Types::Variant::Floating>(std::numeric_limits<double>::infinity());
+                    break;
+                default:
+                    if (is_number_start(*_current)) {
+                        parse_number(destination);
+                    } else {
+                        fail("unexpected character");
+                    }
+            }
+        }
+
+        // containers
+
+        void enter() {
+            if (++_depth > _max_depth) {
+                fail("maximum depth exceeded");
+            }
+            ++_current;
+            skip_whitespace();
+        }
+        // returns true when the container goes on
+        inline const bool next(const char closing) {
+            skip_whitespace();
+            if (_current != _end) {
+                if (*_current == ',') {
+                    ++_current;
+                    skip_whitespace();
+                    return true;
+                }
+                if (*_current == closing) {
+                    ++_current;
+                    --_depth;
+                    return false;
+                }
+            }
+            fail(closing == ']' ? "expected `,` or `]` in array" : "expected `,` or `}` in object");
+        }
+
+        void parse_object(Types::Variant& destination) {
+            Types::VariantMap& map = destination.emplace<Types::Variant::Map>();
+            enter();
+            if (_current != _end && *_current == '}') {
+                ++_current;
+                --_depth;
+                return;
+            }
+            std::string key;
+            do {
+                if (_current == _end || *_current != '"') {
+                    fail("expected string as object key");
+                }
+                parse_string(key);
+                skip_whitespace();
+                if (_current == _end || *_current != ':') {
+                    fail("expected `:` after object key");
+                }
+                ++_current;
+                skip_whitespace();
+                // like other parsers, the last duplicate key wins
+                parse_value(map[key]);
+            } while (next('}'));
+        }
+
+        // items are gathered in a buffer specific to the current depth, then moved at
+        // once into a vector of the right size; numbers, which make up point lists, skip
+        // the generic dispatch
+        void parse_array(Types::Variant& destination) {
+            enter();
+            if (_current != _end && *_current == ']') {
+                ++_current;
+                --_depth;
+                destination.emplace<Types::Variant::Vector>();
+                return;
+            }
+            // buffers are reused all along, so they are kept out of any arena
+            while (_items.size() < _depth) {
+                _items.emplace_back(Types::VariantAllocator<Types::Variant>(std::pmr::new_delete_resource()));
+            }
+            Types::VariantVector& items = _items[_depth - 1];
+            items.clear();
+            do {
+                Types::Variant& item = items.emplace_back();
+                if (_current != _end && is_number_start(*_current)) {
+                    parse_number(item);
+                } else {
+                    parse_value(item);
+                }
+            } while (next(']'));
+            destination.emplace<Types::Variant::Vector>(
+                std::make_move_iterator(items.begin()),
+                std::make_move_iterator(items.end()));
+        }
+
+        // scalars
+
+        void parse_number(Types::Variant& destination) {
+            const char* start = _current;
+            if (*_current == '-') {
+                if (++_current != _end && *_current == 'I') {
+                    expect("Infinity", 8);
+                    destination.emplace<Types::Variant::Floating>(-std::numeric_limits<double>::infinity());
+                    return;
+                }
+            }
+            // validate the grammar first, as `from_chars` is more permissive
+            if (_current == _end || !is_digit(*_current)) {
+                fail("invalid number");
+            }
+            if (*_current++ != '0') {
+                while (_current != _end && is_digit(*_current)) {
+                    ++_current;
+                }
+            }
+            bool is_integer = true;
+            if (_current != _end && *_current == '.') {
+                is_integer = false;
+                if (++_current == _end || !is_digit(*_current)) {
+                    fail("invalid number");
+                }
+                while (_current != _end && is_digit(*_current)) {
+                    ++_current;
+                }
+            }
+            if (_current != _end && (*_current == 'e' || *_current == 'E')) {
+                is_integer = false;
+                if (++_current != _end && (*_current == '+' || *_current == '-')) {
+                    ++_current;
+                }
+                if (_current == _end || !is_digit(*_current)) {
+                    fail("invalid number");
+                }
+                while (_current != _end && is_digit(*_current)) {
+                    ++_current;
+                }
+            }
+            // integers that do not fit are read as floating point numbers
+            if (is_integer) {
+                int64_t value;
+                if (std::from_chars(start, _current, value).ec == std::errc()) {
+                    destination.emplace<Types::Variant::Integer>(value);
+                    return;
+                }
+            }
+            double value;
+            if (std::from_chars(start, _current, value).ec != std::errc()) {
+                // out of range: let `strtod` decide between zero & infinity
+                value = std::strtod(std::string(start, _current).c_str(), NULL);
+            }
+            destination.emplace<Types::Variant::Floating>(value);
+        }
+
+        static inline const int hexadecimal_value(const char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+        const uint32_t parse_code_unit() {
+            if (_end - _current < 4) {
+                fail("invalid unicode escape");
+            }
+            uint32_t code_unit = 0;
+            for (int i=0; i<4; ++i) {
+                const int value = hexadecimal_value(*_current++);
+                if (value < 0) {
+                    fail("invalid unicode escape");
+                }
+                code_unit = (code_unit << 4) | value;
+            }
+            return code_unit;
+        }
+        static void append_utf8(std::string& destination, const uint32_t code_point) {
+            if (code_point < 0x80) {
+                destination += (char) code_point;
+            } else if (code_point < 0x800) {
+                destination += (char) (0xC0 | (code_point >> 6));
+                destination += (char) (0x80 | (code_point & 0x3F));
+            } else if (code_point < 0x10000) {
+                destination += (char) (0xE0 | (code_point >> 12));
+                destination += (char) (0x80 | ((code_point >> 6) & 0x3F));
+                destination += (char) (0x80 | (code_point & 0x3F));
+            } else {
+                destination += (char) (0xF0 | (code_point >> 18));
+                destination += (char) (0x80 | ((code_point >> 12) & 0x3F));
+                destination += (char) (0x80 | ((code_point >> 6) & 0x3F));
+                destination += (char) (0x80 | (code_point & 0x3F));
+            }
+        }
+
+        // bytes are copied as they are, by runs; escapes are decoded to UTF-8, and
+        // unpaired surrogates are kept as such
+        void parse_string(std::string& destination) {
+            destination.clear();
+            const char* run = ++_current;
+            while (true) {
+                while (_current != _end && *_current != '"' && *_current != '\\' && (unsigned char) *_current >= 0x20) {
+                    ++_current;
+                }
+                if (_current == _end) {
+                    fail("unterminated string");
+                }
+                destination.append(run, _current - run);
+                if (*_current == '"') {
+                    ++_current;
+                    return;
+                }
+                if (*_current != '\\') {
+                    fail("unescaped control character in string");
+                }
+                if (++_current == _end) {
+                    fail("unterminated string");
+                }
+                switch (*_current++) {
+                    case '"': destination += '"'; break;
+                    case '\\': destination += '\\'; break;
+                    case '/': destination += '/'; break;
+                    case 'b': destination += '\b'; break;
+                    case 'f': destination += '\f'; break;
+                    case 'n': destination += '\n'; break;
+                    case 'r': destination += '\r'; break;
+                    case 't': destination += '\t'; break;
+                    case 'u': {
+                        uint32_t code_point = parse_code_unit();
+                        if (code_point >= 0xD800 && code_point < 0xDC00 && _end - _current >= 6 && _current[0] == '\\' && _current[1] == 'u') {
+                            const char* low_start = _current;
+                            _current += 2;
+                            const uint32_t low = parse_code_unit();
+                            if (low >= 0xDC00 && low < 0xE000) {
+                                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                            } else {
+                                _current = low_start;
+                            }
+                        }
+                        append_utf8(destination, code_point);
+                        break;
+                    }
+                    default:
+                        --_current;
+                        fail("invalid escape sequence in string");
+                }
+                run = _current;
+            }
+        }
+
+        const size_t _max_depth;
+        const size_t _max_size;
+        const char* _begin;
+        const char* _current;
+        const char* _end;
+        size_t _depth;
+        // a deque, so that growing it keeps references to shallower buffers valid
+        std::deque<Types::VariantVector> _items;
+
+    };
+
+
+} // Conversion::JSON
+
+
+#endif // CPPP____INCLUDE____CONVERSION__JSON__PARSER_HPP
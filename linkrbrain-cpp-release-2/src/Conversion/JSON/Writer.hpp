@@ -0,0 +1,233 @@
+#ifndef CPPP____INCLUDE____CONVERSION__JSON__WRITER_HPP
+#define CPPP____INCLUDE____CONVERSION__JSON__WRITER_HPP
+
+
+#include "Types/Variant.hpp"
+#include "Types/DateTime.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+namespace Conversion::JSON {
+
+
+    // for every byte: 0 when it can be copied as is, otherwise the character following
+    // the backslash in its escape sequence ('u' for "\u00XX")
+
+    static constexpr std::array<char, 256> make_escapes() {
+        std::array<char, 256> escapes = {};
+        for (int c=0; c<0x20; ++c) {
+            escapes[c] = 'u';
+        }
+        escapes['\b'] = 'b';
+        escapes['\t'] = 't';
+        escapes['\n'] = 'n';
+        escapes['\f'] = 'f';
+        escapes['\r'] = 'r';
+        escapes['"'] = '"';
+        escapes['\\'] = '\\';
+        return escapes;
+    }
+    static constexpr std::array<char, 256> escapes = make_escapes();
+
+
+    // appends JSON to a string; when writing to a stream, the string serves as a buffer,
+    // flushed when it grows large and when the writer is destroyed
+
+    class Writer {
+    public:
+
+        static const size_t flush_size = 64 << 10;
+
+        Writer(std::string& destination) :
+            _stream(NULL),
+            _buffer(destination) {}
+        Writer(std::ostream& destination) :
+            _stream(&destination),
+            _buffer(_own_buffer)
+        {
+            _own_buffer.reserve(flush_size + 256);
+        }
+        Writer(const Writer&) = delete;
+        Writer& operator = (const Writer&) = delete;
+        ~Writer() {
+            flush();
+        }
+
+        void flush() {
+            if (_stream && !_buffer.empty()) {
+                _stream->write(_buffer.data(), _buffer.size());
+                _buffer.clear();
+            }
+        }
+
+        // scalars
+
+        void write(const bool source) {
+            if (source) {
+                _buffer.append("true", 4);
+            } else {
+                _buffer.append("false", 5);
+            }
+        }
+        template <typename T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value, int> = 0>
+        void write(const T source) {
+            char result[24];
+            const auto end = std::to_chars(result, result + sizeof(result), source).ptr;
+            _buffer.append(result, end - result);
+        }
+        // shortest representation that parses back to the same value; non-finite values
+        // are written the way `Parser` reads them
+        template <typename T, std::enable_if_t<std::is_floating_point<T>::value, int> = 0>
+        void write(const T source) {
+            if (std::isnan(source)) {
+                _buffer.append("NaN", 3);
+                return;
+            }
+            if (std::isinf(source)) {
+                if (source < 0) {
+                    _buffer.append("-Infinity", 9);
+                } else {
+                    _buffer.append("Infinity", 8);
+                }
+                return;
+            }
+            char result[32];
+            // large integral values would be read back as integers, and may overflow
+            const auto end = (std::abs(source) >= (T) 1e15 && std::trunc(source) == source)
+                ? std::to_chars(result, result + sizeof(result), source, std::chars_format::scientific).ptr
+                : std::to_chars(result, result + sizeof(result), source).ptr;
+            _buffer.append(result, end - result);
+        }
+        void write(const char source) {
+            write(std::string_view(&source, 1));
+        }
+        void write(const std::string_view source) {
+            _buffer += '"';
+            const char* run = source.data();
+            const char* const end = source.data() + source.size();
+            for (const char* c=run; c!=end; ++c) {
+                const char escape = escapes[(unsigned char) *c];
+                if (escape == 0) {
+                    continue;
+                }
+                // copy everything that did not need escaping at once
+                _buffer.append(run, c - run);
+                run = c + 1;
+                if (escape == 'u') {
+                    static const char hexadecimal[] = "0123456789abcdef";
+                    const char sequence[6] = {'\\', 'u', '0', '0', hexadecimal[(*c >> 4) & 0xF], hexadecimal[*c & 0xF]};
+                    _buffer.append(sequence, 6);
+                } else {
+                    const char sequence[2] = {'\\', escape};
+                    _buffer.append(sequence, 2);
+                }
+            }
+            _buffer.append(run, end - run);
+            _buffer += '"';
+        }
+        void write(const std::string& source) {
+            write(std::string_view(source));
+        }
+        void write(const char* source) {
+            write(std::string_view(source));
+        }
+        void write(const Types::DateTime& source) {
+            char result[48];
+            const int size = snprintf(result, sizeof(result), "\"%04d-%02d-%02dT%02d:%02d:%02d.%06d\"",
+                source.get_year(), source.get_month(), source.get_day(),
+                source.get_hour(), source.get_minute(), source.get_second(), source.get_microsecond());
+            _buffer.append(result, size);
+        }
+
+        // containers
+
+        template <typename Iterable>
+        void write_iterable(const Iterable& iterable) {
+            _buffer += '[';
+            bool is_first = true;
+            for (const auto& item : iterable) {
+                if (is_first) {
+                    is_first = false;
+                } else {
+                    _buffer += ',';
+                }
+                write(item);
+            }
+            _buffer += ']';
+        }
+        template <typename Map>
+        void write_map(const Map& map) {
+            _buffer += '{';
+            bool is_first = true;
+            for (const auto& [key, value] : map) {
+                if (is_first) {
+                    is_first = false;
+                } else {
+                    _buffer += ',';
+                }
+                write(key);
+                _buffer += ':';
+                write(value);
+            }
+            _buffer += '}';
+        }
+
+        // variant
+
+        void write(const Types::Variant& source) {
+            switch (source.get_type()) {
+                case Types::Variant::Undefined:
+                case Types::Variant::Null:
+                    _buffer.append("null", 4);
+                    break;
+                case Types::Variant::Boolean:
+                    write(source.get<Types::Variant::Boolean>());
+                    break;
+                case Types::Variant::Character:
+                    write(source.get<Types::Variant::Character>());
+                    break;
+                case Types::Variant::Integer:
+                    write(source.template get<int64_t>());
+                    break;
+                case Types::Variant::Floating:
+                    write(source.get<Types::Variant::Floating>());
+                    break;
+                case Types::Variant::String:
+                    write(source.get<Types::Variant::String>());
+                    break;
+                case Types::Variant::Vector:
+                    write_iterable(source.get<Types::Variant::Vector>());
+                    break;
+                case Types::Variant::Map:
+                    write_map(source.get<Types::Variant::Map>());
+                    break;
+                case Types::Variant::DateTime:
+                    write(source.get<Types::Variant::DateTime>());
+                    break;
+            }
+            if (_stream && _buffer.size() >= flush_size) {
+                flush();
+            }
+        }
+
+    private:
+
+        std::ostream* _stream;
+        std::string _own_buffer;
+        std::string& _buffer;
+
+    };
+
+
+} // Conversion::JSON
+
+
+#endif // CPPP____INCLUDE____CONVERSION__JSON__WRITER_HPP
@@ -10,6 +10,9 @@
 #include "Logging/Loggable.hpp"
 
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 
 namespace DB {
@@ -35,15 +38,22 @@ namespace DB {
             _pool_size = pool_size;
         }
 
+        // connections are not shared between threads (HTTP server threads, background jobs...),
+        // so each thread gets its own one, opened on first use
+
         Connection& get_connection() {
-            if (_pool.size() == 0) {
-                _pool.push_back(
-                    std::shared_ptr<Connection>(
-                        _make_connection()
-                    )
-                );
+            std::lock_guard<std::mutex> lock(_pool_mutex);
+            const auto it = _threads_connections.find(std::this_thread::get_id());
+            if (it != _threads_connections.end()) {
+                return * it->second;
             }
-            return * _pool[0];
+            _pool.push_back(
+                std::shared_ptr<Connection>(
+                    _make_connection()
+                )
+            );
+            _threads_connections.insert({std::this_thread::get_id(), _pool.back()});
+            return * _pool.back();
         }
 
     protected:
@@ -58,6 +68,8 @@ namespace DB {
         std::function<Connection*()> _make_connection;
         size_t _pool_size;
         std::vector<std::shared_ptr<Connection>> _pool;
+        std::unordered_map<std::thread::id, std::shared_ptr<Connection>> _threads_connections;
+        std::mutex _pool_mutex;
 
     };
 
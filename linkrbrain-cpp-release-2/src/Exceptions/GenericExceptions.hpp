@@ -51,10 +51,12 @@ namespace Exceptions {
     EXCEPTIONS__BASEEXCEPTIONS__DEFINE(ConflictException, 409)
     EXCEPTIONS__BASEEXCEPTIONS__DEFINE(ForbiddenException, 403)
     EXCEPTIONS__BASEEXCEPTIONS__DEFINE(BadDataException, 400)
+    EXCEPTIONS__BASEEXCEPTIONS__DEFINE(PayloadTooLargeException, 413)
     EXCEPTIONS__BASEEXCEPTIONS__DEFINE(UnauthorizedException, 401)
     EXCEPTIONS__BASEEXCEPTIONS__DEFINE(DatabaseException, 500)
     EXCEPTIONS__BASEEXCEPTIONS__DEFINE(NotImplementedException, 418)
     EXCEPTIONS__BASEEXCEPTIONS__DEFINE(NetworkException, 503)
+    EXCEPTIONS__BASEEXCEPTIONS__DEFINE(UnavailableException, 503)
 
 } // Exceptions
 
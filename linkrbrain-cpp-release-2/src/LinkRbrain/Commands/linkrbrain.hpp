@@ -14,13 +14,15 @@ namespace LinkRbrain::Commands {
 
     typedef double T;
     static std::string data_path;
+    static LinkRbrain::Scoring::Caching::Type caching_type = LinkRbrain::Scoring::Caching::Mmap;
+    static bool cache_lock = false;
     static bool debug = false;
 
     LinkRbrain::Controllers::DataController<T>& _get_data_controller() {
         static std::shared_ptr<LinkRbrain::Controllers::DataController<T>> data_controller;
         if (!data_controller) {
             data_controller.reset(
-                new LinkRbrain::Controllers::DataController<T>(data_path)
+                new LinkRbrain::Controllers::DataController<T>(data_path, caching_type, cache_lock)
             );
         }
         return *data_controller;
@@ -99,6 +101,8 @@ namespace LinkRbrain::Commands {
         }
         // data location
         data_path = options.get("data");
+        caching_type = LinkRbrain::Scoring::Caching::get_type_from_string(options.get("cache-type"));
+        cache_lock = options.has("cache-lock");
     }
 
 
@@ -221,6 +221,16 @@ namespace LinkRbrain::Commands {
         std::cout << "New name is '" << new_name << "'.\n";
     }
 
+    void dataset_compact_cache(const CLI::Arguments::CommandResult& options) {
+        // retrieve organ & dataset controller
+        auto& organ_controller = _get_organ_controller(options.get("organ"));
+        auto& dataset_controller = _get_dataset_controller(organ_controller, options.get("dataset"));
+        // compact caches
+        std::cout << "Compacting correlator caches of dataset '" << dataset_controller.get_instance().get_label() << "' with identifier " << dataset_controller.get_instance().get_id() << "\n...";
+        dataset_controller.compact_correlator_caches();
+        std::cout << "Compacted caches can now be loaded with the sparse caching type.\n";
+    }
+
     const std::vector<Types::Point<T>> _get_input_points(LinkRbrain::Controllers::OrganController<T>& organ_controller, const CLI::Arguments::CommandResult& options) {
         const std::string source_type = options.get("source-type");
         // list of points
@@ -274,22 +284,7 @@ namespace LinkRbrain::Commands {
         }
     }
 
-    void dataset_query(const CLI::Arguments::CommandResult& options) {
-        // retrieve organ & dataset controller
-        auto& organ_controller = _get_organ_controller(options.get("organ"));
-        auto& dataset_controller = _get_dataset_controller(organ_controller, options.get("dataset"));
-        // make query
-        Models::Query query;
-        query.settings["correlations"]["limit"] = std::stoi(options.get("limit"));
-        query.groups.push_back({{"label", "Group 0"}});
-        // make query group
-        auto& query_group_points = query.groups[0]["points"];
-        query_group_points.set_vector();
-        for (const auto& point : _get_input_points(organ_controller, options)) {
-            query_group_points.push_back(point.values);
-        }
-        // compute query correlations (and graph if requested)
-        dataset_controller.compute(query, options.has("with-graph"));
+    void _show_query(const Models::Query& query, LinkRbrain::Controllers::DatasetController<T>& dataset_controller, const CLI::Arguments::CommandResult& options) {
         // show correlations results
         if (options.get("format") == "json") {
             Conversion::JSON::serialize(std::cout, query.correlations);
@@ -337,6 +332,54 @@ namespace LinkRbrain::Commands {
         }
     }
 
+    // a batch file is a JSON list of queries, formatted like the ones sent to the web API,
+    // i.e. objects with "groups" (each one with "label" & "points") and optional "settings"
+
+    void _dataset_query_batch(LinkRbrain::Controllers::DatasetController<T>& dataset_controller, const CLI::Arguments::CommandResult& options) {
+        Types::Variant batch = Conversion::JSON::parse_file<Types::Variant>(options.get("source-batch"));
+        if (batch.get_type() != Types::Variant::Vector) {
+            throw Exceptions::BadDataException("Batch file should contain a list of queries: " + options.get("source-batch"), {});
+        }
+        std::vector<Models::Query> queries(batch.size());
+        for (size_t i = 0; i < queries.size(); i++) {
+            queries[i].groups = batch[i]["groups"];
+            queries[i].settings = batch[i].get("settings", Types::VariantMap());
+            if (!queries[i].settings.get("correlations", Types::VariantMap()).has("limit")) {
+                queries[i].settings["correlations"]["limit"] = std::stoi(options.get("limit"));
+            }
+        }
+        // compute query correlations (and graph if requested)
+        dataset_controller.compute_batch(queries, options.has("with-graph"));
+        for (size_t i = 0; i < queries.size(); i++) {
+            std::cout << "Query #" << i << ":\n";
+            _show_query(queries[i], dataset_controller, options);
+        }
+    }
+
+    void dataset_query(const CLI::Arguments::CommandResult& options) {
+        // retrieve organ & dataset controller
+        auto& organ_controller = _get_organ_controller(options.get("organ"));
+        auto& dataset_controller = _get_dataset_controller(organ_controller, options.get("dataset"));
+        // several queries at once
+        if (options.get("source-type") == "batch") {
+            _dataset_query_batch(dataset_controller, options);
+            return;
+        }
+        // make query
+        Models::Query query;
+        query.settings["correlations"]["limit"] = std::stoi(options.get("limit"));
+        query.groups.push_back({{"label", "Group 0"}});
+        // make query group
+        auto& query_group_points = query.groups[0]["points"];
+        query_group_points.set_vector();
+        for (const auto& point : _get_input_points(organ_controller, options)) {
+            query_group_points.push_back(point.values);
+        }
+        // compute query correlations (and graph if requested)
+        dataset_controller.compute(query, options.has("with-graph"));
+        _show_query(query, dataset_controller, options);
+    }
+
 } // LinkRbrain::Commands
 
 
@@ -21,11 +21,24 @@ namespace LinkRbrain::Commands {
             DB::get_type_from_string(options.get_parent().get_parent().get("db-type")),
             options.get_parent().get_parent().get("db-connection")
         );
+        app.set_caching_type(caching_type, cache_lock);
+        app.set_http_threads_count(std::stoul(options.get("http-threads")));
+        app.set_jobs_configuration(
+            std::stoul(options.get("jobs-workers")),
+            std::stoul(options.get("jobs-queue-size"))
+        );
+        app.set_pdf_configuration(
+            std::stoul(options.get("pdf-workers")),
+            std::stoul(options.get("pdf-queue-size")),
+            (uintmax_t) std::stoul(options.get("pdf-cache-size")) << 20,
+            std::chrono::hours(std::stoul(options.get("pdf-cache-age")))
+        );
         // start!
         std::cout << "Starting webserver...\n";
         app.start(true);
         app.get_http_controller().get_server().set_server_caching(options.has("server-caching"));
         app.get_http_controller().get_server().set_client_caching(options.has("client-caching"));
+        app.get_http_controller().get_server().set_gzip_responses(options.has("gzip"));
         std::cout << "Started webserver on port " << app.get_http_controller().get_server().get_port() << ", press ENTER to stop\n";
         getc(stdin);
     }
@@ -11,6 +11,8 @@ namespace LinkRbrain::Controllers {
 #include "./DataController.hpp"
 #include "./DBController.hpp"
 #include "./TokensController.hpp"
+#include "./JobsController.hpp"
+#include "./PdfController.hpp"
 #include "./HTTPController.hpp"
 #include "../Socket/Server.hpp"
 
@@ -33,7 +35,16 @@ namespace LinkRbrain::Controllers {
             _socket_path(socket_path),
             _data_path(data_path),
             _db_type(db_type),
-            _db_connection_string(db_connection_string)
+            _db_connection_string(db_connection_string),
+            _jobs_workers_count(1),
+            _jobs_max_queued_count(64),
+            _pdf_workers_count(1),
+            _pdf_max_queued_count(16),
+            _pdf_max_cache_size(512 << 20),
+            _pdf_max_cache_age(std::chrono::hours(7 * 24)),
+            _http_threads_count(std::max(1u, std::thread::hardware_concurrency())),
+            _caching_type(Scoring::Caching::Mmap),
+            _cache_lock(false)
         {
             _socket.reset(new LinkRbrain::Socket::Server<T>(_socket_path, *this));
             _socket->start();
@@ -89,6 +100,18 @@ namespace LinkRbrain::Controllers {
             }
             return *_tokens;
         }
+        JobsController& get_jobs_controller() {
+            if (!_jobs) {
+                throw Exceptions::Exception("Jobs controller is unavailable");
+            }
+            return *_jobs;
+        }
+        PdfController& get_pdf_controller() {
+            if (!_pdf) {
+                throw Exceptions::Exception("PDF controller is unavailable");
+            }
+            return *_pdf;
+        }
         HTTPController<T>& get_http_controller() {
             if (!_http) {
                 throw Exceptions::Exception("HTTP controller is unavailable");
@@ -96,15 +119,46 @@ namespace LinkRbrain::Controllers {
             return *_http;
         }
 
+        // only taken into account on next start
+
+        void set_jobs_configuration(const size_t workers_count, const size_t max_queued_count) {
+            _jobs_workers_count = workers_count;
+            _jobs_max_queued_count = max_queued_count;
+        }
+        void set_pdf_configuration(const size_t workers_count, const size_t max_queued_count, const uintmax_t max_cache_size=512 << 20, const std::chrono::seconds max_cache_age=std::chrono::hours(7 * 24)) {
+            _pdf_workers_count = workers_count;
+            _pdf_max_queued_count = max_queued_count;
+            _pdf_max_cache_size = max_cache_size;
+            _pdf_max_cache_age = max_cache_age;
+        }
+
+        // type of the correlator caches loaded with datasets
+
+        void set_caching_type(const Scoring::Caching::Type caching_type, const bool cache_lock=false) {
+            _caching_type = caching_type;
+            _cache_lock = cache_lock;
+        }
+
+        // number of threads answering HTTP requests
+
+        void set_http_threads_count(const size_t http_threads_count) {
+            _http_threads_count = http_threads_count ? http_threads_count : std::max(1u, std::thread::hardware_concurrency());
+        }
+        const size_t& get_http_threads_count() const {
+            return _http_threads_count;
+        }
+
         void start(const bool with_socket=false) {
             if (_status != Stopped) {
                 throw Exceptions::Exception("AppController cannot be started from current status '" + get_status_name(_status) + "'");
             }
             _status = Starting;
             try {
-                _data.reset(new DataController<T>(_data_path));
+                _data.reset(new DataController<T>(_data_path, _caching_type, _cache_lock));
                 _db.reset(new DBController(_db_type, _db_connection_string));
                 _tokens.reset(new TokensController());
+                _jobs.reset(new JobsController(_jobs_workers_count, _jobs_max_queued_count));
+                _pdf.reset(new PdfController("tmp/pdf", _pdf_workers_count, _pdf_max_queued_count, _pdf_max_cache_size, _pdf_max_cache_age));
                 _http.reset(new HTTPController<T>(*this));
                 if (with_socket) {
                     _socket.reset(new LinkRbrain::Socket::Server<T>(_socket_path, *this));
@@ -123,6 +177,8 @@ namespace LinkRbrain::Controllers {
             _status = Stopping;
             try {
                 _http.reset();
+                _pdf.reset();
+                _jobs.reset();
                 _tokens.reset();
                 _db.reset();
                 _data.reset();
@@ -154,10 +210,21 @@ namespace LinkRbrain::Controllers {
         const std::filesystem::path _data_path;
         const DB::Type _db_type;
         const std::string _db_connection_string;
+        size_t _jobs_workers_count;
+        size_t _jobs_max_queued_count;
+        size_t _pdf_workers_count;
+        size_t _pdf_max_queued_count;
+        uintmax_t _pdf_max_cache_size;
+        std::chrono::seconds _pdf_max_cache_age;
+        size_t _http_threads_count;
+        Scoring::Caching::Type _caching_type;
+        bool _cache_lock;
         // Components
         std::unique_ptr<DataController<T>> _data;
         std::unique_ptr<DBController> _db;
         std::unique_ptr<TokensController> _tokens;
+        std::unique_ptr<JobsController> _jobs;
+        std::unique_ptr<PdfController> _pdf;
         std::unique_ptr<HTTPController<T>> _http;
         std::unique_ptr<LinkRbrain::Socket::Server<T>> _socket;
         // Others
@@ -3,6 +3,8 @@
 
 
 #include <set>
+#include <mutex>
+#include <shared_mutex>
 #include <filesystem>
 
 #include "Exceptions/Exception.hpp"
@@ -18,11 +20,15 @@
 
 namespace LinkRbrain::Controllers {
 
+    // organs & datasets can be added or removed by some requests while others look them up
+
     template <typename T>
     class DataController : public Logging::Loggable {
     public:
 
-        DataController(const std::filesystem::path& path) :
+        DataController(const std::filesystem::path& path, const Scoring::Caching::Type caching_type=Scoring::Caching::Mmap, const bool cache_lock=false) :
+            _caching_type(caching_type),
+            _cache_lock(cache_lock),
             _max_organ_id(0),
             _max_dataset_id(0)
         {
@@ -30,6 +36,7 @@ namespace LinkRbrain::Controllers {
         }
 
         void load(const std::filesystem::path& path) {
+            std::unique_lock<std::shared_mutex> lock(_mutex);
             _path = path;
             _organ_controllers.clear();
             std::filesystem::create_directories(path);
@@ -42,7 +49,7 @@ namespace LinkRbrain::Controllers {
                 if (entry.is_directory()) {
                     try {
                         _organ_controllers.push_back(
-                            std::make_shared<OrganController<T>>(organ_path)
+                            std::make_shared<OrganController<T>>(organ_path, _caching_type, _cache_lock)
                         );
                         auto& organ_controller = * _organ_controllers.back();
                         const size_t organ_id = organ_controller.get_instance().get_id();
@@ -61,6 +68,7 @@ namespace LinkRbrain::Controllers {
         }
 
         OrganController<T>& get_organ(const std::string& organ_label) {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
             for (auto& organ_controller : _organ_controllers) {
                 if (organ_controller->get_instance().get_label() == organ_label) {
                     return *organ_controller;
@@ -72,27 +80,20 @@ namespace LinkRbrain::Controllers {
             });
         }
         OrganController<T>& get_or_add_organ(const std::string& organ_label) {
+            std::unique_lock<std::shared_mutex> lock(_mutex);
             for (auto& organ_controller : _organ_controllers) {
                 if (organ_controller->get_instance().get_label() == organ_label) {
                     return *organ_controller;
                 }
             }
-            return add_organ(organ_label);
+            return add_organ_unlocked(organ_label);
         }
         OrganController<T>& add_organ(const std::string& organ_label) {
-            const size_t organ_id = ++_max_organ_id;
-            // build path
-            const std::filesystem::path organ_path
-                = _path / (std::to_string(organ_id) + "_" + organ_label + "_" + (std::string) Types::DateTime::now());
-            // instanciate corresponding controller
-            const size_t index = _organ_controllers.size();
-            _organ_controllers.push_back(
-                std::make_shared<OrganController<T>>(organ_id, organ_path, organ_label)
-            );
-            return * _organ_controllers[index];
+            std::unique_lock<std::shared_mutex> lock(_mutex);
+            return add_organ_unlocked(organ_label);
         }
-
         const bool has_organ(const std::string& organ_label) const {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
             for (auto& organ_controller : _organ_controllers) {
                 if (organ_controller->get_instance().get_label() == organ_label) {
                     return true;
@@ -101,6 +102,7 @@ namespace LinkRbrain::Controllers {
             return false;
         }
         OrganController<T>& get_organ(const size_t organ_id) {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
             for (auto& organ_controller : _organ_controllers) {
                 if (organ_controller->get_instance().get_id() == organ_id) {
                     return *organ_controller;
@@ -112,6 +114,7 @@ namespace LinkRbrain::Controllers {
             });
         }
         const std::vector<std::shared_ptr<OrganController<T>>> get_organs() const {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
             return _organ_controllers;
         }
 
@@ -119,6 +122,7 @@ namespace LinkRbrain::Controllers {
             // delete files
             organ_controller.remove();
             // remove from data controller collection
+            std::unique_lock<std::shared_mutex> lock(_mutex);
             for (auto it=_organ_controllers.begin(); it!=_organ_controllers.end(); ++it) {
                 if (it->get() == &organ_controller) {
                     _organ_controllers.erase(it);
@@ -128,6 +132,7 @@ namespace LinkRbrain::Controllers {
         }
 
         DatasetController<T>& add_dataset(OrganController<T>& organ_controller, const std::string& dataset_label) {
+            std::unique_lock<std::shared_mutex> lock(_mutex);
             organ_controller.add_dataset(++_max_dataset_id, dataset_label);
             _dataset_controllers.push_back(organ_controller.get_datasets().back());
             return * _dataset_controllers.back();
@@ -136,6 +141,7 @@ namespace LinkRbrain::Controllers {
             return add_dataset(get_organ(organ_id), dataset_label);
         }
         DatasetController<T>& get_dataset(const size_t dataset_id) {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
             for (const auto& dataset_controller : _dataset_controllers) {
                 if (dataset_controller->get_instance().get_id() == dataset_id) {
                     return *dataset_controller;
@@ -147,6 +153,7 @@ namespace LinkRbrain::Controllers {
             });
         }
         const std::vector<std::shared_ptr<DatasetController<T>>> get_datasets() const {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
             return _dataset_controllers;
         }
 
@@ -158,11 +165,29 @@ namespace LinkRbrain::Controllers {
 
     private:
 
+        // must be called with the mutex locked
+
+        OrganController<T>& add_organ_unlocked(const std::string& organ_label) {
+            const size_t organ_id = ++_max_organ_id;
+            // build path
+            const std::filesystem::path organ_path
+                = _path / (std::to_string(organ_id) + "_" + organ_label + "_" + (std::string) Types::DateTime::now());
+            // instanciate corresponding controller
+            const size_t index = _organ_controllers.size();
+            _organ_controllers.push_back(
+                std::make_shared<OrganController<T>>(organ_id, organ_path, organ_label)
+            );
+            return * _organ_controllers[index];
+        }
+
         std::filesystem::path _path;
+        const Scoring::Caching::Type _caching_type;
+        const bool _cache_lock;
         std::vector<std::shared_ptr<OrganController<T>>> _organ_controllers;
         std::vector<std::shared_ptr<DatasetController<T>>> _dataset_controllers;
         size_t _max_organ_id;
         size_t _max_dataset_id;
+        mutable std::shared_mutex _mutex;
 
     };
 
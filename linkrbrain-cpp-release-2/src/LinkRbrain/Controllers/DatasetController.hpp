@@ -2,8 +2,11 @@
 #define LINKRBRAIN2019__SRC__LINKRBRAIN__CONTROLLERS__DATASETCONTROLLER_HPP
 
 
+#include <cassert>
 #include <set>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <filesystem>
 
 #include "Exceptions/GenericExceptions.hpp"
@@ -32,8 +35,8 @@ namespace LinkRbrain::Controllers {
             std::filesystem::create_directories(path);
             get_logger().notice("Created dataset " + label + " with id " + std::to_string(id) + " at " + path.native());
         }
-        DatasetController(const std::filesystem::path& path) {
-            load(path);
+        DatasetController(const std::filesystem::path& path, const Scoring::Caching::Type caching_type=Scoring::Caching::Mmap, const bool cache_lock=false) {
+            load(path, caching_type, cache_lock);
         }
 
         // day-to-day operations
@@ -62,6 +65,19 @@ namespace LinkRbrain::Controllers {
             }
             return *_correlator;
         }
+        // once finished, the correlator is only read; computations hold their own reference to it,
+        // so that it can be replaced (e.g. reloaded) while they are running
+
+        std::shared_ptr<const Scoring::Correlator<T>> get_shared_correlator() const {
+            std::shared_lock<std::shared_mutex> lock(_correlator_mutex);
+            if (!_correlator) {
+                throw Exceptions::NotFoundException("Dataset " + _dataset->get_label() + " has not instanciated any correlator", {
+                    {"dataset", _dataset->get_label()},
+                    {"missing", "correlator"},
+                });
+            }
+            return _correlator;
+        }
 
         // initialization stuff
 
@@ -75,28 +91,32 @@ namespace LinkRbrain::Controllers {
             Conversion::Binary::serialize(buffer, *_dataset);
             get_logger().message("Saved " + _dataset->get_label() + " dataset to " + (_path / "data").native());
         }
+        // computing caches modifies the correlator in place, and should not happen while it is shared
+
         void finish_correlator() {
             if (get_correlator().get_status() < Scoring::Correlator<T>::Status::CachedPoints) {
                 get_correlator().compute_points_cache(Scoring::Caching::File, _path / "correlator" / "points_cache");
                 get_correlator().save_config(_path / "correlator");
             }
             if (get_correlator().get_status() < Scoring::Correlator<T>::Status::CachedGroups) {
-                get_correlator().compute_groups_cache(Scoring::Caching::File, _path / "correlator" / "groups_cache");
+                get_correlator().compute_groups_cache(Scoring::Caching::File, _path / "correlator" / "groups_cache", std::thread::hardware_concurrency(), 0, [this] {
+                    get_correlator().save_config(_path / "correlator");
+                });
                 get_correlator().save_config(_path / "correlator");
             }
         }
         void initialize_correlator(const T resolution, const Scoring::Scorer::Mode mode, const T diameter) {
-            _correlator.reset(
-                new Scoring::Correlator<T>(
-                    *_dataset,
-                    resolution,
-                    mode,
-                    diameter
-                )
-            );
+            set_correlator(std::make_shared<Scoring::Correlator<T>>(
+                *_dataset,
+                resolution,
+                mode,
+                diameter
+            ));
             get_correlator().save(_path / "correlator");
             get_correlator().compute_points_cache(Scoring::Caching::File, _path / "correlator" / "points_cache");
-            get_correlator().compute_groups_cache(Scoring::Caching::File, _path / "correlator" / "groups_cache");
+            get_correlator().compute_groups_cache(Scoring::Caching::File, _path / "correlator" / "groups_cache", std::thread::hardware_concurrency(), 0, [this] {
+                get_correlator().save_config(_path / "correlator");
+            });
             get_correlator().save_config(_path / "correlator");
         }
         const bool has_correlator() const {
@@ -128,6 +148,9 @@ namespace LinkRbrain::Controllers {
                 throw Exceptions::BadDataException("DatasetController::load_data could not open " + path.native());
             }
             _dataset.reset(new Models::Dataset<T>(file));
+            if (_correlator) {
+                _correlator->get_results_cache().invalidate();
+            }
             get_logger().notice("Loaded dataset data from file", path, "(with", _dataset->get_groups().size(), "groups)");
         }
         void load_data() {
@@ -136,25 +159,65 @@ namespace LinkRbrain::Controllers {
             }
             load_data(_path);
         }
-        void load_correlator(const std::filesystem::path& path) {
-            _correlator.reset(
-                new LinkRbrain::Scoring::Correlator<T>(*_dataset, path)
-            );
-            if (std::filesystem::is_regular_file(path / "points_cache")) {
-                get_correlator().load_points_cache(Scoring::Caching::File, path / "points_cache");
-                get_logger().notice("Loaded dataset correlator points cache from file", path / "points_cache");
-                get_correlator().load_groups_cache(Scoring::Caching::File, path / "groups_cache");
-                get_logger().notice("Loaded dataset correlator groups cache from file", path / "groups_cache");
+        // caches are memory-mapped by default, as they are only read once loaded;
+        // compressed caches written by `compact_correlator_caches` are loaded with the SparseFile type,
+        // and datasets that have not been compacted yet fall back on memory-mapped caches;
+        // when asked to, memory-mapped caches are locked in RAM so that lookups never page in
+
+        void load_correlator(const std::filesystem::path& path, const Scoring::Caching::Type caching_type=Scoring::Caching::Mmap, const bool cache_lock=false) {
+            // correlator is fully loaded before replacing the current one
+            auto correlator = std::make_shared<LinkRbrain::Scoring::Correlator<T>>(*_dataset, path);
+            for (const std::string name : {"points_cache", "groups_cache"}) {
+                Scoring::Caching::Type cache_type = caching_type;
+                std::filesystem::path cache_path = path / name;
+                if (caching_type == Scoring::Caching::SparseFile) {
+                    if (std::filesystem::is_regular_file(path / (name + ".sparse"))) {
+                        cache_path += ".sparse";
+                    } else {
+                        cache_type = Scoring::Caching::Mmap;
+                        get_logger().warning("No compacted", name, "in", path, ", using uncompressed one instead");
+                    }
+                }
+                if (!std::filesystem::is_regular_file(cache_path)) {
+                    continue;
+                }
+                if (name == "points_cache") {
+                    correlator->load_points_cache(cache_type, cache_path);
+                } else {
+                    correlator->load_groups_cache(cache_type, cache_path);
+                }
+                if (cache_lock) {
+                    const auto& cache = (name == "points_cache") ? correlator->get_points_cache() : correlator->get_groups_cache();
+                    const auto mmap_cache = std::dynamic_pointer_cast<Scoring::Caching::MmapScorerCache<T>>(cache);
+                    if (mmap_cache && mmap_cache->lock()) {
+                        get_logger().notice("Locked dataset correlator", name, "in memory");
+                    }
+                }
+                get_logger().notice("Loaded dataset correlator", name, "from file", cache_path);
             }
+            set_correlator(correlator);
             get_logger().notice("Loaded dataset correlator from file", path);
         }
-        void load(const std::filesystem::path& path) {
+        void compact_correlator_caches() {
+            auto& correlator = get_correlator();
+            if (correlator.get_status() < Scoring::Correlator<T>::Status::CachedGroups || !correlator.get_points_cache() || !correlator.get_groups_cache()) {
+                throw Exceptions::BadDataException("Correlator caches of dataset " + _dataset->get_label() + " have not been fully computed", {
+                    {"dataset", _dataset->get_label()},
+                    {"status", correlator.get_status_name()},
+                });
+            }
+            Scoring::Caching::SparseFileScorerCache<T>::write(*correlator.get_points_cache(), correlator.get_density_map().get_size(), _path / "correlator" / "points_cache.sparse");
+            get_logger().notice("Compacted dataset correlator points cache into", _path / "correlator" / "points_cache.sparse");
+            Scoring::Caching::SparseFileScorerCache<T>::write(*correlator.get_groups_cache(), _dataset->get_groups().size(), _path / "correlator" / "groups_cache.sparse");
+            get_logger().notice("Compacted dataset correlator groups cache into", _path / "correlator" / "groups_cache.sparse");
+        }
+        void load(const std::filesystem::path& path, const Scoring::Caching::Type caching_type=Scoring::Caching::Mmap, const bool cache_lock=false) {
             _path = path;
             get_logger().debug("Loading dataset data from ", path);
             load_data(path / "data");
             if (std::filesystem::is_directory(path / "correlator")) {
                 get_logger().debug("Loading dataset correlator from ", path);
-                load_correlator(path / "correlator");
+                load_correlator(path / "correlator", caching_type, cache_lock);
             }
             get_logger().message("Loaded dataset controller from folder ", path);
         }
@@ -214,7 +277,7 @@ namespace LinkRbrain::Controllers {
         void serialize_groups(Types::Variant& destination, const std::vector<std::string> keywords={}, const std::unordered_set<uint64_t> identifiers={}, const size_t offset=0, const size_t limit=20, const bool with_points=false) const {
             auto& destination_data = destination["data"];
             destination_data.set_vector();
-            std::vector<Types::Variant>& destination_groups = destination_data.get_vector();
+            Types::VariantVector& destination_groups = destination_data.get_vector();
             const auto& groups = _dataset->get_groups();
             Types::Variant serialized_group;
             size_t count = 0;
@@ -302,19 +365,82 @@ namespace LinkRbrain::Controllers {
             get_logger().debug("Start computing query ", query.id, " with", with_graph?"":"out", " graph");
             query.is_computed = false;
             // parameters
-            const size_t limit = query.settings.get("correlations", Types::VariantMap()).get("limit", 10);
-            get_logger().detail("Fetched query groups as vector");
+            const size_t limit = get_query_limit(query);
             // prepare query & check groups
             query.correlations.unset();
-            const auto& query_groups = query.groups.get_vector();
-            if (query_groups.size() == 0) {
+            if (query.groups.get_vector().size() == 0) {
                 return;
             }
             get_logger().detail("Fetched query groups as vector");
-            query.correlations.set_vector();
-            std::vector<Types::Variant>& query_correlations = query.correlations.get_vector();
-            get_logger().detail("Prepared correlations as vector");
             // parse points
+            const std::vector<std::vector<Types::Point<T>>> query_groups_points = parse_query_points(query);
+            get_logger().detail("Parsed points");
+            // compute correlations
+            const auto correlator = get_shared_correlator();
+            const Scoring::ScoredGroupList correlations = correlator->correlate(
+                query_groups_points, // points
+                true, // order
+                limit, // limit
+                false, // force_uncached
+                false); // use_interpolation
+            get_logger().detail("Computed correlations");
+            format_query(*correlator, query, query_groups_points, correlations, with_graph);
+        }
+
+        // queries sharing the same limit are correlated together, so that overlapping
+        // points only fetch their cached scores once
+
+        void compute_batch(std::vector<Models::Query>& queries, const bool with_graph=true) {
+            get_logger().debug("Start computing batch of ", queries.size(), " queries with", with_graph?"":"out", " graph");
+            std::map<size_t, std::vector<size_t>> queries_indices_by_limit;
+            std::vector<std::vector<std::vector<Types::Point<T>>>> queries_points(queries.size());
+            for (size_t query_index = 0; query_index < queries.size(); query_index++) {
+                Models::Query& query = queries[query_index];
+                query.is_computed = false;
+                query.correlations.unset();
+                if (query.groups.get_vector().size() == 0) {
+                    continue;
+                }
+                queries_points[query_index] = parse_query_points(query);
+                queries_indices_by_limit[get_query_limit(query)].push_back(query_index);
+            }
+            get_logger().detail("Parsed points");
+            const auto correlator = get_shared_correlator();
+            for (const auto& [limit, queries_indices] : queries_indices_by_limit) {
+                std::vector<std::vector<std::vector<Types::Point<T>>>> batch;
+                for (const size_t query_index : queries_indices) {
+                    batch.push_back(queries_points[query_index]);
+                }
+                const std::vector<Scoring::ScoredGroupList<T>> correlations = correlator->correlate_batch(batch, true, limit);
+                get_logger().detail("Computed correlations of ", batch.size(), " queries with a limit of ", limit);
+                for (size_t i = 0; i < queries_indices.size(); i++) {
+                    format_query(*correlator, queries[queries_indices[i]], queries_points[queries_indices[i]], correlations[i], with_graph);
+                }
+            }
+        }
+
+    protected:
+
+        virtual const std::string get_logger_name() {
+            if (_dataset) {
+                return "DatasetController[" + std::to_string(_dataset->get_id()) + "|" + _dataset->get_label() + "]";
+            }
+            return "DatasetController";
+        }
+
+    private:
+
+        void set_correlator(const std::shared_ptr<Scoring::Correlator<T>>& correlator) {
+            std::unique_lock<std::shared_mutex> lock(_correlator_mutex);
+            _correlator = correlator;
+        }
+
+        static const size_t get_query_limit(Models::Query& query) {
+            return query.settings.get("correlations", Types::VariantMap()).get("limit", 10);
+        }
+
+        static const std::vector<std::vector<Types::Point<T>>> parse_query_points(const Models::Query& query) {
+            const auto& query_groups = query.groups.get_vector();
             std::vector<std::vector<Types::Point<T>>> query_groups_points(query_groups.size());
             size_t query_group_index = 0;
             for (const auto& group : query_groups) {
@@ -328,15 +454,16 @@ namespace LinkRbrain::Controllers {
                         point[3].get_number()});
                 }
             }
-            get_logger().detail("Parsed points");
-            // compute correlations
-            const Scoring::ScoredGroupList correlations = get_correlator().correlate(
-                query_groups_points, // points
-                true, // order
-                limit, // limit
-                false, // force_uncached
-                false); // use_interpolation
-            get_logger().detail("Computed correlations");
+            return query_groups_points;
+        }
+
+        // correlations must have been computed by `correlator`, as they refer to its dataset groups
+
+        void format_query(const Scoring::Correlator<T>& correlator, Models::Query& query, const std::vector<std::vector<Types::Point<T>>>& query_groups_points, const Scoring::ScoredGroupList<T>& correlations, const bool with_graph) {
+            const auto& query_groups = query.groups.get_vector();
+            query.correlations.set_vector();
+            Types::VariantVector& query_correlations = query.correlations.get_vector();
+            get_logger().detail("Prepared correlations as vector");
             // format correlations
             for (const auto& correlation : correlations) {
                 std::vector<T> scores = correlation.scores;
@@ -353,23 +480,46 @@ namespace LinkRbrain::Controllers {
                 query.graph.clear();
                 // instanciate graph
                 const size_t query_groups_count = correlations.get_count();
+                Types::Variant graph_settings = query.settings.get("graph", Types::VariantMap());
                 size_t dataset_groups_count = 0;
                 if (correlations.size()) {
-                    dataset_groups_count = query.settings.get("graph", Types::VariantMap()).get("limit", -1);
+                    dataset_groups_count = graph_settings.get("limit", -1);
                     if (dataset_groups_count > correlations.size()) {
                         dataset_groups_count = correlations.size();
                     }
                 }
                 Graph::Graph<T> graph(dataset_groups_count + query_groups_count);
+                if (graph_settings.has("theta")) {
+                    graph.theta = graph_settings["theta"].get_number();
+                }
+                if (graph_settings.get("exact", false).get_boolean()) {
+                    graph.repulsion = Graph::Graph<T>::Exact;
+                }
                 get_logger().detail("Making graph: instanciated graph with ", 1 + dataset_groups_count, " nodes");
-                // integrate links between core query group nodes
+                // integrate links between core query group nodes, skipping those too far apart to score
+                const Scoring::Scorer& scorer = correlator.get_scorer();
+                std::vector<Types::PointExtrema<T>> query_groups_extrema(query_groups_count);
+                for (size_t i = 0; i < query_groups_count; i++) {
+                    const auto& points = query_groups_points[i];
+                    if (points.size()) {
+                        query_groups_extrema[i] = Types::PointExtrema<T>(points[0]);
+                    }
+                    for (const auto& point : points) {
+                        query_groups_extrema[i].integrate(point);
+                    }
+                }
+                size_t skipped_count = 0;
                 for (size_t i = 0; i < query_groups_count; i++) {
                     for (size_t j = 0; j < i; j++) {
-                        const double weight = get_correlator().score(query_groups_points[i], query_groups_points[j]);
+                        if (scorer.are_distant(query_groups_extrema[i], query_groups_extrema[j])) {
+                            ++skipped_count;
+                            continue;
+                        }
+                        const double weight = correlator.score(query_groups_points[i], query_groups_points[j]);
                         graph.add_link(j, i, weight);
                     }
                 }
-                get_logger().detail("Making graph: added ", dataset_groups_count, " core links");
+                get_logger().detail("Making graph: added core links, skipped ", skipped_count, " distant pairs");
                 // integrate links between core query group nodes and correlated dataset group nodes
                 for (size_t i = 0; i < dataset_groups_count; i++) {
                     for (size_t j = 0; j < query_groups_count; j++) {
@@ -378,12 +528,17 @@ namespace LinkRbrain::Controllers {
                     }
                 }
                 get_logger().detail("Making graph: added ", dataset_groups_count, " core links");
-                // integrate links between correlated groups nodes
+                // integrate links between correlated groups nodes; group scores are indexed as in the dataset
+                std::vector<size_t> dataset_groups_indexes(dataset_groups_count);
+                for (size_t i = 0; i < dataset_groups_count; i++) {
+                    assert(correlator.has_dataset_group(correlations[i].group));
+                    dataset_groups_indexes[i] = correlator.get_dataset_group_index(correlations[i].group);
+                }
                 size_t n = 0;
                 for (size_t i = 0; i < dataset_groups_count; i++) {
-                    const auto scores = get_correlator().compute_group_scores(correlations[i].group);
+                    const auto scores = correlator.compute_group_scores(correlations[i].group);
                     for (size_t j = 0; j < i; j++) {
-                        graph.add_link(i+query_groups_count, j+query_groups_count, scores[j]);
+                        graph.add_link(i+query_groups_count, j+query_groups_count, scores[dataset_groups_indexes[j]]);
                         ++n;
                     }
                 }
@@ -420,38 +575,26 @@ namespace LinkRbrain::Controllers {
                     ++node_index;
                 }
                 get_logger().detail("Formatted graph nodes: dataset groups");
-                // format graph edges: initialize matrix
-                auto& edges = query.graph["edges"];
-                edges.set_vector();
-                edges.get_vector().resize(graph.count, Types::VariantVector(graph.count, 0.0));
-                get_logger().detail("Formatted graph edges: initialized matrix");
-                // format graph edges: go!
-                for (size_t j = 0; j < graph.count; j++) {
-                    for (size_t i = 0; i < j; i++) {
-                        edges[i][j] = graph.get_edge(i, j).k_spring;
-                    }
+                // format graph edges, as a matrix or as a list of [i, j, weight]
+                const typename Graph::Graph<T>::EdgesFormat edges_format = (graph_settings.get("format", "dense").get_string() == "sparse")
+                    ? Graph::Graph<T>::Sparse
+                    : Graph::Graph<T>::Dense;
+                graph.serialize_edges(query.graph["edges"], edges_format, graph_settings.get("min_weight", 0.).get_number());
+                if (edges_format == Graph::Graph<T>::Sparse) {
+                    // weight of the pairs that are not listed
+                    query.graph["missing_weight"] = (double) graph.get_missing_link();
                 }
-                get_logger().detail("Formatted graph edges: copy");
+                get_logger().detail("Formatted graph edges");
                 get_logger().debug("Computed & formatted graph");
             }
             // the end!
             query.is_computed = true;
         }
 
-    protected:
-
-        virtual const std::string get_logger_name() {
-            if (_dataset) {
-                return "DatasetController[" + std::to_string(_dataset->get_id()) + "|" + _dataset->get_label() + "]";
-            }
-            return "DatasetController";
-        }
-
-    private:
-
         std::filesystem::path _path;
         std::shared_ptr<Models::Dataset<T>> _dataset;
         std::shared_ptr<LinkRbrain::Scoring::Correlator<T>> _correlator;
+        mutable std::shared_mutex _correlator_mutex;
     };
 
 } // LinkRbrain::Controllers
@@ -11,6 +11,7 @@
 #include "LinkRbrain/Views/Groups.hpp"
 #include "LinkRbrain/Views/Queries.hpp"
 #include "LinkRbrain/Views/QueriesPdf.hpp"
+#include "LinkRbrain/Views/Jobs.hpp"
 #include "LinkRbrain/Views/Users.hpp"
 #include "LinkRbrain/Views/Tokens.hpp"
 #include "LinkRbrain/Views/Test.hpp"
@@ -27,8 +28,7 @@ namespace LinkRbrain::Controllers {
 
         HTTPController(AppController<T>& app_controller) {
             _server.set_port(8080);
-            _server.set_threading(1);
-            // _server.set_threading(std::thread::hardware_concurrency());
+            _server.set_threading(app_controller.get_http_threads_count());
             _server.add_static_path("var/www");
             _server.add_static_path("tmp/pdf");
             _server.set_resource_parameter(app_controller);
@@ -47,6 +47,8 @@ namespace LinkRbrain::Controllers {
             _server.add_resource<LinkRbrain::Views::QueriesList<T>>("/api/queries");
             _server.add_resource<LinkRbrain::Views::Queries<T>>("/api/queries/(\\d+)");
             _server.add_resource<LinkRbrain::Views::QueriesPdf<T>>("/api/queries/(\\d+)/pdf");
+            _server.add_resource<LinkRbrain::Views::QueriesPdfStatus<T>>("/api/queries/(\\d+)/pdf/(\\w+)");
+            _server.add_resource<LinkRbrain::Views::Jobs<T>>("/api/jobs/(\\d+)");
             // _server.add_resource<LinkRbrain::Views::QueriesGroup<T>>("/api/queries/(\\d+)/groups/(\\d+)");
             // _server.add_resource<LinkRbrain::Views::QueriesGroupList<T>>("/api/queries/(\\d+)/groups");
             // _server.add_resource<LinkRbrain::Views::QueriesGroupSubgroup<T>>("/api/queries/(\\d+)/groups/(\\d+)/subgroups");
@@ -67,7 +69,10 @@ namespace LinkRbrain::Controllers {
             _server.add_redirection("^/(.+\\.js)$", "/js/$1", Views::Redirection::Invisible, true);
             _server.add_redirection("^/(.+\\.json)$", "/json/$1", Views::Redirection::Invisible, true);
             _server.add_redirection("^/(.+\\.obj)$", "/obj/$1", Views::Redirection::Invisible, true);
-            _server.add_redirection("^/(.+\\.(?:jpe?g|png|gif|ico))$", "/images/$1", Views::Redirection::Invisible, true);
+            // one pattern per extension, so that they can be compiled into the router's trie
+            for (const std::string extension : {"jpg", "jpeg", "png", "gif", "ico"}) {
+                _server.add_redirection("^/(.+\\." + extension + ")$", "/images/$1", Views::Redirection::Invisible, true);
+            }
             _server.start();
         }
 
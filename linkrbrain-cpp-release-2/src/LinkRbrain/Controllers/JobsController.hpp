@@ -0,0 +1,360 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__CONTROLLERS__JOBSCONTROLLER_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__CONTROLLERS__JOBSCONTROLLER_HPP
+
+
+#include "Exceptions/GenericExceptions.hpp"
+#include "Logging/Loggable.hpp"
+#include "Types/DateTime.hpp"
+#include "Types/Variant.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace LinkRbrain::Controllers {
+
+
+    // background jobs, run by a fixed number of workers; queued jobs are taken by decreasing
+    // priority, then in submission order; when too many jobs are queued, new ones are refused
+    //
+    // Jobs saving results for a resource can be tagged with its revision when submitted: the
+    // resource is revised whenever it changes in a way that makes such results stale, and a
+    // job only saves them if no newer revision was made in the meantime.
+
+    class JobsController : public Logging::Loggable {
+    public:
+
+        enum Status {
+            Queued,
+            Running,
+            Done,
+            Failed,
+            Cancelled,
+        };
+
+        static const std::string get_status_name(const Status status) {
+            switch (status) {
+                case Queued:
+                    return "queued";
+                case Running:
+                    return "running";
+                case Done:
+                    return "done";
+                case Failed:
+                    return "failed";
+                case Cancelled:
+                    return "cancelled";
+            }
+            return "(unknown)";
+        }
+
+        struct Job;
+        typedef std::function<void(const Job&)> Function;
+
+        // running jobs are not interrupted when cancelled; their function can check
+        // `is_cancelled` to give up early, e.g. before saving its result
+
+        struct Job {
+            size_t id;
+            int priority;
+            Types::Variant details;
+            Function function;
+            Status status;
+            std::string error;
+            Types::DateTime created_at;
+            Types::DateTime started_at;
+            Types::DateTime finished_at;
+            std::atomic<bool> cancellation;
+
+            inline const bool is_cancelled() const {
+                return cancellation;
+            }
+        };
+
+        JobsController(const size_t workers_count=1, const size_t max_queued_count=64, const size_t max_finished_count=1024) :
+            _max_queued_count(max_queued_count),
+            _max_finished_count(max_finished_count),
+            _queued_count(0),
+            _running_count(0),
+            _last_id(0),
+            _is_running(true)
+        {
+            for (size_t i=0; i<(workers_count ? workers_count : 1); ++i) {
+                _workers.emplace_back(&JobsController::work, this);
+            }
+            get_logger().notice("Started", _workers.size(), "workers, accepting up to", _max_queued_count, "queued jobs");
+        }
+        JobsController(const JobsController&) = delete;
+        JobsController& operator = (const JobsController&) = delete;
+
+        // queued jobs are dropped, running ones are waited for
+
+        ~JobsController() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _is_running = false;
+                for (auto& [id, job] : _jobs) {
+                    if (job->status == Queued) {
+                        job->status = Cancelled;
+                        job->cancellation = true;
+                    }
+                }
+            }
+            _queue_condition.notify_all();
+            for (std::thread& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        const size_t submit(Function function, const int priority=0, const Types::Variant& details={}) {
+            std::shared_ptr<Job> job;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_queued_count >= _max_queued_count) {
+                    throw Exceptions::UnavailableException("Too many jobs are waiting to be processed, please retry later", {
+                        {"resource", "jobs"},
+                        {"queued", (int64_t) _queued_count},
+                        {"problem", "full"}
+                    });
+                }
+                job = std::make_shared<Job>();
+                job->id = ++_last_id;
+                job->priority = priority;
+                job->details = details;
+                job->function = std::move(function);
+                job->status = Queued;
+                job->created_at = Types::DateTime::now();
+                job->cancellation = false;
+                _jobs.insert({job->id, job});
+                _queue.push({priority, job->id});
+                ++_queued_count;
+            }
+            _queue_condition.notify_one();
+            get_logger().debug("Queued job", job->id, "with priority", priority);
+            return job->id;
+        }
+
+        // return false if the job had already finished
+
+        const bool cancel(const size_t id) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Job& job = get_job(id);
+            switch (job.status) {
+                case Queued:
+                    job.cancellation = true;
+                    job.status = Cancelled;
+                    job.finished_at = Types::DateTime::now();
+                    --_queued_count;
+                    finish(job);
+                    break;
+                case Running:
+                    job.cancellation = true;
+                    break;
+                default:
+                    return false;
+            }
+            get_logger().debug("Cancelled job", id);
+            return true;
+        }
+
+        const Status get_status(const size_t id) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return get_job(id).status;
+        }
+
+        void serialize(Types::Variant& destination, const size_t id) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const Job& job = get_job(id);
+            destination = {
+                {"id", (int64_t) job.id},
+                {"status", get_status_name(job.status)},
+                {"priority", (int64_t) job.priority},
+                {"details", job.details},
+                {"created_at", job.created_at},
+            };
+            if (job.status != Queued && job.status != Cancelled) {
+                destination["started_at"] = job.started_at;
+            }
+            if (job.status != Queued && job.status != Running) {
+                destination["finished_at"] = job.finished_at;
+            }
+            if (job.status == Failed) {
+                destination["error"] = job.error;
+            }
+        }
+
+        // run `update` with the new revision, to be given to the jobs submitted for the resource,
+        // while no job can save results for it; the revision is only made if `update` succeeds
+
+        template <typename Update>
+        const size_t revise(const std::string& resource, const size_t id, Update update) {
+            std::lock_guard<std::mutex> lock(_revisions_mutex);
+            size_t& revision = _revisions[{resource, id}];
+            update(revision + 1);
+            return ++revision;
+        }
+
+        const size_t get_revision(const std::string& resource, const size_t id) {
+            std::lock_guard<std::mutex> lock(_revisions_mutex);
+            const auto it = _revisions.find({resource, id});
+            return (it == _revisions.end()) ? 0 : it->second;
+        }
+
+        // run `save` only when the resource is still at the given revision; return whether
+        // it was run
+
+        template <typename Save>
+        const bool save_revision(const std::string& resource, const size_t id, const size_t revision, Save save) {
+            std::lock_guard<std::mutex> lock(_revisions_mutex);
+            const auto it = _revisions.find({resource, id});
+            if (revision != ((it == _revisions.end()) ? 0 : it->second)) {
+                get_logger().debug("Not saving", resource, id, "at revision", revision, "as it was revised since");
+                return false;
+            }
+            save();
+            return true;
+        }
+
+        // block until no job is queued or running
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _idle_condition.wait(lock, [this] { return _queued_count == 0 && _running_count == 0; });
+        }
+
+        inline const size_t get_workers_count() const {
+            return _workers.size();
+        }
+        inline const size_t& get_max_queued_count() const {
+            return _max_queued_count;
+        }
+        const size_t get_queued_count() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _queued_count;
+        }
+
+    protected:
+
+        virtual const std::string get_logger_name() {
+            return "JobsController";
+        }
+
+    private:
+
+        // must be called with the mutex locked
+
+        Job& get_job(const size_t id) {
+            const auto it = _jobs.find(id);
+            if (it == _jobs.end()) {
+                throw Exceptions::NotFoundException("Could not find job with this identifier", {
+                    {"resource", "jobs"},
+                    {"id", (int64_t) id},
+                    {"problem", "notfound"}
+                });
+            }
+            return *it->second;
+        }
+
+        // keep track of finished jobs, so that their status can be polled for some time
+
+        void finish(const Job& job) {
+            _finished_ids.push_back(job.id);
+            while (_finished_ids.size() > _max_finished_count) {
+                _jobs.erase(_finished_ids.front());
+                _finished_ids.pop_front();
+            }
+            if (_queued_count == 0 && _running_count == 0) {
+                _idle_condition.notify_all();
+            }
+        }
+
+        void work() {
+            while (true) {
+                std::shared_ptr<Job> job;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    // cancelled jobs are skipped
+                    while (!job) {
+                        _queue_condition.wait(lock, [this] { return !_is_running || !_queue.empty(); });
+                        if (!_is_running) {
+                            return;
+                        }
+                        const auto it = _jobs.find(_queue.top().id);
+                        _queue.pop();
+                        if (it != _jobs.end() && it->second->status == Queued) {
+                            job = it->second;
+                        }
+                    }
+                    job->status = Running;
+                    job->started_at = Types::DateTime::now();
+                    --_queued_count;
+                    ++_running_count;
+                }
+                get_logger().debug("Started job", job->id);
+                Status status = Done;
+                std::string error;
+                try {
+                    job->function(*job);
+                } catch (const std::exception& exception) {
+                    status = Failed;
+                    error = exception.what();
+                    get_logger().error("Job", job->id, "failed:", error);
+                } catch (...) {
+                    status = Failed;
+                    error = "Unknown error";
+                    get_logger().error("Job", job->id, "failed with an unknown error");
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    job->status = (status == Done && job->is_cancelled()) ? Cancelled : status;
+                    job->error = error;
+                    job->finished_at = Types::DateTime::now();
+                    job->function = nullptr;
+                    --_running_count;
+                    finish(*job);
+                }
+                get_logger().debug("Finished job", job->id, "with status", get_status_name(job->status));
+            }
+        }
+
+        struct QueueItem {
+            int priority;
+            size_t id;
+            inline const bool operator < (const QueueItem& other) const {
+                return (priority < other.priority) || (priority == other.priority && id > other.id);
+            }
+        };
+
+        const size_t _max_queued_count;
+        const size_t _max_finished_count;
+        std::mutex _mutex;
+        std::condition_variable _queue_condition;
+        std::condition_variable _idle_condition;
+        std::priority_queue<QueueItem> _queue;
+        std::unordered_map<size_t, std::shared_ptr<Job>> _jobs;
+        std::deque<size_t> _finished_ids;
+        size_t _queued_count;
+        size_t _running_count;
+        size_t _last_id;
+        bool _is_running;
+        std::mutex _revisions_mutex;
+        std::map<std::pair<std::string, size_t>, size_t> _revisions;
+        std::vector<std::thread> _workers;
+
+    };
+
+
+} // LinkRbrain::Controllers
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__CONTROLLERS__JOBSCONTROLLER_HPP
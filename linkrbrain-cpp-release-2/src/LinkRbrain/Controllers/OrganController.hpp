@@ -20,8 +20,8 @@ namespace LinkRbrain::Controllers {
             );
             save(path);
         }
-        OrganController(const std::filesystem::path& path) {
-            load(path);
+        OrganController(const std::filesystem::path& path, const Scoring::Caching::Type caching_type=Scoring::Caching::Mmap, const bool cache_lock=false) {
+            load(path, caching_type, cache_lock);
         }
 
         Models::Organ<T>& get_instance() {
@@ -37,7 +37,7 @@ namespace LinkRbrain::Controllers {
             return *_organ;
         }
 
-        void load(const std::filesystem::path& path) {
+        void load(const std::filesystem::path& path, const Scoring::Caching::Type caching_type=Scoring::Caching::Mmap, const bool cache_lock=false) {
             _path = path;
             // load organ instance
             std::ifstream data_buffer(path / "data");
@@ -51,7 +51,7 @@ namespace LinkRbrain::Controllers {
                 if (entry.is_directory()) {
                     try {
                         _dataset_controllers.push_back(
-                            std::make_shared<DatasetController<T>>(dataset_path)
+                            std::make_shared<DatasetController<T>>(dataset_path, caching_type, cache_lock)
                         );
                     } catch (std::exception& e) {
                         get_logger().warning("Cannot load dataset from ", dataset_path, ": ", e.what());
@@ -152,7 +152,7 @@ namespace LinkRbrain::Controllers {
             if (with_datasets) {
                 const size_t n = _dataset_controllers.size();
                 destination["datasets"].set_vector();
-                std::vector<Types::Variant>& datasets = destination["datasets"].get_vector();
+                Types::VariantVector& datasets = destination["datasets"].get_vector();
                 datasets.resize(n);
                 for (size_t i=0; i<n; ++i) {
                     _dataset_controllers[i]->serialize(datasets[i], false);
@@ -0,0 +1,282 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__CONTROLLERS__PDFCONTROLLER_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__CONTROLLERS__PDFCONTROLLER_HPP
+
+
+#include "./JobsController.hpp"
+#include "Conversion/JSON.hpp"
+#include "Exceptions/GenericExceptions.hpp"
+#include "Logging/Loggable.hpp"
+#include "Types/Variant.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+
+namespace LinkRbrain::Controllers {
+
+
+    // PDF documents rendered in background, with their own workers so that reports do not
+    // delay computations
+    //
+    // A render is identified by a hash of its description, which must contain everything
+    // the document depends on (e.g. a digest of the query contents, chosen sections,
+    // figures). The identifier is also the file name, so that a document rendered once is
+    // served from disk afterwards; submitting a description that is being rendered does not
+    // render it again.
+    //
+    // Rendered documents older than `max_cache_age` are removed, then the least recently
+    // used ones until they fit in `max_cache_size` bytes; this is done at construction and
+    // after each render.
+    //
+    // Only renders that are pending, or whose failure can still be reported, are tracked in
+    // memory: a successful render is forgotten as soon as its file is written, so that an
+    // evicted document is unknown until it is submitted again.
+
+    class PdfController : public Logging::Loggable {
+    public:
+
+        // renders the document at the given path
+        typedef std::function<void(const std::filesystem::path&)> Renderer;
+
+        PdfController(const std::filesystem::path& base_path="tmp/pdf", const size_t workers_count=1, const size_t max_queued_count=16, const uintmax_t max_cache_size=512 << 20, const std::chrono::seconds max_cache_age=std::chrono::hours(7 * 24)) :
+            _base_path(base_path),
+            _max_cache_size(max_cache_size),
+            _max_cache_age(max_cache_age),
+            _renders_count(0),
+            _cache_hits_count(0),
+            _evictions_count(0),
+            _jobs(workers_count, max_queued_count)
+        {
+            std::filesystem::create_directories(_base_path / renders_directory);
+            std::lock_guard<std::mutex> lock(_mutex);
+            evict();
+        }
+        PdfController(const PdfController&) = delete;
+        PdfController& operator = (const PdfController&) = delete;
+
+        // return the identifier of the render, to be given to `serialize`
+
+        const std::string submit(const Types::Variant& description, Renderer renderer) {
+            const std::string id = compute_id(description);
+            std::lock_guard<std::mutex> lock(_mutex);
+            // already rendered; it is now the most recently used
+            std::error_code error;
+            std::filesystem::last_write_time(get_path(id), std::filesystem::file_time_type::clock::now(), error);
+            if (!error) {
+                ++_cache_hits_count;
+                get_logger().debug("Serving PDF", id, "from cache");
+                return id;
+            }
+            // being rendered
+            forget_finished();
+            const auto it = _renders.find(id);
+            if (it != _renders.end() && is_pending(it->second)) {
+                get_logger().debug("Waiting for PDF", id, "being rendered by job", it->second);
+                return id;
+            }
+            // render it; the file is only moved to its final path once complete
+            const std::filesystem::path path = get_path(id);
+            const size_t job_id = _jobs.submit([this, id, path, renderer] (const JobsController::Job& job) {
+                std::filesystem::path temporary_path = path;
+                temporary_path += ".tmp";
+                try {
+                    renderer(temporary_path);
+                    std::filesystem::rename(temporary_path, path);
+                } catch (...) {
+                    std::filesystem::remove(temporary_path);
+                    throw;
+                }
+                get_logger().debug("Rendered PDF", id);
+                std::lock_guard<std::mutex> lock(_mutex);
+                evict(path);
+                const auto it = _renders.find(id);
+                if (it != _renders.end() && it->second == job.id) {
+                    _renders.erase(it);
+                }
+            }, 0, {
+                {"resource", "pdf"},
+                {"action", "render"},
+                {"id", id},
+                {"description", description}
+            });
+            _renders[id] = job_id;
+            ++_renders_count;
+            return id;
+        }
+
+        void serialize(Types::Variant& destination, const std::string& id) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            destination = {{"id", id}};
+            if (std::filesystem::exists(get_path(id))) {
+                destination["status"] = JobsController::get_status_name(JobsController::Done);
+                destination["url"] = get_url(id);
+                return;
+            }
+            const auto it = _renders.find(id);
+            if (it == _renders.end()) {
+                throw Exceptions::NotFoundException("Could not find PDF with this identifier", {
+                    {"resource", "pdf"},
+                    {"id", id},
+                    {"problem", "notfound"}
+                });
+            }
+            Types::Variant job;
+            _jobs.serialize(job, it->second);
+            destination["status"] = job["status"];
+            if (job.has("error")) {
+                destination["error"] = job["error"];
+            }
+        }
+
+        // 64 bits FNV-1a hash of the description, which is written with sorted keys
+
+        static const std::string compute_id(const Types::Variant& description) {
+            uint64_t hash = 14695981039346656037ULL;
+            for (const char character : Conversion::JSON::serialize(description)) {
+                hash = (hash ^ (uint8_t) character) * 1099511628211ULL;
+            }
+            static const char digits[] = "0123456789abcdef";
+            std::string id(16, '0');
+            for (int i=15; i>=0; --i, hash>>=4) {
+                id[i] = digits[hash & 15];
+            }
+            return id;
+        }
+
+        inline const std::filesystem::path get_path(const std::string& id) const {
+            return _base_path / renders_directory / (id + ".pdf");
+        }
+        // relative to `base_path`, which is served as static files
+        inline const std::string get_url(const std::string& id) const {
+            return "/" + renders_directory + "/" + id + ".pdf";
+        }
+
+        // block until no render is queued or running
+
+        inline void wait() {
+            _jobs.wait();
+        }
+
+        inline const size_t get_renders_count() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _renders_count;
+        }
+        inline const size_t get_cache_hits_count() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _cache_hits_count;
+        }
+        inline const size_t get_evictions_count() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _evictions_count;
+        }
+        // renders pending, or failed and not forgotten yet
+        inline const size_t get_tracked_count() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _renders.size();
+        }
+
+        inline static const std::string renders_directory = "renders";
+
+    protected:
+
+        virtual const std::string get_logger_name() {
+            return "PdfController";
+        }
+
+    private:
+
+        // finished jobs may have been forgotten by the jobs controller
+
+        const bool is_pending(const size_t job_id) {
+            try {
+                const JobsController::Status status = _jobs.get_status(job_id);
+                return status == JobsController::Queued || status == JobsController::Running;
+            } catch (const Exceptions::NotFoundException&) {
+                return false;
+            }
+        }
+
+        // failed renders are kept as long as the jobs controller can report their error
+
+        void forget_finished() {
+            for (auto it=_renders.begin(); it!=_renders.end(); ) {
+                try {
+                    _jobs.get_status(it->second);
+                    ++it;
+                } catch (const Exceptions::NotFoundException&) {
+                    it = _renders.erase(it);
+                }
+            }
+        }
+
+        // renders being written are still `.tmp` files, so they are never removed here;
+        // neither is `kept_path`, which has just been rendered
+
+        void evict(const std::filesystem::path& kept_path={}) {
+            const auto now = std::filesystem::file_time_type::clock::now();
+            std::vector<std::tuple<std::filesystem::file_time_type, uintmax_t, std::filesystem::path>> renders;
+            uintmax_t total_size = 0;
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator(_base_path / renders_directory, error)) {
+                if (entry.path().extension() != ".pdf" || entry.path() == kept_path) {
+                    continue;
+                }
+                const auto time = entry.last_write_time(error);
+                const uintmax_t size = error ? 0 : entry.file_size(error);
+                if (error) {
+                    continue;
+                }
+                if (now - time > _max_cache_age) {
+                    evict_file(entry.path());
+                    continue;
+                }
+                renders.push_back({time, size, entry.path()});
+                total_size += size;
+            }
+            if (!kept_path.empty()) {
+                const uintmax_t kept_size = std::filesystem::file_size(kept_path, error);
+                total_size += error ? 0 : kept_size;
+            }
+            // oldest first
+            std::sort(renders.begin(), renders.end());
+            for (const auto& [time, size, path] : renders) {
+                if (total_size <= _max_cache_size) {
+                    break;
+                }
+                evict_file(path);
+                total_size -= size;
+            }
+        }
+        void evict_file(const std::filesystem::path& path) {
+            std::error_code error;
+            if (std::filesystem::remove(path, error)) {
+                ++_evictions_count;
+                get_logger().debug("Evicted PDF", path.stem().native());
+            }
+        }
+
+        const std::filesystem::path _base_path;
+        const uintmax_t _max_cache_size;
+        const std::chrono::seconds _max_cache_age;
+        std::mutex _mutex;
+        std::unordered_map<std::string, size_t> _renders;
+        size_t _renders_count;
+        size_t _cache_hits_count;
+        size_t _evictions_count;
+        // last, so that workers are stopped first
+        JobsController _jobs;
+
+    };
+
+
+} // LinkRbrain::Controllers
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__CONTROLLERS__PDFCONTROLLER_HPP
@@ -9,24 +9,39 @@
 
 #include "../Models/User.hpp"
 
+#include <mutex>
+#include <shared_mutex>
+
 
 namespace LinkRbrain::Controllers {
 
+    // tokens are looked up by every authenticated request, and only created on login;
+    // elements of unordered maps are never moved, so references remain valid after unlocking
+
     class TokensController : public Logging::Loggable {
     public:
 
         const std::string& get_token(const Models::User& user) {
             // is it already in cache?
+            {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+                auto it = _username_to_token.find(user.username);
+                if (it != _username_to_token.end()) {
+                    return it->second;
+                }
+            }
+            // nope. then let's make a new one, unless another thread just did
+            std::unique_lock<std::shared_mutex> lock(_mutex);
             auto it = _username_to_token.find(user.username);
             if (it != _username_to_token.end()) {
                 return it->second;
             }
-            // nope. then let's make a new one
             const std::string token = compute_token();
             _token_to_user.insert({token, user});
             return _username_to_token.insert({user.username, token}).first->second;
         }
         const Models::User& get_user(const std::string& token) {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
             auto it = _token_to_user.find(token);
             if (it != _token_to_user.end()) {
                 return it->second;
@@ -46,7 +61,7 @@ namespace LinkRbrain::Controllers {
             }
             if (it->second.find("Bearer ") != 0) {
                 throw Exceptions::UnauthorizedException("Header 'Authorization' should start with 'Bearer '", {
-                    {"position", it->second.find("Bearer ")},
+                    {"position", (int64_t) it->second.find("Bearer ")},
                     {"header", "Authorization"},
                     {"problem", "missingbearer"}
                 });
@@ -57,6 +72,8 @@ namespace LinkRbrain::Controllers {
 
     protected:
 
+        // must be called with the mutex locked
+
         const std::string compute_token(const size_t min_length=32, const size_t max_length=64) {
             static const std::string vowels = "aeiou";
             static const std::string consonants = "zrtypsdfghjklmwvbn";
@@ -86,6 +103,7 @@ namespace LinkRbrain::Controllers {
 
         std::unordered_map<std::string, Models::User> _token_to_user;
         std::unordered_map<std::string, std::string> _username_to_token;
+        std::shared_mutex _mutex;
 
     };
 
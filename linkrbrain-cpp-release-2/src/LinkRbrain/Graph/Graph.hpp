@@ -4,9 +4,17 @@
 
 #include "./Node.hpp"
 #include "./Edge.hpp"
+#include "./QuadTree.hpp"
+#include "Parallel/ThreadPool.hpp"
 #include "Types/Table.hpp"
+#include "Types/Variant.hpp"
 
 #include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <ostream>
 #include <unordered_map>
@@ -15,74 +23,142 @@
 namespace LinkRbrain::Graph {
 
 
+    // force-directed layout: every pair of nodes repulse each other, and linked nodes are
+    // attracted by springs
+    //
+    // Repulsion is either computed exactly for every pair of nodes, or approximated with a
+    // Barnes-Hut quadtree, where groups of nodes seen under an angle smaller than `theta`
+    // act as one; by default, the latter is used for larger graphs only. Only springs
+    // whose stiffness exceeds `k_spring_threshold` in absolute value are taken into
+    // account, so that negative (repulsive) springs are kept.
+    //
+    // Pairs of nodes without a spring are not stored: they share one stiffness, zero
+    // until links are normalized, then normalized like any other.
+
     template <typename T, std::enable_if_t<std::is_floating_point<T>::value, int> = 0>
     struct Graph {
 
+        enum Repulsion {
+            Automatic,
+            Exact,
+            BarnesHut,
+        };
+
+        enum EdgesFormat {
+            Dense,
+            Sparse,
+        };
+
 		size_t count;
 		T dt;
 		T e;
 		T k_spring;
+		T k_repulsion;
 		T f_max, df;
 		T r, r_1;
 		T Emax;
 		std::vector<Node<T>> nodes;
 		std::vector<Edge<T>> edges;
+		// layout options
+		Repulsion repulsion;
+		T theta;
+		T k_spring_threshold;
+		size_t threads_count;
+
+		// below these numbers of nodes, automatic repulsion is exact, and computation is sequential
+		static const size_t barnes_hut_min_count = 1024;
+		static const size_t parallel_min_count = 512;
 
 		Graph(size_t _count) :
             count(_count),
             dt(0.01),
             k_spring(5.0),
+            k_repulsion(1.5),
             r(0.5),
             f_max(log(1.0 + _count)),
             df(0.00001 * log(1 + _count)),
-            Emax(1e-1 / (T)_count)
+            Emax(1e-1 / (T)_count),
+            repulsion(Automatic),
+            theta(0.5),
+            k_spring_threshold(0.),
+            threads_count(std::thread::hardware_concurrency()),
+            _missing_k_spring(0.),
+            _thread_pool(NULL)
         {
 			//	Nodes
 			T R = 8. * r * count;
 			T k = 2. * M_PI / (T)count;
             for (size_t i = 0; i < count; i++) {
-                const T theta = k * (T)i;
-                const T x = R * cos(theta);
-                const T y = R * sin(theta);
+                const T angle = k * (T)i;
+                const T x = R * cos(angle);
+                const T y = R * sin(angle);
                 nodes.push_back({x, y, r, -x, -y});
 			}
-            for (size_t i = 0; i < count; i++) {
-                _nodes_indexes.insert({&nodes[i], i});
-            }
-			//	Edges
-            for (size_t i = 0; i < count; i++) {
-                for (size_t j = 0; j < i; j++) {
-                    edges.push_back({
-                        nodes[i],
-                        nodes[j]
-                    });
-                }
-            }
 		}
 
-		const size_t get_edge_index(size_t i, size_t j) const {
+		static inline const uint64_t get_edge_key(size_t i, size_t j) {
             if (i < j) {
                 std::swap(i, j);
             }
             return j + i * (i - 1) / 2;
         }
-		Edge<T>& get_edge(const size_t i, const size_t j) {
-            return edges[get_edge_index(i, j)];
+		// stiffness of the spring between two nodes, `get_missing_link` when there is none
+		const T get_link(const size_t i, const size_t j) const {
+            const auto it = _edges_indexes.find(get_edge_key(i, j));
+            return (it == _edges_indexes.end()) ? _missing_k_spring : edges[it->second].k_spring;
+        }
+		inline const T get_missing_link() const {
+            return _missing_k_spring;
         }
 		void add_link(const size_t i, const size_t j, const T strength) {
-            if (i == j) {
+            if (i == j || strength == 0.) {
                 return;
             }
-            get_edge(i, j).k_spring += k_spring * strength;
+            const auto [it, is_inserted] = _edges_indexes.insert({get_edge_key(i, j), edges.size()});
+            if (is_inserted) {
+                edges.push_back({std::max(i, j), std::min(i, j), _missing_k_spring});
+            }
+            edges[it->second].k_spring += k_spring * strength;
 		}
 
 		void iterate(const T friction) {
-            for (auto& node : nodes) {
-                node.reset_acceleration();
-                node.compute_friction(friction);
+            // repulsion
+            const bool is_exact = (repulsion == Exact) || (repulsion == Automatic && count < barnes_hut_min_count);
+            if (!is_exact) {
+                _quadtree.build(nodes);
             }
-            for (auto& edge : edges) {
-                edge.compute();
+            // accelerations are computed for each node separately, so that nodes can be spread among threads
+            auto compute_accelerations = [this, friction, is_exact] (const size_t begin, const size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    Node<T>& node = nodes[i];
+                    T ax = -friction * node.vx;
+                    T ay = -friction * node.vy;
+                    if (is_exact) {
+                        for (size_t j = 0; j < count; j++) {
+                            if (j != i) {
+                                QuadTree<T>::add_repulsion(node.x - nodes[j].x, node.y - nodes[j].y, k_repulsion, ax, ay);
+                            }
+                        }
+                    } else {
+                        _quadtree.add_repulsion(nodes, i, theta, k_repulsion, ax, ay);
+                    }
+                    for (size_t k = _adjacency_offsets[i]; k < _adjacency_offsets[i + 1]; k++) {
+                        const Node<T>& other_node = nodes[_adjacency[k].first];
+                        const T dx = other_node.x - node.x;
+                        const T dy = other_node.y - node.y;
+                        const T length = sqrt(dx * dx + dy * dy);
+                        const T force = _adjacency[k].second * (length - node.r - other_node.r) / length;
+                        ax += force * dx;
+                        ay += force * dy;
+                    }
+                    node.ax = ax;
+                    node.ay = ay;
+                }
+            };
+            if (_thread_pool) {
+                _thread_pool->parallel_for(count, (count + 4 * _thread_pool->get_size() - 1) / (4 * _thread_pool->get_size()), compute_accelerations);
+            } else {
+                compute_accelerations(0, count);
             }
             for (auto& node : nodes) {
                 node.compute_newton(dt);
@@ -97,7 +173,28 @@ namespace LinkRbrain::Graph {
 			return energy;
 		}
 
+		// potential energy of the layout, computed exactly; lower is better
+
+		const T compute_potential_energy() const {
+			T energy = 0.;
+			for (size_t i = 0; i < count; i++) {
+				for (size_t j = 0; j < i; j++) {
+					const T dx = nodes[i].x - nodes[j].x;
+					const T dy = nodes[i].y - nodes[j].y;
+					energy += k_repulsion / sqrt(dx * dx + dy * dy);
+				}
+			}
+			for (const auto& edge : edges) {
+				const T dx = nodes[edge.i].x - nodes[edge.j].x;
+				const T dy = nodes[edge.i].y - nodes[edge.j].y;
+				const T stretch = sqrt(dx * dx + dy * dy) - nodes[edge.i].r - nodes[edge.j].r;
+				energy += .5 * edge.k_spring * stretch * stretch;
+			}
+			return energy;
+		}
+
 		const size_t compute(const size_t batch_iterations_count=100, const size_t max_iterations_count=-1) {
+			prepare();
 			T friction = 0.;
 			size_t iterations_count = 0;
 			do {
@@ -109,6 +206,8 @@ namespace LinkRbrain::Graph {
 				}
                 iterations_count += batch_iterations_count;
 			} while (compute_energy() > Emax && iterations_count < max_iterations_count);
+			_thread_pool = NULL;
+			_thread_pool_lock = {};
             return iterations_count;
 		}
 
@@ -143,6 +242,7 @@ namespace LinkRbrain::Graph {
 				node.y *= scale;
 			}
 		}
+		// pairs of nodes without a spring are normalized too, as in a dense matrix
 		void normalize_links() {
             if (edges.size() == 0) {
                 return;
@@ -156,6 +256,10 @@ namespace LinkRbrain::Graph {
                     k_max = edge.k_spring;
                 }
             }
+            if (edges.size() < count * (count - 1) / 2) {
+                k_min = std::min(k_min, _missing_k_spring);
+                k_max = std::max(k_max, _missing_k_spring);
+            }
             //
 			const T dk = k_max - k_min;
             if (dk == 0.) {
@@ -165,23 +269,117 @@ namespace LinkRbrain::Graph {
 				edge.k_spring -= k_min;
 				edge.k_spring /= dk;
 			}
+            _missing_k_spring = (_missing_k_spring - k_min) / dk;
 		}
 		void normalize() {
 			normalize_coordinates();
             normalize_links();
 		}
-        const size_t& get_node_index(const Node<T>& node) const {
-            static const size_t not_found = -1;
-            const auto& it = _nodes_indexes.find(&node);
-            if (it == _nodes_indexes.end()) {
-                return not_found;
+
+		// edges stiffer than `min_k_spring`, either as an upper triangular matrix of
+		// stiffnesses (zero elsewhere), or as a list of [i, j, stiffness] with i < j,
+		// sorted by i then j; pairs without a spring are in the matrix, but not in the list,
+		// where they stand for `get_missing_link`
+
+		void serialize_edges(Types::Variant& destination, const EdgesFormat format=Dense, const T min_k_spring=0.) const {
+            destination.set_vector();
+            Types::VariantVector& rows = destination.get_vector();
+            if (format == Dense) {
+                rows.resize(count, Types::VariantVector(count, 0.0));
+                if (_missing_k_spring > min_k_spring) {
+                    for (size_t j = 0; j < count; j++) {
+                        for (size_t i = j + 1; i < count; i++) {
+                            rows[j][i] = _missing_k_spring;
+                        }
+                    }
+                }
+                for (const auto& edge : edges) {
+                    rows[edge.j][edge.i] = (edge.k_spring > min_k_spring) ? edge.k_spring : 0.;
+                }
+                return;
             }
-            return it->second;
-        }
+            std::vector<const Edge<T>*> sorted_edges;
+            sorted_edges.reserve(edges.size());
+            for (const auto& edge : edges) {
+                if (edge.k_spring > min_k_spring) {
+                    sorted_edges.push_back(&edge);
+                }
+            }
+            std::sort(sorted_edges.begin(), sorted_edges.end(), [] (const Edge<T>* a, const Edge<T>* b) {
+                return (a->j < b->j) || (a->j == b->j && a->i < b->i);
+            });
+            rows.reserve(sorted_edges.size());
+            for (const Edge<T>* edge : sorted_edges) {
+                rows.push_back(Types::VariantVector{(int64_t) edge->j, (int64_t) edge->i, edge->k_spring});
+            }
+		}
 
     private:
 
-        std::unordered_map<const Node<T>*, size_t> _nodes_indexes;
+        // larger graphs are laid out by a pool shared with the whole process, so that jobs
+        // computing graphs concurrently do not each start their own threads; when another
+        // graph is already using it, the layout is computed sequentially instead
+
+        static Parallel::ThreadPool& get_shared_thread_pool() {
+            static Parallel::ThreadPool thread_pool(std::thread::hardware_concurrency());
+            return thread_pool;
+        }
+        static std::mutex& get_shared_thread_pool_mutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        // sparse adjacency of springs, in both directions, and threads for larger graphs;
+        // when pairs without a spring have a stiffness (i.e. the layout is computed again
+        // after normalizing links), every pair is a spring, as in a dense matrix
+
+        void prepare() {
+            const bool is_dense = std::abs(_missing_k_spring) > k_spring_threshold;
+            auto for_each_spring = [this, is_dense] (auto&& callback) {
+                if (is_dense) {
+                    for (size_t i = 0; i < count; i++) {
+                        for (size_t j = 0; j < i; j++) {
+                            callback(i, j, get_link(i, j));
+                        }
+                    }
+                } else {
+                    for (const auto& edge : edges) {
+                        callback(edge.i, edge.j, edge.k_spring);
+                    }
+                }
+            };
+            _adjacency_offsets.assign(count + 2, 0);
+            for_each_spring([this] (const size_t i, const size_t j, const T k) {
+                if (std::abs(k) > k_spring_threshold) {
+                    ++_adjacency_offsets[i + 2];
+                    ++_adjacency_offsets[j + 2];
+                }
+            });
+            for (size_t i = 2; i < count + 2; i++) {
+                _adjacency_offsets[i] += _adjacency_offsets[i - 1];
+            }
+            _adjacency.resize(_adjacency_offsets[count + 1]);
+            for_each_spring([this] (const size_t i, const size_t j, const T k) {
+                if (std::abs(k) > k_spring_threshold) {
+                    _adjacency[_adjacency_offsets[i + 1]++] = {j, k};
+                    _adjacency[_adjacency_offsets[j + 1]++] = {i, k};
+                }
+            });
+            _adjacency_offsets.pop_back();
+            _thread_pool = NULL;
+            _thread_pool_lock = std::unique_lock<std::mutex>(get_shared_thread_pool_mutex(), std::defer_lock);
+            if (threads_count > 1 && count >= parallel_min_count && _thread_pool_lock.try_lock()) {
+                _thread_pool = &get_shared_thread_pool();
+            }
+        }
+
+        std::unordered_map<uint64_t, size_t> _edges_indexes;
+        T _missing_k_spring;
+        std::vector<size_t> _adjacency_offsets;
+        std::vector<std::pair<size_t, T>> _adjacency;
+        QuadTree<T> _quadtree;
+        Parallel::ThreadPool* _thread_pool;
+        std::unique_lock<std::mutex> _thread_pool_lock;
 
     };
 
@@ -197,11 +395,10 @@ namespace LinkRbrain::Graph {
         }
         buffer << "Graph nodes:\n" << nodes_table;
         // edges
-        Types::Table edges_table("i", "node i", "node j", "stiffness", "length", "force.x", "force.y");
+        Types::Table edges_table("i", "node i", "node j", "stiffness");
         for (size_t i = 0; i < graph.edges.size(); i++) {
             auto& edge = graph.edges[i];
-            edges_table.add_row(i, graph.get_node_index(edge.node_i), graph.get_node_index(edge.node_j),
-                edge.k_spring, edge.length, edge.force_x, edge.force_y);
+            edges_table.add_row(i, edge.i, edge.j, edge.k_spring);
         }
         buffer << "Graph edges:\n" << edges_table;
         // the end
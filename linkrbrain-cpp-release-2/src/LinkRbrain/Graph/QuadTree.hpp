@@ -0,0 +1,176 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__GRAPH__QUADTREE_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__GRAPH__QUADTREE_HPP
+
+
+#include "./Node.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace LinkRbrain::Graph {
+
+
+    // quadtree over the nodes of a graph, for Barnes-Hut approximation of repulsion: every
+    // cell knows how many nodes it holds and their center of mass, so that distant cells
+    // can be taken as a single, heavier node
+
+    template <typename T>
+    class QuadTree {
+    public:
+
+        // beyond that depth, coincident nodes are kept in the same leaf
+        static const size_t max_depth = 48;
+
+        void build(const std::vector<Node<T>>& nodes) {
+            _cells.clear();
+            _order.resize(nodes.size());
+            for (uint32_t i = 0; i < _order.size(); i++) {
+                _order[i] = i;
+            }
+            if (nodes.empty()) {
+                return;
+            }
+            // bounding square
+            T x_min = nodes[0].x, x_max = nodes[0].x;
+            T y_min = nodes[0].y, y_max = nodes[0].y;
+            for (const auto& node : nodes) {
+                x_min = std::min(x_min, node.x);
+                x_max = std::max(x_max, node.x);
+                y_min = std::min(y_min, node.y);
+                y_max = std::max(y_max, node.y);
+            }
+            _cells.push_back({
+                (T) .5 * (x_min + x_max),
+                (T) .5 * (y_min + y_max),
+                (T) .5 * std::max(x_max - x_min, y_max - y_min) + std::numeric_limits<T>::epsilon()
+            });
+            build(nodes, 0, 0, _order.size(), 0);
+        }
+
+        // add the repulsion exerted on node `index` by all the others to (ax, ay); cells that
+        // are seen under an angle smaller than theta, and do not contain the node, are
+        // approximated by their center of mass
+
+        void add_repulsion(const std::vector<Node<T>>& nodes, const size_t index, const T theta, const T k_repulsion, T& ax, T& ay) const {
+            if (_cells.empty()) {
+                return;
+            }
+            const T x = nodes[index].x;
+            const T y = nodes[index].y;
+            const T theta_2 = theta * theta;
+            uint32_t stack[3 * max_depth + 4];
+            size_t stack_size = 0;
+            stack[stack_size++] = 0;
+            while (stack_size) {
+                const Cell& cell = _cells[stack[--stack_size]];
+                if (cell.first_child == 0) {
+                    for (uint32_t k = cell.begin; k < cell.end; k++) {
+                        const uint32_t j = _order[k];
+                        if (j != index) {
+                            add_repulsion(x - nodes[j].x, y - nodes[j].y, k_repulsion, ax, ay);
+                        }
+                    }
+                    continue;
+                }
+                const T dx = x - cell.center_x;
+                const T dy = y - cell.center_y;
+                const T width = 2 * cell.half_size;
+                const bool is_inside = std::abs(x - cell.x) <= cell.half_size && std::abs(y - cell.y) <= cell.half_size;
+                if (!is_inside && width * width < theta_2 * (dx * dx + dy * dy)) {
+                    add_repulsion(dx, dy, k_repulsion * (cell.end - cell.begin), ax, ay);
+                    continue;
+                }
+                for (uint32_t c = cell.first_child; c < cell.first_child + 4; c++) {
+                    if (_cells[c].begin != _cells[c].end) {
+                        stack[stack_size++] = c;
+                    }
+                }
+            }
+        }
+
+        // repulsion between two nodes, or a node and a cell, separated by (dx, dy)
+
+        static inline void add_repulsion(const T dx, const T dy, const T k_repulsion, T& ax, T& ay) {
+            const T length_2 = dx * dx + dy * dy;
+            const T force = k_repulsion / (length_2 * std::sqrt(length_2));
+            ax += force * dx;
+            ay += force * dy;
+        }
+
+        inline const size_t get_cells_count() const {
+            return _cells.size();
+        }
+
+    private:
+
+        struct Cell {
+            T x, y, half_size;
+            T center_x, center_y;
+            uint32_t begin, end;
+            uint32_t first_child;
+        };
+
+        // split nodes in [begin, end) among the 4 quadrants of the cell, recursively
+
+        void build(const std::vector<Node<T>>& nodes, const uint32_t cell_index, const uint32_t begin, const uint32_t end, const size_t depth) {
+            T center_x = 0, center_y = 0;
+            for (uint32_t k = begin; k < end; k++) {
+                center_x += nodes[_order[k]].x;
+                center_y += nodes[_order[k]].y;
+            }
+            {
+                Cell& cell = _cells[cell_index];
+                cell.center_x = center_x / (end - begin);
+                cell.center_y = center_y / (end - begin);
+                cell.begin = begin;
+                cell.end = end;
+                cell.first_child = 0;
+                if (end - begin <= 1 || depth >= max_depth) {
+                    return;
+                }
+            }
+            const T x = _cells[cell_index].x;
+            const T y = _cells[cell_index].y;
+            const T quarter_size = _cells[cell_index].half_size / 2;
+            uint32_t* const first = _order.data();
+            const uint32_t middle = std::partition(first + begin, first + end, [&] (const uint32_t i) { return nodes[i].y < y; }) - first;
+            const uint32_t bounds[5] = {
+                begin,
+                (uint32_t) (std::partition(first + begin, first + middle, [&] (const uint32_t i) { return nodes[i].x < x; }) - first),
+                middle,
+                (uint32_t) (std::partition(first + middle, first + end, [&] (const uint32_t i) { return nodes[i].x < x; }) - first),
+                end
+            };
+            const uint32_t first_child = _cells.size();
+            _cells[cell_index].first_child = first_child;
+            for (int q = 0; q < 4; q++) {
+                _cells.push_back({
+                    x + ((q & 1) ? quarter_size : -quarter_size),
+                    y + ((q & 2) ? quarter_size : -quarter_size),
+                    quarter_size,
+                    0, 0,
+                    bounds[q], bounds[q],
+                    0
+                });
+            }
+            for (int q = 0; q < 4; q++) {
+                if (bounds[q] != bounds[q + 1]) {
+                    build(nodes, first_child + q, bounds[q], bounds[q + 1], depth + 1);
+                }
+            }
+        }
+
+        std::vector<Cell> _cells;
+        std::vector<uint32_t> _order;
+
+    };
+
+
+} // LinkRbrain::Graph
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__GRAPH__QUADTREE_HPP
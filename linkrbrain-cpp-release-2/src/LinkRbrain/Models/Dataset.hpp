@@ -62,7 +62,7 @@ namespace LinkRbrain::Models {
             });
         }
         const Group<T>& get_group(const size_t identifier) const {
-            for (Group<T>& group : _groups) {
+            for (const Group<T>& group : _groups) {
                 if (group.get_id() == identifier) {
                     return group;
                 }
@@ -279,8 +279,8 @@ namespace LinkRbrain::PDF {
         }
 
         void add_2d_view_section_figure(const std::filesystem::path& figure, const float figure_width, const std::string& slice_name, const float position, const std::string& plane_label) {
-            const std::string& png_buffer = slices_cache.get_cached_png_slice(slice_name, position);
-            HPDF_Image hpdf_image = HPDF_LoadPngImageFromMem(_hpdf_doc, (HPDF_BYTE*) png_buffer.data(), png_buffer.size());
+            const SlicesCache::PNG png_buffer = slices_cache.get_cached_png_slice(slice_name, position);
+            HPDF_Image hpdf_image = HPDF_LoadPngImageFromMem(_hpdf_doc, (HPDF_BYTE*) png_buffer->data(), png_buffer->size());
             const std::string text = plane_label + " plane, " + slice_name.back() + " = " + round_coordinate(position);
             add_figure(hpdf_image, figure_width, text);
             const float y0 = get_y();
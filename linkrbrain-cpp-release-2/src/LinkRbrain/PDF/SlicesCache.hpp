@@ -3,9 +3,11 @@
 
 
 #include "Exceptions/GenericExceptions.hpp"
+#include "Types/LRUCache.hpp"
 
-#include <map>
 #include <filesystem>
+#include <memory>
+#include <string>
 
 #include <cairo/cairo.h>
 
@@ -13,17 +15,52 @@
 namespace LinkRbrain::PDF {
 
 
+    // shared by documents rendered in parallel, with two bounded LRU caches: decoded source
+    // images, so that cropping another slice of the same image skips PNG decoding, and the
+    // encoded crops themselves
+    //
+    // Values are computed outside of the locks, so the same one may be computed twice when
+    // requested concurrently.
+
     class SlicesCache {
     public:
 
-        SlicesCache(const std::filesystem::path& base_path = "var/www/images/brain") {
-            set_base_path(base_path);
-        }
+        typedef std::shared_ptr<cairo_surface_t> Surface;
+        typedef std::shared_ptr<const std::string> PNG;
+
+        // crop of a source image, named after its axes (horizontal, vertical, then the one
+        // along which slices are stacked)
 
-        ~SlicesCache() {
-            for (auto& [coordinates, cairo_surface] : _cairo_slices_cache) {
-                cairo_surface_destroy(cairo_surface);
+        struct Slice {
+            std::string coordinates;
+            int x;
+            int y;
+            int width;
+            int height;
+            inline const bool operator == (const Slice& other) const {
+                return coordinates == other.coordinates && x == other.x && y == other.y && width == other.width && height == other.height;
             }
+            struct Hash {
+                inline const size_t operator() (const Slice& slice) const {
+                    size_t hash = std::hash<std::string>()(slice.coordinates);
+                    for (const int value : {slice.x, slice.y, slice.width, slice.height}) {
+                        hash = (hash * 54059L) ^ (76963L * (size_t) value);
+                    }
+                    return hash;
+                }
+            };
+        };
+
+        struct Stats {
+            Types::LRUCache<std::string, Surface>::Stats surfaces;
+            Types::LRUCache<Slice, PNG, Slice::Hash>::Stats pngs;
+        };
+
+        SlicesCache(const std::filesystem::path& base_path = "var/www/images/brain", const size_t max_surfaces_size = 64 << 20, const size_t max_pngs_size = 16 << 20) :
+            _surfaces_cache(max_surfaces_size, 4),
+            _pngs_cache(max_pngs_size, 16)
+        {
+            set_base_path(base_path);
         }
 
         //
@@ -31,22 +68,30 @@ namespace LinkRbrain::PDF {
         void set_base_path(const std::filesystem::path& base_path) {
             _base_path = base_path;
         }
+        void set_max_sizes(const size_t max_surfaces_size, const size_t max_pngs_size) {
+            _surfaces_cache.set_max_size(max_surfaces_size);
+            _pngs_cache.set_max_size(max_pngs_size);
+        }
+        void clear() {
+            _surfaces_cache.clear();
+            _pngs_cache.clear();
+        }
+        const Stats get_stats() {
+            return {_surfaces_cache.get_stats(), _pngs_cache.get_stats()};
+        }
 
         //
 
-        const std::string& get_cached_png_slice(const std::string& coordinates, const int position) {
-            const std::pair<std::string, int> key = {coordinates, position};
-            // try to retrieve from cache
-            const auto& it = _png_slice_cache.find(key);
-            if (it != _png_slice_cache.end()) {
-                return it->second;
-            }
-            // otherwise, compute & cache
-            const std::string png_slice = get_png_slice(coordinates, position);
-            return (_png_slice_cache[key] = png_slice);
+        const PNG get_cached_png_slice(const std::string& coordinates, const int position) {
+            const Slice slice = get_slice(coordinates, position);
+            return _pngs_cache.get_or_compute(slice, [this, &slice] (size_t& size) {
+                const PNG png = std::make_shared<const std::string>(get_png_slice(slice));
+                size = sizeof(std::string) + png->capacity();
+                return png;
+            });
         }
 
-        const int get_slice_offset(const char coordinate) {
+        static const int get_slice_offset(const char coordinate) {
             switch (coordinate) {
                 case 'x': return  90;
                 case 'y': return 126;
@@ -54,7 +99,7 @@ namespace LinkRbrain::PDF {
             }
             return 0;
         }
-        const int get_slice_size(const char coordinate) {
+        static const int get_slice_size(const char coordinate) {
             switch (coordinate) {
                 case 'x': return  91;
                 case 'y': return 109;
@@ -62,15 +107,19 @@ namespace LinkRbrain::PDF {
             }
             return 0;
         }
-        const std::string get_png_slice(const std::string& coordinates, const int position) {
-            // compute width, height and offset
+        static const Slice get_slice(const std::string& coordinates, const int position) {
             const int width = get_slice_size(coordinates[0]);
             const int height = get_slice_size(coordinates[1]);
             const int offset = (position + get_slice_offset(coordinates[2])) / 2 * height;
+            return {coordinates, 0, offset, width, height};
+        }
+
+        const std::string get_png_slice(const Slice& slice) {
             // crop image
-            cairo_surface_t* cairo_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+            const Surface source_surface = get_cairo_slices(slice.coordinates);
+            cairo_surface_t* cairo_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, slice.width, slice.height);
             cairo_t* cairo_context = cairo_create(cairo_surface);
-            cairo_set_source_surface(cairo_context, get_cairo_slices(coordinates), 0, -offset);
+            cairo_set_source_surface(cairo_context, source_surface.get(), -slice.x, -slice.y);
             cairo_paint(cairo_context);
             // convert to PNG
             std::string png_buffer;
@@ -86,29 +135,25 @@ namespace LinkRbrain::PDF {
             return png_buffer;
         }
 
-        cairo_surface_t* get_cairo_slices(const std::string& coordinates) {
-            // try to retrieve from cache
-            auto it = _cairo_slices_cache.find(coordinates);
-            if (it != _cairo_slices_cache.end()) {
-                return it->second;
-            }
-            // load image
-            const std::filesystem::path path = _base_path / (coordinates + ".png");
-            cairo_surface_t* cairo_surface = cairo_image_surface_create_from_png(path.c_str());
-            const cairo_status_t cairo_status = cairo_surface_status(cairo_surface);
-            if (cairo_status != CAIRO_STATUS_SUCCESS) {
-                throw Exceptions::NotFoundException("Cairo cannot open file `" + path.native() + "` in LinkRbrain::PDF::SlicesCache: " + cairo_status_to_string(cairo_status));
-            }
-            // do caching, return what was asked
-            _cairo_slices_cache.insert({coordinates, cairo_surface});
-            return cairo_surface;
+        const Surface get_cairo_slices(const std::string& coordinates) {
+            return _surfaces_cache.get_or_compute(coordinates, [this, &coordinates] (size_t& size) {
+                // load image
+                const std::filesystem::path path = _base_path / (coordinates + ".png");
+                const Surface surface(cairo_image_surface_create_from_png(path.c_str()), cairo_surface_destroy);
+                const cairo_status_t cairo_status = cairo_surface_status(surface.get());
+                if (cairo_status != CAIRO_STATUS_SUCCESS) {
+                    throw Exceptions::NotFoundException("Cairo cannot open file `" + path.native() + "` in LinkRbrain::PDF::SlicesCache: " + cairo_status_to_string(cairo_status));
+                }
+                size = cairo_image_surface_get_stride(surface.get()) * cairo_image_surface_get_height(surface.get());
+                return surface;
+            });
         }
 
     private:
 
         std::filesystem::path _base_path;
-        std::map<std::string, cairo_surface_t*> _cairo_slices_cache;
-        std::map<std::pair<std::string, int>, std::string> _png_slice_cache;
+        Types::LRUCache<std::string, Surface> _surfaces_cache;
+        Types::LRUCache<Slice, PNG, Slice::Hash> _pngs_cache;
 
     };
 
@@ -8,7 +8,7 @@
 
 // #include "Types/Variant.hpp"
 #include "LinkRbrain/Models/Dataset.hpp"
-#include "Reading/CSVReader.hpp"
+#include "Reading/MappedCSVReader.hpp"
 #include "Logging/Loggers.hpp"
 
 
@@ -58,37 +58,36 @@ namespace LinkRbrain::Parsing {
 
         template <typename T>
         static void parse_probes(LinkRbrain::Models::Dataset<T>& dataset, const std::filesystem::path& path) {
-            Reading::CSVReader csv(path, 1);
-            std::vector<std::string> columns;
+            Reading::MappedCSVReader csv(path, 1);
             //
             std::unordered_map<uint64_t, Types::Variant> by_gene_id;
-            while (csv.parse_line(columns)) {
+            csv.for_each_row([&by_gene_id] (const Reading::CSVRow& columns) {
                 // eliminate non-refseq
-                if (columns[6].size() == 0) {
-                    continue;
+                if (columns.get_raw(6).size() == 0) {
+                    return;
                 }
                 // one gene can have many probes
-                const uint64_t gene_id = convert<uint64_t>(columns[2]);
+                const uint64_t gene_id = columns.get_number<uint64_t>(2);
                 Types::Variant& metadata = by_gene_id[gene_id];
                 if (metadata.get_type() != Types::Variant::Map) {
                     metadata = {
-                        {"gene_id", gene_id},
-                        {"gene_symbol", columns[3]},
-                        {"gene_name", columns[4]},
-                        {"entrez_id", convert<uint64_t>(columns[5])},
-                        {"chromosome", columns[6]},
+                        {"gene_id", (int64_t) gene_id},
+                        {"gene_symbol", columns.get_string(3)},
+                        {"gene_name", columns.get_string(4)},
+                        {"entrez_id", columns.get_number<int64_t>(5)},
+                        {"chromosome", columns.get_string(6)},
                         {"probes", Types::VariantVector()}
                     };
                 }
                 Types::Variant& probes = metadata["probes"];
                 probes.push_back({
-                    {"probe_id", convert<uint64_t>(columns[0])},
-                    {"probe_name", columns[1]}
+                    {"probe_id", columns.get_number<int64_t>(0)},
+                    {"probe_name", columns.get_string(1)}
                 });
-            }
+            });
             // now, let's build the corresponding groups
             for (const auto& [gene_id, metadata] : by_gene_id) {
-                LinkRbrain::Models::Group<T>& group = dataset.add_group(metadata["gene_symbol"].get<std::string>());
+                LinkRbrain::Models::Group<T>& group = dataset.add_group(metadata["gene_symbol"].template get<std::string>());
                 group.set_metadata(metadata);
             }
         }
@@ -96,28 +95,28 @@ namespace LinkRbrain::Parsing {
         template <typename T>
         static std::vector<Types::Point<T>> parse_structures(const std::filesystem::path& path) {
             std::vector<Types::Point<T>> result;
-            Reading::CSVReader csv(path, 1);
-            std::vector<std::string> columns;
-            while (csv.parse_line(columns)) {
+            Reading::MappedCSVReader csv(path, 1);
+            csv.for_each_row([&result] (const Reading::CSVRow& columns) {
                 if (columns.size() < 13) {
-                    continue;
+                    return;
                 }
                 result.push_back({
-                    convert<T>(columns[10]),
-                    convert<T>(columns[11]),
-                    convert<T>(columns[12])
+                    columns.get_number<T>(10),
+                    columns.get_number<T>(11),
+                    columns.get_number<T>(12)
                 });
-            }
+            });
             return result;
         }
 
+        // the largest file: chunks are parsed in parallel, then merged in the order of the file
+
         template <typename T>
         static std::unordered_map<uint64_t, std::vector<T>> parse_expressions(const std::filesystem::path& path) {
-            std::unordered_map<uint64_t, std::vector<T>> all_values;
-            Reading::CSVReader csv(path, 1);
-            std::vector<std::string> columns;
-            while (csv.parse_line(columns)) {
-                const uint64_t probe_id = convert<uint64_t>(columns[0]);
+            typedef std::vector<std::pair<uint64_t, std::vector<T>>> ChunkValues;
+            Reading::MappedCSVReader csv(path, 1);
+            std::vector<ChunkValues> chunks_values = csv.map_chunks<ChunkValues>([] (const Reading::CSVRow& columns, ChunkValues& chunk_values) {
+                const uint64_t probe_id = columns.get_number<uint64_t>(0);
                 // extract all values for this line
                 std::vector<T> values;
                 values.resize(columns.size() - 1);
@@ -125,7 +124,7 @@ namespace LinkRbrain::Parsing {
                 T value_max = -INFINITY;
                 T value_average = 0.0;
                 for (size_t i=1, n=columns.size(); i<n; ++i) {
-                    const T value = convert<T>(columns[i]);
+                    const T value = columns.get_number<T>(i);
                     values[i - 1] = value;
                     if (value < value_min) value_min = value;
                     if (value > value_max) value_max = value;
@@ -138,7 +137,13 @@ namespace LinkRbrain::Parsing {
                     value /= value_average - value_min;
                 }
                 // store
-                all_values[probe_id] = values;
+                chunk_values.push_back({probe_id, std::move(values)});
+            });
+            std::unordered_map<uint64_t, std::vector<T>> all_values;
+            for (ChunkValues& chunk_values : chunks_values) {
+                for (auto& [probe_id, values] : chunk_values) {
+                    all_values[probe_id] = std::move(values);
+                }
             }
             return all_values;
         }
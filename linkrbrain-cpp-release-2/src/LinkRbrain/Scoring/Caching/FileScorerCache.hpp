@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
 #include <filesystem>
 
 #include <stdio.h>
@@ -114,10 +115,28 @@ namespace LinkRbrain::Scoring::Caching {
             const size_t offset = compute_offset(0, point_hash);
             std::vector<T> result;
             result.resize(this->_groups_count);
+            std::lock_guard<std::mutex> lock(_read_mutex);
             fseek(_f, offset, SEEK_SET);
             fread(&(result[0]), sizeof(T), this->_groups_count, _f);
             return result;
         }
+        virtual const std::span<const T> view_score_map(const uint32_t& point_hash) {
+            // rows beyond the end of file are zero; seeking & reading share the file position
+            std::vector<T>& view = this->get_view_buffer();
+            view.resize(this->_groups_count);
+            size_t count;
+            {
+                std::lock_guard<std::mutex> lock(_read_mutex);
+                fseek(_f, compute_offset(0, point_hash), SEEK_SET);
+                count = fread(view.data(), sizeof(T), this->_groups_count, _f);
+            }
+            std::fill(view.begin() + count, view.end(), static_cast<T>(0));
+            return view;
+        }
+
+        virtual void flush() {
+            fflush(_f);
+        }
 
     protected:
 
@@ -132,6 +151,7 @@ namespace LinkRbrain::Scoring::Caching {
 
         const std::filesystem::path _path;
         FILE* _f;
+        std::mutex _read_mutex;
 
     };
 
@@ -5,7 +5,10 @@
 #include "./MemoryScorerCache.hpp"
 #include "./FileScorerCache.hpp"
 #include "./MappedFileScorerCache.hpp"
+#include "./MmapScorerCache.hpp"
+#include "./SparseFileScorerCache.hpp"
 #include "Conversion/Binary.hpp"
+#include "Exceptions/GenericExceptions.hpp"
 
 #include <fstream>
 #include <filesystem>
@@ -18,8 +21,26 @@ namespace LinkRbrain::Scoring::Caching {
         Memory = 1,
         File = 2,
         MappedFile = 3,
+        Mmap = 4,
+        SparseFile = 5,
     };
 
+    // types of caches that can be loaded once computed, as named in options; other backends
+    // are only used while computing, and would not serve concurrent readers
+
+    inline const Type get_type_from_string(std::string source) {
+        std::transform(source.begin(), source.end(), source.begin(), tolower);
+        if (source == "mmap") {
+            return Mmap;
+        } else if (source == "sparse") {
+            return SparseFile;
+        } else {
+            throw Exceptions::BadDataException("Unsupported cache type: " + source + "; valid values are 'mmap' and 'sparse'", {
+                {"cache-type", source},
+            });
+        }
+    }
+
     struct Manager {
 
         template <typename T, typename T2>
@@ -31,6 +52,10 @@ namespace LinkRbrain::Scoring::Caching {
                     return new LinkRbrain::Scoring::Caching::FileScorerCache<T>(groups, path);
                 case MappedFile:
                     return new LinkRbrain::Scoring::Caching::MappedFileScorerCache<T>(groups, path);
+                case Mmap:
+                    return new LinkRbrain::Scoring::Caching::MmapScorerCache<T>(groups, path);
+                case SparseFile:
+                    return new LinkRbrain::Scoring::Caching::SparseFileScorerCache<T>(groups, path);
                 default:
                     except("Not implemented");
             }
@@ -53,6 +53,13 @@ namespace LinkRbrain::Scoring::Caching {
             read(_index._file._file_handle, &(result[0]), this->_groups_count*sizeof(T));
             return result;
         }
+        virtual const std::span<const T> view_score_map(const uint32_t& point_hash) {
+            std::vector<T>& view = this->get_view_buffer();
+            view.resize(this->_groups_count);
+            const ssize_t size = pread(_index._file._file_handle, view.data(), this->_groups_count*sizeof(T), _index._file._page_size + sizeof(T)*point_hash*this->_groups_count);
+            std::fill(view.begin() + std::max<ssize_t>(size, 0) / sizeof(T), view.end(), static_cast<T>(0));
+            return view;
+        }
 
         virtual const std::string get_type_name() const {
             return "MappedFileScorerCache";
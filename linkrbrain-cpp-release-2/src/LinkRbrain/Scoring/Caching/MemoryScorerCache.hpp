@@ -66,6 +66,13 @@ namespace LinkRbrain::Scoring::Caching {
             }
             return this->_zero;
         }
+        virtual const std::span<const T> view_score_map(const uint32_t& point_hash) {
+            const auto it = _cache.find(point_hash);
+            if (it != _cache.end()) {
+                return it->second;
+            }
+            return this->_zero;
+        }
 
         virtual const std::string get_type_name() const {
             return "MemoryScorerCache";
@@ -0,0 +1,154 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CACHING__MMAPSCORERCACHE_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CACHING__MMAPSCORERCACHE_HPP
+
+
+#include "./ScorerCache.hpp"
+
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+
+namespace LinkRbrain::Scoring::Caching {
+
+
+    // read-only view of a file written by FileScorerCache, mapped in memory;
+    // as nothing is modified after construction, concurrent readers are safe,
+    // and views remain valid as long as the cache itself
+
+    template <typename T>
+    class MmapScorerCache : public ScorerCache<T> {
+    public:
+
+        enum Advice {
+            Random = MADV_RANDOM,
+            WillNeed = MADV_WILLNEED,
+        };
+
+        static const size_t header_size = 4096;
+
+        template <typename T2>
+        MmapScorerCache(const std::vector<Group<T2>>& groups, const std::filesystem::path& path, const Advice advice=Random) :
+            ScorerCache<T>(groups),
+            _path(path),
+            _data(NULL),
+            _size(0),
+            _points_count(0)
+        {
+            const int fd = open(_path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                except("Could not open file " + _path.native() + ", " + strerror(errno));
+            }
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) == -1) {
+                const std::string message = strerror(errno);
+                close(fd);
+                except("Could not stat file " + _path.native() + ", " + message);
+            }
+            _size = file_stat.st_size;
+            // an empty or header-only file means that every score is zero
+            if (_size > header_size) {
+                _data = (const char*) mmap(NULL, _size, PROT_READ, MAP_SHARED, fd, 0);
+                if (_data == MAP_FAILED) {
+                    const std::string message = strerror(errno);
+                    close(fd);
+                    except("Could not map file " + _path.native() + ", " + message);
+                }
+                if (madvise((void*) _data, _size, advice) == -1) {
+                    this->get_logger().warning("Could not advise kernel about", _path.native(), "usage,", strerror(errno));
+                }
+                const size_t row_size = sizeof(T) * this->_groups_count;
+                _points_count = row_size ? (_size - header_size) / row_size : 0;
+                if (row_size && (_size - header_size) % row_size) {
+                    this->get_logger().warning("Ignoring truncated row at the end of", _path.native());
+                }
+            }
+            close(fd);
+            this->get_logger().debug("Mapped", _points_count, "points from", _path.native());
+        }
+        MmapScorerCache(const MmapScorerCache&) = delete;
+        MmapScorerCache& operator = (const MmapScorerCache&) = delete;
+
+        ~MmapScorerCache() {
+            if (_data != NULL) {
+                munmap((void*) _data, _size);
+            }
+        }
+
+        // keep score maps of the given points range in RAM, all of them by default; failures,
+        // typically because of RLIMIT_MEMLOCK, are logged but not fatal
+
+        const bool lock(const uint32_t point_hash_min=0, const uint32_t point_hash_max=-1) {
+            if (_data == NULL || point_hash_min >= std::min<size_t>(point_hash_max, _points_count)) {
+                return false;
+            }
+            const size_t page_size = sysconf(_SC_PAGE_SIZE);
+            const size_t begin = compute_offset(point_hash_min) / page_size * page_size;
+            const size_t end = compute_offset(std::min<size_t>(point_hash_max, _points_count));
+            if (mlock(_data + begin, end - begin) == -1) {
+                this->get_logger().warning("Could not lock", end - begin, "bytes from", _path.native(), "in memory,", strerror(errno));
+                return false;
+            }
+            return true;
+        }
+
+        virtual void clear() {
+            except("MmapScorerCache is read-only");
+        }
+        virtual void integrate(const size_t& group_index, const uint32_t& point_hash, const T& value) {
+            except("MmapScorerCache is read-only");
+        }
+        virtual void integrate(const uint32_t& point_hash, const std::vector<T>& values, const bool replace=true) {
+            except("MmapScorerCache is read-only");
+        }
+        virtual void integrate_into(ScorerCache<T>& destination, const bool replace=true) {
+            for (size_t point_hash=0; point_hash<_points_count; ++point_hash) {
+                const std::span<const T> row = view_score_map(point_hash);
+                const std::vector<T> values(row.begin(), row.end());
+                if (this->is_nonzero(values)) {
+                    destination.integrate(point_hash, values, replace);
+                }
+            }
+        }
+
+        virtual const std::vector<T> get_score_map(const uint32_t& point_hash) {
+            const std::span<const T> row = view_score_map(point_hash);
+            return std::vector<T>(row.begin(), row.end());
+        }
+        virtual const std::span<const T> view_score_map(const uint32_t& point_hash) {
+            if (point_hash >= _points_count) {
+                return this->_zero;
+            }
+            return std::span<const T>((const T*) (_data + compute_offset(point_hash)), this->_groups_count);
+        }
+
+        virtual const std::string get_type_name() const {
+            return "MmapScorerCache";
+        }
+
+    private:
+
+        inline const size_t compute_offset(const size_t point_hash) const {
+            return header_size + sizeof(T) * point_hash * this->_groups_count;
+        }
+
+        const std::filesystem::path _path;
+        const char* _data;
+        size_t _size;
+        size_t _points_count;
+
+    };
+
+
+} // LinkRbrain::Scoring::Caching
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CACHING__MMAPSCORERCACHE_HPP
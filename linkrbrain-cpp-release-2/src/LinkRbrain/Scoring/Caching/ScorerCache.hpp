@@ -7,6 +7,8 @@
 #include "Logging/Loggable.hpp"
 #include "Conversion/Binary.hpp"
 
+#include <span>
+
 
 namespace LinkRbrain::Scoring::Caching {
 
@@ -42,6 +44,9 @@ namespace LinkRbrain::Scoring::Caching {
         const size_t& get_progress() const {
             return _progress;
         }
+        const size_t& get_groups_count() const {
+            return _groups_count;
+        }
 
         virtual void clear() = 0;
 
@@ -53,6 +58,29 @@ namespace LinkRbrain::Scoring::Caching {
         virtual void integrate_into(ScorerCache<T>& destination, const bool replace=true) = 0;
 
         virtual const std::vector<T> get_score_map(const uint32_t& point_hash) = 0;
+        // the returned view remains valid until the cache is modified; only caches holding rows in memory or in
+        // a mapping return views on them, others copy rows into a buffer reused by the next copying call from
+        // the same thread, on any cache
+        virtual const std::span<const T> view_score_map(const uint32_t& point_hash) = 0;
+
+        // nonzero scores only, as group indices & values; caches storing sparse rows should override both
+
+        virtual const bool is_sparse() const {
+            return false;
+        }
+        virtual void get_sparse_score_map(const uint32_t& point_hash, std::vector<uint32_t>& indices, std::vector<T>& values) {
+            indices.clear();
+            values.clear();
+            const std::span<const T> row = view_score_map(point_hash);
+            for (uint32_t group_index=0; group_index<row.size(); ++group_index) {
+                if (row[group_index] != static_cast<T>(0.0)) {
+                    indices.push_back(group_index);
+                    values.push_back(row[group_index]);
+                }
+            }
+        }
+
+        virtual void flush() {}
 
         inline const bool is_nonzero(const std::vector<T>& values) const {
             return memcmp(&(values[0]), &(_zero[0]), _groups_count * sizeof(T));
@@ -67,6 +95,13 @@ namespace LinkRbrain::Scoring::Caching {
         size_t _groups_count;
         std::vector<T> _zero;
 
+        // rows copied for views are stored per thread, so that concurrent readers do not overwrite each other;
+        // buffers are released along with their thread
+        static std::vector<T>& get_view_buffer() {
+            static thread_local std::vector<T> view_buffer;
+            return view_buffer;
+        }
+
         virtual const std::string get_logger_name() {
             return get_type_name();
         }
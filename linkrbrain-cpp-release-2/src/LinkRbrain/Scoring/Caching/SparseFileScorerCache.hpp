@@ -0,0 +1,345 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CACHING__SPARSEFILESCORERCACHE_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CACHING__SPARSEFILESCORERCACHE_HPP
+
+
+#include "./ScorerCache.hpp"
+#include "Types/VarIntegerBlock.hpp"
+#include "Exceptions/GenericExceptions.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace LinkRbrain::Scoring::Caching {
+
+
+    // read-only compressed cache, where only nonzero scores are stored; the file is made of:
+    //  - a 4096 bytes header
+    //  - a table with the data offset & the quantization scale of each point, plus a final offset
+    //  - for each point, the count of nonzero scores and their delta-encoded group indices as
+    //    unsigned variable-length integers, followed by the scores quantized as 16 bits integers;
+    // each score is restored within half of its point scale, i.e. max(|scores|) / 65534
+
+    template <typename T>
+    class SparseFileScorerCache : public ScorerCache<T> {
+    public:
+
+        #pragma pack(push, 1)
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t value_size;
+            uint64_t groups_count;
+            uint64_t points_count;
+        };
+        struct TableEntry {
+            uint64_t offset;
+            double scale;
+        };
+        #pragma pack(pop)
+
+        typedef int16_t quantized_t;
+        static const size_t header_size = 4096;
+        static constexpr const char* magic = "LRSPARSE";
+        static const uint32_t version = 1;
+
+        template <typename T2>
+        SparseFileScorerCache(const std::vector<Group<T2>>& groups, const std::filesystem::path& path) :
+            ScorerCache<T>(groups),
+            _path(path),
+            _data(NULL),
+            _size(0),
+            _points_count(0),
+            _table(NULL)
+        {
+            const int fd = open(_path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                except("Could not open file " + _path.native() + ", " + strerror(errno));
+            }
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) == -1) {
+                const std::string message = strerror(errno);
+                close(fd);
+                except("Could not stat file " + _path.native() + ", " + message);
+            }
+            _size = file_stat.st_size;
+            if (_size < header_size) {
+                close(fd);
+                throw Exceptions::BadDataException("File " + _path.native() + " is too small to be a sparse scorer cache", {});
+            }
+            _data = (const char*) mmap(NULL, _size, PROT_READ, MAP_SHARED, fd, 0);
+            const std::string message = strerror(errno);
+            close(fd);
+            if (_data == MAP_FAILED) {
+                _data = NULL;
+                except("Could not map file " + _path.native() + ", " + message);
+            }
+            madvise((void*) _data, _size, MADV_RANDOM);
+            // the destructor is not called when the constructor throws
+            try {
+                check();
+            } catch (...) {
+                munmap((void*) _data, _size);
+                _data = NULL;
+                throw;
+            }
+            this->get_logger().debug("Mapped", _points_count, "sparse points from", _path.native());
+        }
+        SparseFileScorerCache(const SparseFileScorerCache&) = delete;
+        SparseFileScorerCache& operator = (const SparseFileScorerCache&) = delete;
+
+        ~SparseFileScorerCache() {
+            if (_data != NULL) {
+                munmap((void*) _data, _size);
+            }
+        }
+
+        // compress the first `points_count` rows of the given cache into a file
+
+        static void write(ScorerCache<T>& source, const size_t points_count, const std::filesystem::path& path) {
+            FILE* f = fopen(path.c_str(), "wb");
+            if (f == NULL) {
+                except("Could not create file " + path.native() + ", " + strerror(errno));
+            }
+            // header
+            std::vector<char> header_data(header_size, 0);
+            Header& header = * (Header*) header_data.data();
+            memcpy(header.magic, magic, sizeof(header.magic));
+            header.version = version;
+            header.value_size = sizeof(quantized_t);
+            header.groups_count = source.get_groups_count();
+            header.points_count = points_count;
+            write_data(f, header_data.data(), 1, header_size, path);
+            // reserve table, then write rows
+            std::vector<TableEntry> table(points_count + 1);
+            write_data(f, table.data(), sizeof(TableEntry), table.size(), path);
+            const uint64_t data_start = header_size + table.size() * sizeof(TableEntry);
+            uint64_t offset = data_start;
+            std::vector<uint8_t> row_data;
+            for (size_t point_hash=0; point_hash<points_count; ++point_hash) {
+                table[point_hash].offset = offset;
+                table[point_hash].scale = encode_row(source.view_score_map(point_hash), row_data);
+                write_data(f, row_data.data(), 1, row_data.size(), path);
+                offset += row_data.size();
+            }
+            table[points_count].offset = offset;
+            table[points_count].scale = 0.0;
+            if (fseek(f, header_size, SEEK_SET)) {
+                fclose(f);
+                except("Could not seek in file " + path.native() + ", " + strerror(errno));
+            }
+            write_data(f, table.data(), sizeof(TableEntry), table.size(), path);
+            if (fclose(f)) {
+                except("Could not write file " + path.native() + ", " + strerror(errno));
+            }
+        }
+
+        // read
+
+        virtual const bool is_sparse() const {
+            return true;
+        }
+        virtual void get_sparse_score_map(const uint32_t& point_hash, std::vector<uint32_t>& indices, std::vector<T>& values) {
+            indices.clear();
+            values.clear();
+            if (point_hash >= _points_count) {
+                return;
+            }
+            // offsets were checked when mapping; rows are checked while decoding
+            const uint8_t* data = (const uint8_t*) (_data + _table[point_hash].offset);
+            const uint8_t* end = (const uint8_t*) (_data + _table[point_hash + 1].offset);
+            const size_t count = decode_integer(data, end);
+            if (count > this->_groups_count) {
+                throw_corrupted_row(point_hash);
+            }
+            indices.resize(count);
+            values.resize(count);
+            uint64_t index = 0;
+            for (size_t i=0; i<count; ++i) {
+                index += decode_integer(data, end) + (i ? 1 : 0);
+                if (index >= this->_groups_count) {
+                    throw_corrupted_row(point_hash);
+                }
+                indices[i] = index;
+            }
+            if ((size_t) (end - data) < count * sizeof(quantized_t)) {
+                throw_corrupted_row(point_hash);
+            }
+            const T scale = _table[point_hash].scale;
+            for (size_t i=0; i<count; ++i) {
+                quantized_t quantized;
+                memcpy(&quantized, data + i * sizeof(quantized_t), sizeof(quantized_t));
+                values[i] = scale * quantized;
+            }
+        }
+        virtual const std::vector<T> get_score_map(const uint32_t& point_hash) {
+            std::vector<T> result(this->_groups_count, 0);
+            std::vector<uint32_t> indices;
+            std::vector<T> values;
+            get_sparse_score_map(point_hash, indices, values);
+            for (size_t i=0; i<indices.size(); ++i) {
+                result[indices[i]] = values[i];
+            }
+            return result;
+        }
+        virtual const std::span<const T> view_score_map(const uint32_t& point_hash) {
+            thread_local std::vector<uint32_t> indices;
+            thread_local std::vector<T> values;
+            std::vector<T>& view = this->get_view_buffer();
+            view.assign(this->_groups_count, 0);
+            get_sparse_score_map(point_hash, indices, values);
+            for (size_t i=0; i<indices.size(); ++i) {
+                view[indices[i]] = values[i];
+            }
+            return view;
+        }
+
+        inline const size_t get_points_count() const {
+            return _points_count;
+        }
+
+        // write
+
+        virtual void clear() {
+            except("SparseFileScorerCache is read-only");
+        }
+        virtual void integrate(const size_t& group_index, const uint32_t& point_hash, const T& value) {
+            except("SparseFileScorerCache is read-only");
+        }
+        virtual void integrate(const uint32_t& point_hash, const std::vector<T>& values, const bool replace=true) {
+            except("SparseFileScorerCache is read-only");
+        }
+        virtual void integrate_into(ScorerCache<T>& destination, const bool replace=true) {
+            for (size_t point_hash=0; point_hash<_points_count; ++point_hash) {
+                const std::vector<T> values = get_score_map(point_hash);
+                if (this->is_nonzero(values)) {
+                    destination.integrate(point_hash, values, replace);
+                }
+            }
+        }
+
+        virtual const std::string get_type_name() const {
+            return "SparseFileScorerCache";
+        }
+
+    private:
+
+        // variable-length integers, in the same block layout as Types::VarUInt64
+
+        static inline void encode_integer(uint64_t source, std::vector<uint8_t>& destination) {
+            do {
+                Types::VarIntegerBlock block;
+                block.value7 = source & 127;
+                source >>= 7;
+                block.is_last_ = (source == 0);
+                destination.push_back(block.data);
+            } while (source);
+        }
+        // decoding stops at the end of the row, so that corrupted data cannot be read past it
+        static inline const uint64_t decode_integer(const uint8_t*& source, const uint8_t* end) {
+            uint64_t result = 0;
+            for (int shift=0; source < end && shift < 64; shift+=7) {
+                Types::VarIntegerBlock block;
+                block.data = *source++;
+                result |= (uint64_t) block.value7 << shift;
+                if (block.is_last_) {
+                    return result;
+                }
+            }
+            throw Exceptions::BadDataException("Invalid variable-length integer in sparse scorer cache", {});
+        }
+
+        // check header & table, so that every row lies within the mapped file
+
+        void check() {
+            const Header& header = * (const Header*) _data;
+            if (memcmp(header.magic, magic, sizeof(header.magic)) || header.version != version || header.value_size != sizeof(quantized_t)) {
+                throw Exceptions::BadDataException("File " + _path.native() + " is not a sparse scorer cache with a supported version", {});
+            }
+            if (header.groups_count != this->_groups_count) {
+                except("Groups count does not match in", _path.native(), "(got", header.groups_count, "but expected", this->_groups_count, "instead)");
+            }
+            if (header.points_count >= (_size - header_size) / sizeof(TableEntry)) {
+                throw Exceptions::BadDataException("File " + _path.native() + " is truncated", {});
+            }
+            _points_count = header.points_count;
+            _table = (const TableEntry*) (_data + header_size);
+            uint64_t previous_offset = header_size + (_points_count + 1) * sizeof(TableEntry);
+            for (size_t point_hash=0; point_hash<=_points_count; ++point_hash) {
+                const uint64_t offset = _table[point_hash].offset;
+                if (offset < previous_offset || offset > _size) {
+                    throw Exceptions::BadDataException("File " + _path.native() + " has an invalid offset for point #" + std::to_string(point_hash), {});
+                }
+                previous_offset = offset;
+            }
+        }
+        [[noreturn]] void throw_corrupted_row(const uint32_t point_hash) const {
+            throw Exceptions::BadDataException("File " + _path.native() + " has a corrupted row for point #" + std::to_string(point_hash), {});
+        }
+
+        // a short write, typically because the disk is full, would leave a truncated file
+
+        static void write_data(FILE* f, const void* data, const size_t size, const size_t count, const std::filesystem::path& path) {
+            if (fwrite(data, size, count, f) != count) {
+                const std::string error = strerror(errno);
+                fclose(f);
+                except("Could not write file " + path.native() + ", " + error);
+            }
+        }
+
+        static const double encode_row(const std::span<const T> row, std::vector<uint8_t>& destination) {
+            destination.clear();
+            T max = 0;
+            for (const T& value : row) {
+                if (std::isfinite(value)) {
+                    max = std::max<T>(max, std::abs(value));
+                }
+            }
+            const double scale = max / std::numeric_limits<quantized_t>::max();
+            // quantized values that round to zero are dropped, as are values that are not finite
+            std::vector<uint32_t> indices;
+            std::vector<quantized_t> values;
+            for (uint32_t i=0; i<row.size(); ++i) {
+                if (row[i] != 0 && std::isfinite(row[i])) {
+                    const quantized_t quantized = (quantized_t) lround(row[i] / scale);
+                    if (quantized) {
+                        indices.push_back(i);
+                        values.push_back(quantized);
+                    }
+                }
+            }
+            encode_integer(indices.size(), destination);
+            for (size_t i=0; i<indices.size(); ++i) {
+                encode_integer(i ? indices[i] - indices[i - 1] - 1 : indices[i], destination);
+            }
+            const size_t values_offset = destination.size();
+            destination.resize(values_offset + values.size() * sizeof(quantized_t));
+            memcpy(destination.data() + values_offset, values.data(), values.size() * sizeof(quantized_t));
+            return scale;
+        }
+
+        const std::filesystem::path _path;
+        const char* _data;
+        size_t _size;
+        size_t _points_count;
+        const TableEntry* _table;
+
+    };
+
+
+} // LinkRbrain::Scoring::Caching
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CACHING__SPARSEFILESCORERCACHE_HPP
@@ -0,0 +1,155 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CORRELATIONRESULTCACHE_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CORRELATIONRESULTCACHE_HPP
+
+
+#include "./ScoredGroupList.hpp"
+#include "Types/LRUCache.hpp"
+#include "Types/Point.hpp"
+
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+
+
+namespace LinkRbrain::Scoring {
+
+
+    // bounded LRU cache of correlation results, keyed by the whole normalized query and its
+    // hash, so that colliding hashes do not share results; the size of the cache is measured
+    // in bytes, and the least recently used results are evicted first when it is exceeded;
+    // every method can be called concurrently
+
+    template <typename T>
+    class CorrelationResultCache {
+    public:
+
+        struct Key {
+            uint64_t hash = 0;
+            std::vector<uint64_t> query;
+            inline const bool operator == (const Key& other) const {
+                return hash == other.hash && query == other.query;
+            }
+            inline const bool operator != (const Key& other) const {
+                return !(*this == other);
+            }
+        };
+        struct KeyHash {
+            inline const size_t operator () (const Key& key) const {
+                return key.hash;
+            }
+        };
+        typedef std::shared_ptr<const ScoredGroupList<T>> Value;
+
+        static const size_t default_max_size = 64 << 20;
+
+        // a single shard, so that results as large as the whole cache can be stored;
+        // lookups are short compared to correlations anyway
+        CorrelationResultCache(const size_t max_size=default_max_size) :
+            _cache(max_size, 1) {}
+        CorrelationResultCache(const CorrelationResultCache&) = delete;
+        CorrelationResultCache& operator = (const CorrelationResultCache&) = delete;
+
+        // points order within a query group does not matter, and null weights are ignored;
+        // query groups order is kept, as scores are given for each of them
+
+        static const Key compute_key(const std::vector<std::vector<Types::Point<T>>>& query_groups_points, const size_t dataset_hash, const std::initializer_list<uint64_t> settings) {
+            Key key;
+            key.query.push_back(dataset_hash);
+            key.query.insert(key.query.end(), settings.begin(), settings.end());
+            key.query.push_back(query_groups_points.size());
+            std::vector<Types::Point<T>> points;
+            for (const auto& query_group_points : query_groups_points) {
+                points.clear();
+                for (const auto& point : query_group_points) {
+                    if (point.weight != static_cast<T>(0)) {
+                        points.push_back(point);
+                    }
+                }
+                std::sort(points.begin(), points.end(), [] (const Types::Point<T>& a, const Types::Point<T>& b) {
+                    return std::lexicographical_compare(a.values, a.values + 4, b.values, b.values + 4);
+                });
+                key.query.push_back(points.size());
+                for (const auto& point : points) {
+                    for (const T& value : point.values) {
+                        key.query.push_back(get_bits(value));
+                    }
+                }
+            }
+            for (const uint64_t value : key.query) {
+                key.hash = mix(key.hash, value);
+            }
+            return key;
+        }
+
+        // estimation of the memory used by a result, and its key
+
+        static const size_t compute_size(const Key& key, const ScoredGroupList<T>& result) {
+            return sizeof(Key) + 2 * key.query.capacity() * sizeof(uint64_t)
+                + sizeof(ScoredGroupList<T>) + result.capacity() * sizeof(ScoredGroup<T>)
+                + result.size() * result.get_count() * sizeof(T);
+        }
+
+        // return a null pointer if the key is not found
+
+        inline Value get(const Key& key) {
+            return _cache.get(key);
+        }
+
+        // results larger than the whole cache are not stored
+
+        inline void put(const Key& key, Value value) {
+            const size_t size = compute_size(key, *value);
+            _cache.put(key, std::move(value), size);
+        }
+
+        inline void invalidate() {
+            _cache.clear();
+        }
+
+        inline void set_max_size(const size_t max_size) {
+            _cache.set_max_size(max_size);
+        }
+        inline const size_t get_max_size() {
+            return _cache.get_max_size();
+        }
+        inline const size_t get_size() {
+            return _cache.get_stats().size;
+        }
+        inline const size_t get_count() {
+            return _cache.get_stats().count;
+        }
+        inline const size_t get_hits() {
+            return _cache.get_stats().hits;
+        }
+        inline const size_t get_misses() {
+            return _cache.get_stats().misses;
+        }
+
+    private:
+
+        // combine with splitmix64 finalizer
+        static inline const uint64_t mix(const uint64_t hash, const uint64_t value) {
+            uint64_t x = hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+        // -0.0 and 0.0 give the same bits
+        static inline const uint64_t get_bits(const T& value) {
+            const T normalized = value + static_cast<T>(0);
+            uint64_t bits = 0;
+            memcpy(&bits, &normalized, std::min(sizeof(bits), sizeof(normalized)));
+            return bits;
+        }
+
+        Types::LRUCache<Key, Value, KeyHash> _cache;
+
+    };
+
+
+} // LinkRbrain::Scoring
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__CORRELATIONRESULTCACHE_HPP
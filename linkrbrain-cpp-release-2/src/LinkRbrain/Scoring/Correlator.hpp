@@ -6,13 +6,19 @@
 #include "../Graph/Graph.hpp"
 #include "./Scorer.hpp"
 #include "./ScoredGroupList.hpp"
+#include "./CorrelationResultCache.hpp"
+#include "./SparseMatrix.hpp"
 #include "./Caching/Manager.hpp"
+#include "Parallel/ThreadPool.hpp"
 #include "Types/NumberNature.hpp"
 #include "Conversion/Binary.hpp"
 
 #include "Logging/Loggable.hpp"
 
+#include <atomic>
+#include <deque>
 #include <thread>
+#include <functional>
 #include <fstream>
 #include <filesystem>
 #include <unordered_map>
@@ -97,19 +103,16 @@ namespace LinkRbrain::Scoring {
             normalize(false);
         }
 
-        const size_t get_dataset_group_index(const Models::Group<T>& group, const bool is_recursing=false) {
+        // groups must belong to the normalized dataset, as those of results from this correlator do;
+        // indexes are only built by prepare_groups(), as the dataset does not change afterwards
+
+        const bool has_dataset_group(const Models::Group<T>& group) const {
+            return _groups_indexes.contains(&group);
+        }
+        const size_t get_dataset_group_index(const Models::Group<T>& group) const {
             const auto it = _groups_indexes.find(&group);
             if (it == _groups_indexes.end()) {
-                if (is_recursing) {
-                    throw Exceptions::Exception("Could not retrieve index of group: " + group.get_label());
-                } else {
-                    _groups_indexes.clear();
-                    const auto& groups = _dataset.get_groups();
-                    for (size_t group_index = 0; group_index < groups.size(); group_index++) {
-                        _groups_indexes.insert({&(groups[group_index]), group_index});
-                    }
-                    return get_dataset_group_index(group, true);
-                }
+                throw Exceptions::Exception("Could not retrieve index of group: " + group.get_label());
             }
             return it->second;
         }
@@ -142,20 +145,35 @@ namespace LinkRbrain::Scoring {
             get_logger().notice("Saved to", path.native());
         }
 
-        const T score(std::vector<Types::Point<T>> points1, std::vector<Types::Point<T>> points2) {
+        // once normalized, correlating does not modify the correlator, which can then be shared
+        // between threads; only the results cache, which has its own lock, is written to
+
+        const T score(std::vector<Types::Point<T>> points1, std::vector<Types::Point<T>> points2) const {
             normalize_between_groups(points1);
             normalize_group_within(points1);
             normalize_between_groups(points2);
             normalize_group_within(points2);
-            return _scorer.score(points1, points2);
+            return _scorer.score(Types::PackedPoints<T>(points1), Types::PackedPoints<T>(points2));
         }
 
-        const ScoredGroupList<T> correlate(std::vector<std::vector<Types::Point<T>>> query_groups_points, const bool sort=true, const size_t limit=-1, const bool force_uncached=false, const bool use_interpolation=false) {
+        // sorted results are kept in a cache, keyed by the normalized query
+
+        const ScoredGroupList<T> correlate(std::vector<std::vector<Types::Point<T>>> query_groups_points, const bool sort=true, const size_t limit=-1, const bool force_uncached=false, const bool use_interpolation=false) const {
             // normalize & compute
             for (std::vector<Types::Point<T>>& query_group_points : query_groups_points) {
                 normalize_between_groups(query_group_points);
                 normalize_group_within(query_group_points);
             }
+            // look for an identical query
+            typename CorrelationResultCache<T>::Key key;
+            if (sort) {
+                key = CorrelationResultCache<T>::compute_key(query_groups_points, _original_dataset_hash, {limit, force_uncached, use_interpolation});
+                const auto cached = _results_cache.get(key);
+                if (cached) {
+                    get_logger().debug("Found correlation result in cache");
+                    return *cached;
+                }
+            }
             // instanciate result
             ScoredGroupList<T> result(_dataset.get_groups(), query_groups_points.size());
             // compute scores for each query group
@@ -167,29 +185,135 @@ namespace LinkRbrain::Scoring {
                     correlate_cached(result, query_group_index, query_groups_points[query_group_index], use_interpolation);
                 }
             }
-            // compute overall scores
-            for (ScoredGroup<T>& scored_group : result) {
-                scored_group.overall_score = _scorer.compute_overall_score(scored_group.scores);
+            // compute overall scores, sort if necessary
+            finish_correlation(result, sort, limit, key);
+            return result;
+        }
+
+        // correlate several queries at once; cache rows are fetched once for all the points
+        // sharing the same index, then accumulated into the scores of every query using them
+
+        const std::vector<ScoredGroupList<T>> correlate_batch(const std::vector<std::vector<std::vector<Types::Point<T>>>>& queries, const bool sort=true, const size_t limit=-1, const bool use_interpolation=false) const {
+            std::vector<ScoredGroupList<T>> results;
+            results.reserve(queries.size());
+            // without points cache, there is nothing to share
+            if (_status < CachedPoints || !_points_cache) {
+                for (const auto& query : queries) {
+                    results.push_back(correlate(query, sort, limit, false, use_interpolation));
+                }
+                return results;
             }
-            // sort if nececessary
-            if (sort) {
-                result.sort(limit);
-                get_logger().debug("Sorted correlation result");
+            // normalize queries, look for identical ones in results cache, list points of the others;
+            // each column is a query group of a query that has to be computed
+            struct Entry {
+                uint32_t point_index;
+                uint32_t column;
+                T weight;
+            };
+            std::vector<Entry> entries;
+            std::vector<std::pair<size_t, size_t>> columns;
+            std::vector<typename CorrelationResultCache<T>::Key> keys(queries.size());
+            std::vector<bool> is_cached(queries.size(), false);
+            for (size_t query_index = 0; query_index < queries.size(); query_index++) {
+                std::vector<std::vector<Types::Point<T>>> query_groups_points = queries[query_index];
+                for (std::vector<Types::Point<T>>& query_group_points : query_groups_points) {
+                    normalize_between_groups(query_group_points);
+                    normalize_group_within(query_group_points);
+                }
+                if (sort) {
+                    keys[query_index] = CorrelationResultCache<T>::compute_key(query_groups_points, _original_dataset_hash, {limit, false, use_interpolation});
+                    const auto cached = _results_cache.get(keys[query_index]);
+                    if (cached) {
+                        results.push_back(*cached);
+                        is_cached[query_index] = true;
+                        continue;
+                    }
+                }
+                results.push_back(ScoredGroupList<T>(_dataset.get_groups(), query_groups_points.size()));
+                for (size_t query_group_index = 0; query_group_index < query_groups_points.size(); query_group_index++) {
+                    const uint32_t column = columns.size();
+                    for_each_cached_point(query_groups_points[query_group_index], use_interpolation, [&entries, column] (const size_t point_index, const T weight) {
+                        entries.push_back({(uint32_t) point_index, column, weight});
+                    });
+                    columns.push_back({query_index, query_group_index});
+                }
             }
-            return result;
+            // group entries by point index, and merge duplicates within a column
+            std::sort(entries.begin(), entries.end(), [] (const Entry& a, const Entry& b) {
+                return (a.point_index < b.point_index) || (a.point_index == b.point_index && a.column < b.column);
+            });
+            size_t merged_count = 0;
+            for (const Entry& entry : entries) {
+                if (merged_count && entries[merged_count - 1].point_index == entry.point_index && entries[merged_count - 1].column == entry.column) {
+                    entries[merged_count - 1].weight += entry.weight;
+                } else {
+                    entries[merged_count++] = entry;
+                }
+            }
+            entries.resize(merged_count);
+            // fetch each row once, and accumulate it into the contiguous scores of each column using it
+            const size_t groups_count = _dataset.get_groups().size();
+            std::vector<T> accumulator(columns.size() * groups_count, static_cast<T>(0));
+            const bool is_sparse = _points_cache->is_sparse();
+            std::vector<uint32_t> indices;
+            std::vector<T> values;
+            size_t rows_count = 0;
+            for (size_t begin = 0, end = 0; begin < entries.size(); begin = end) {
+                const uint32_t point_index = entries[begin].point_index;
+                for (end = begin; end < entries.size() && entries[end].point_index == point_index; ++end);
+                if (is_sparse) {
+                    _points_cache->get_sparse_score_map(point_index, indices, values);
+                    for (size_t i = begin; i < end; i++) {
+                        T* destination = accumulator.data() + entries[i].column * groups_count;
+                        const T weight = entries[i].weight;
+                        for (size_t j = 0; j < indices.size(); j++) {
+                            destination[indices[j]] += weight * values[j];
+                        }
+                    }
+                } else {
+                    const std::span<const T> row = _points_cache->view_score_map(point_index);
+                    for (size_t i = begin; i < end; i++) {
+                        T* destination = accumulator.data() + entries[i].column * groups_count;
+                        const T weight = entries[i].weight;
+                        for (size_t group_index = 0; group_index < groups_count; group_index++) {
+                            destination[group_index] += weight * row[group_index];
+                        }
+                    }
+                }
+                ++rows_count;
+            }
+            for (size_t column = 0; column < columns.size(); column++) {
+                const auto& [query_index, query_group_index] = columns[column];
+                results[query_index].increment_scores(query_group_index, std::span<const T>(accumulator.data() + column * groups_count, groups_count), 1);
+            }
+            get_logger().debug("Correlated", columns.size(), "query groups of", queries.size(), "queries using", rows_count, "cache rows for", entries.size(), "points");
+            // compute overall scores, sort if necessary
+            for (size_t query_index = 0; query_index < queries.size(); query_index++) {
+                if (!is_cached[query_index]) {
+                    finish_correlation(results[query_index], sort, limit, keys[query_index]);
+                }
+            }
+            return results;
         }
 
-        const std::vector<T> compute_group_scores(const Models::Group<T>& group, const bool force_uncached=false) {
+        const std::vector<T> compute_group_scores(const Models::Group<T>& group, const bool force_uncached=false) const {
             const size_t group_index = get_dataset_group_index(group);
             return (!_groups_cache || _status < CachedGroups || force_uncached)
                 ? compute_group_scores_uncached(group_index)
                 : compute_group_scores_cached(group_index);
         }
-        const std::vector<T> compute_group_scores_cached(const size_t group_index) {
+        const std::vector<T> compute_group_scores_cached(const size_t group_index) const {
             return _groups_cache->get_score_map(group_index);
         }
-        const std::vector<T> compute_group_scores_uncached(const size_t group) {
-            throw Exceptions::Exception("Not implemented: Correlator::compute_group_scores_uncached");
+        const std::vector<T> compute_group_scores_uncached(const size_t group_index) const {
+            const Models::Group<T>& group = _dataset.get_group(group_index);
+            const ScoredGroupList<T> correlations = correlate({group.get_points()}, false, -1, true);
+            std::vector<T> scores;
+            scores.reserve(correlations.size());
+            for (const ScoredGroup<T>& scored_group : correlations) {
+                scores.push_back(scored_group.scores[0]);
+            }
+            return scores;
         }
 
         // caching
@@ -208,6 +332,7 @@ namespace LinkRbrain::Scoring {
                     path
                 )
             );
+            _results_cache.invalidate();
             get_logger().debug("Instanciated correlator points cache object by loading ", path);
         }
         void load_groups_cache(const LinkRbrain::Scoring::Caching::Type& caching_type, const std::filesystem::path& path) {
@@ -218,10 +343,11 @@ namespace LinkRbrain::Scoring {
                     path
                 )
             );
+            _results_cache.invalidate();
             get_logger().debug("Instanciated correlator groups cache object by loading ", path);
         }
 
-        void compute_points_cache(const LinkRbrain::Scoring::Caching::Type& caching_type, const std::filesystem::path& path=".", ComputingMode computing_mode=Basic, const size_t n_threads=std::thread::hardware_concurrency()) {
+        void compute_points_cache(const LinkRbrain::Scoring::Caching::Type& caching_type, const std::filesystem::path& path=".", ComputingMode computing_mode=Basic, const size_t n_threads=std::thread::hardware_concurrency(), const size_t block_size=256) {
             #ifndef USE_CUDA_OPTIMISATION
             if (computing_mode == GPU) {
                 get_logger().warning("Computing mode is set to GPU, but program has not been compiled with CUDA");
@@ -240,9 +366,19 @@ namespace LinkRbrain::Scoring {
                 _points_cache->clear();
                 get_logger().debug("Cleared cache");
             }
-            std::vector<T> scores;
-            scores.resize(groups.size());
-            size_t count = 0;
+            // list nonzero voxels that remain to be computed
+            std::vector<std::pair<size_t, Types::Point<T>>> voxels;
+            for (auto& item : _density_map) {
+                if (* item.value && item.index >= start_index) {
+                    voxels.push_back({item.index, item.coordinates});
+                }
+            }
+            get_logger().debug("Found", voxels.size(), "nonzero voxels to compute from point index", start_index);
+            std::unique_ptr<Parallel::ThreadPool> thread_pool;
+            if (computing_mode == Multithreading) {
+                thread_pool = std::make_unique<Parallel::ThreadPool>(n_threads);
+                get_logger().debug("Started thread pool with", thread_pool->get_size(), "workers");
+            }
             #ifdef USE_CUDA_OPTIMISATION
             if (computing_mode == GPU) {
                 CUDA_precomputing_start(0, n_threads);
@@ -263,59 +399,56 @@ namespace LinkRbrain::Scoring {
                 get_logger().debug("Initialized CUDA precomputer with groups data");
             }
             #endif // USE_CUDA_OPTIMISATION
-            double t0 = Logging::Logger::get_millitime();
-            size_t index0 = start_index;
-            const int display_rate = 20;
-            get_logger().debug("Start computation from point index", start_index);
-            for (auto& item : _density_map) {
-                if (! * item.value || item.index < start_index) {
-                    continue;
-                }
-                _progress = item.index;
-                switch (computing_mode) {
-                    case Basic:
+            // compute voxels block by block; scores of a block are integrated in order, once they are all computed
+            const size_t actual_block_size = block_size ? block_size : 1;
+            std::vector<std::vector<T>> scores(std::min(actual_block_size, voxels.size()), std::vector<T>(groups.size()));
+            std::atomic<size_t> computed_voxels_count = 0;
+            const double t0 = Logging::Logger::get_millitime();
+            double t1 = t0;
+            for (size_t block_start=0; block_start<voxels.size(); block_start+=actual_block_size) {
+                const size_t block_end = std::min(block_start + actual_block_size, voxels.size());
+                _progress = voxels[block_start].first;
+                const auto compute_voxels = [&] (const size_t begin, const size_t end) {
+                    for (size_t v=begin; v<end; ++v) {
+                        std::vector<T>& voxel_scores = scores[v - block_start];
                         for (size_t i=0, n=groups.size(); i<n; ++i) {
-                            scores[i] = _scorer.score(item.coordinates, groups[i].get_points());
+                            voxel_scores[i] = _scorer.score(voxels[v].second, groups[i].get_points());
                         }
-                    break;
-                    case Multithreading: {
-                        const size_t delta = ceil((T) groups.size() / (T) (n_threads - 0));
-                        size_t i_min = 0;
-                        size_t i_max = delta;
-                        std::vector<std::thread*> threads;
-                        for (int t=0; t<n_threads; ++t) {
-                            threads.push_back(
-                                new std::thread(precomputing_thread,
-                                    std::ref(scores), std::ref(_scorer),
-                                    item.coordinates, std::ref(groups),
-                                    i_min, std::min(i_max, groups.size())
-                                )
-                            );
-                            i_min += delta;
-                            i_max += delta;
-                        }
-                        for (std::thread* thread : threads) {
-                            thread->join();
-                        }
-                    } break;
+                        ++computed_voxels_count;
+                    }
+                };
+                switch (computing_mode) {
+                    case Basic:
+                        compute_voxels(block_start, block_end);
+                        break;
+                    case Multithreading:
+                        thread_pool->parallel_for(block_end - block_start, 1, [&] (const size_t begin, const size_t end) {
+                            compute_voxels(block_start + begin, block_start + end);
+                        });
+                        break;
                     case GPU:
                         #ifdef USE_CUDA_OPTIMISATION
-                        CUDA_precomputing_precompute_sphere(scores, item.coordinates, _scorer.get_diameter());
+                        for (size_t v=block_start; v<block_end; ++v) {
+                            CUDA_precomputing_precompute_sphere(scores[v - block_start], voxels[v].second, _scorer.get_diameter());
+                            ++computed_voxels_count;
+                        }
                         #endif // USE_CUDA_OPTIMISATION
                         break;
                 }
-                _points_cache->integrate(item.index, scores, true);
-                if (++count % display_rate == 0) {
-                    const double dt = Logging::Logger::get_millitime() - t0;
-                    const size_t rate = (double)display_rate / dt;
-                    const size_t index_rate = (double)(item.index - index0) / dt;
-                    index0 = item.index;
-                    std::cout << item.index << " / " << _density_map.get_size() << " computed points, " << index_rate << " (" << rate << ")" << " points/second    " << '\r';
-                    t0 = Logging::Logger::get_millitime();
+                for (size_t v=block_start; v<block_end; ++v) {
+                    _points_cache->integrate(voxels[v].first, scores[v - block_start], true);
+                }
+                // inform about progress, at most once per second
+                const double t = Logging::Logger::get_millitime();
+                if (t - t1 >= 1.0 || block_end == voxels.size()) {
+                    const size_t count = computed_voxels_count;
+                    get_logger().detail("Computed", count, "/", voxels.size(), "points,", (size_t) ((double) count / (t - t0)), "points/second");
+                    t1 = t;
                 }
             }
             // the end!
             _status = CachedPoints;
+            _results_cache.invalidate();
             get_logger().notice("Computed cache");
             #ifdef USE_CUDA_OPTIMISATION
             if (computing_mode == GPU) {
@@ -324,34 +457,106 @@ namespace LinkRbrain::Scoring {
             }
             #endif // USE_CUDA_OPTIMISATION
         }
-        void compute_groups_cache(const LinkRbrain::Scoring::Caching::Type& caching_type, const std::filesystem::path& path="") {
-            _status = CachingGroups;
-            // those are the groups
+        // the groups cache is the product S = A.P, where A is the sparse matrix of query weights
+        // of each group at the density map points, and P is the points cache; rows of S are computed
+        // by blocks of groups, so that each row of P is read only once per block; when block size
+        // is zero, blocks are as large as allowed by `groups_cache_block_memory`
+
+        void compute_groups_cache(const LinkRbrain::Scoring::Caching::Type& caching_type, const std::filesystem::path& path="", const size_t n_threads=std::thread::hardware_concurrency(), const size_t block_size=0, const std::function<void()>& checkpoint=nullptr) {
+            if (!_points_cache) {
+                except("Points cache is not set");
+            }
+            // prepare
             const auto& groups = _dataset.get_groups();
-            // instanciate cache
+            const size_t groups_count = groups.size();
+            const size_t start_index = (_status == CachingGroups) ? _progress : 0;
+            _status = CachingGroups;
             _groups_cache.reset(
                 Caching::Manager::make<T>(caching_type, groups, path)
             );
-            // for each of the group, compute all correlations
-            for (size_t i = 0; i < groups.size(); i++) {
-                const auto& group = groups[i];
-                // inform command-line user about current status
-                std::cout << '\r' << std::string(64, ' ');
-                std::cout << "\rComputing group " << (i+1) << " / " << groups.size() << ": " << group.get_label();
-                std::cout.flush();
-                // correlate group with all the others & integrate into cache
-                const std::vector<std::vector<Types::Point<double>>> points{{group.get_points()}};
-                const ScoredGroupList<T> correlations = correlate(points, false);
-                std::vector<T> scores;
-                for (const auto& correlation : correlations) {
-                    scores.push_back(correlation.scores[0]);
+            if (start_index == 0) {
+                _groups_cache->clear();
+                get_logger().debug("Cleared groups cache");
+            }
+            const SparseMatrix<T> weights = compute_groups_weights();
+            get_logger().debug("Built groups weights matrix with", weights.get_nonzero_count(), "nonzero values");
+            Parallel::ThreadPool thread_pool(n_threads);
+            // compute blocks of rows
+            const size_t actual_block_size = block_size ? block_size : std::max<size_t>(1, groups_cache_block_memory / (groups_count * sizeof(T) + 1));
+            const size_t panel_size = 32;
+            const size_t slice_size = std::max<size_t>(256, groups_count / (4 * thread_pool.get_size()) + 1);
+            std::vector<T> block_scores(std::min(actual_block_size, groups_count) * groups_count);
+            std::vector<std::vector<T>> panel(panel_size);
+            const double t0 = Logging::Logger::get_millitime();
+            double t1 = t0;
+            for (size_t block_start=start_index; block_start<groups_count; block_start+=actual_block_size) {
+                const size_t block_end = std::min(block_start + actual_block_size, groups_count);
+                // transpose block, so that entries are grouped by point
+                struct Entry {
+                    uint32_t point_index;
+                    uint32_t row;
+                    T weight;
+                };
+                std::vector<Entry> entries;
+                for (size_t g=block_start; g<block_end; ++g) {
+                    for (size_t k=weights.get_row_begin(g); k<weights.get_row_end(g); ++k) {
+                        entries.push_back({weights.get_column(k), (uint32_t) (g - block_start), weights.get_value(k)});
+                    }
+                }
+                std::stable_sort(entries.begin(), entries.end(), [] (const Entry& a, const Entry& b) {
+                    return a.point_index < b.point_index;
+                });
+                std::fill(block_scores.begin(), block_scores.end(), static_cast<T>(0));
+                // stream points cache rows, a panel at a time
+                for (size_t entries_begin=0; entries_begin<entries.size(); ) {
+                    size_t entries_end = entries_begin;
+                    size_t panel_count = 0;
+                    while (entries_end < entries.size() && (panel_count < panel_size || entries[entries_end].point_index == entries[entries_end - 1].point_index)) {
+                        if (entries_end == entries_begin || entries[entries_end].point_index != entries[entries_end - 1].point_index) {
+                            const std::span<const T> row = _points_cache->view_score_map(entries[entries_end].point_index);
+                            panel[panel_count++].assign(row.begin(), row.end());
+                        }
+                        ++entries_end;
+                    }
+                    thread_pool.parallel_for(groups_count, slice_size, [&] (const size_t begin, const size_t end) {
+                        size_t panel_index = 0;
+                        for (size_t e=entries_begin; e<entries_end; ++e) {
+                            if (e > entries_begin && entries[e].point_index != entries[e - 1].point_index) {
+                                ++panel_index;
+                            }
+                            const T weight = entries[e].weight;
+                            const T* source = panel[panel_index].data();
+                            T* destination = block_scores.data() + entries[e].row * groups_count;
+                            for (size_t h=begin; h<end; ++h) {
+                                destination[h] += weight * source[h];
+                            }
+                        }
+                    });
+                    entries_begin = entries_end;
+                }
+                // write block into groups cache, then checkpoint
+                std::vector<T> scores(groups_count);
+                for (size_t g=block_start; g<block_end; ++g) {
+                    const T* row = block_scores.data() + (g - block_start) * groups_count;
+                    scores.assign(row, row + groups_count);
+                    _groups_cache->integrate(g, scores, true);
+                }
+                _groups_cache->flush();
+                _progress = block_end;
+                if (checkpoint) {
+                    checkpoint();
+                }
+                // inform about progress, at most once per second
+                const double t = Logging::Logger::get_millitime();
+                if (t - t1 >= 1.0 || block_end == groups_count) {
+                    get_logger().detail("Computed", block_end, "/", groups_count, "groups,", (size_t) ((double) (block_end - start_index) / (t - t0)), "groups/second");
+                    t1 = t;
                 }
-                _groups_cache->integrate(i, scores, true);
             }
             // the end!
-            std::cout << '\r' << std::string(64, ' ') << "\rComputed all " << groups.size() << " groups.\n";
-            std::cout.flush();
             _status = CachedGroups;
+            _results_cache.invalidate();
+            get_logger().notice("Computed groups cache");
         }
 
         // getters
@@ -400,6 +605,18 @@ namespace LinkRbrain::Scoring {
         const Types::Array3D<T>& get_density_map() const {
             return _density_map;
         }
+        const Scorer& get_scorer() const {
+            return _scorer;
+        }
+        const std::shared_ptr<Caching::ScorerCache<T>>& get_points_cache() const {
+            return _points_cache;
+        }
+        const std::shared_ptr<Caching::ScorerCache<T>>& get_groups_cache() const {
+            return _groups_cache;
+        }
+        CorrelationResultCache<T>& get_results_cache() const {
+            return _results_cache;
+        }
         const size_t get_progress() const {
             return _progress;
         }
@@ -415,20 +632,26 @@ namespace LinkRbrain::Scoring {
 
     private:
 
-        // precomputing thread
-
-        static void precomputing_thread(std::vector<T>& scores, Scorer& scorer, const Types::Point<T> center, const std::vector<LinkRbrain::Models::Group<T>>& groups, const size_t i_min, const size_t i_max) {
-            for (size_t i=i_min; i<i_max; ++i) {
-                scores[i] = scorer.score(center, groups[i].get_points());
-            }
-        }
-
         // correlation itself
 
-        void correlate_uncached(ScoredGroupList<T>& result, const size_t query_group_index, const std::vector<Types::Point<T>>& query_group_points) {
+        static const size_t spatial_index_threshold = 65536;
+        static const size_t groups_cache_block_memory = 256 << 20;
+
+        void correlate_uncached(ScoredGroupList<T>& result, const size_t query_group_index, const std::vector<Types::Point<T>>& query_group_points) const {
+            // large groups are scored through a grid whose cells are as wide as the scorer diameter,
+            // so that only pairs of points in neighbouring cells are considered
+            const double cell_size = _scorer.get_diameter();
+            const bool use_spatial_index = (cell_size > 0.0);
+            const Types::PackedPoints<T> packed_query_group_points(query_group_points);
+            const SpatialBucketIndex<T> query_spatial_index(query_group_points, use_spatial_index ? cell_size : 1.0);
+            // result is not sorted yet, so its items are in the same order as dataset groups
+            size_t group_index = 0;
             for (ScoredGroup<T>& item : result) {
                 const T score
-                    = _scorer.score(item.group.get_points(), query_group_points);
+                    = (use_spatial_index && item.group.get_points().size() * query_group_points.size() >= spatial_index_threshold)
+                    ? _scorer.score(_groups_spatial_indexes[group_index], query_spatial_index)
+                    : _scorer.score(_groups_packed_points[group_index], packed_query_group_points);
+                ++group_index;
                 if (std::isnan(score)) {
                     get_logger().warning("Score for `", item.group.get_label(), "` is NaN");
                 } else {
@@ -437,11 +660,29 @@ namespace LinkRbrain::Scoring {
             }
             get_logger().debug("Correlated points without using cache");
         }
-        void correlate_cached(ScoredGroupList<T>& result, const size_t query_group_index, const std::vector<Types::Point<T>>& query_group_points, const bool use_interpolation) {
+        void correlate_cached(ScoredGroupList<T>& result, const size_t query_group_index, const std::vector<Types::Point<T>>& query_group_points, const bool use_interpolation) const {
             if (_points_cache.get() == NULL) {
                 except("Cache is not set");
             }
-            //
+            // sparse caches only iterate over nonzero scores, which are scattered into the result
+            const bool is_sparse = _points_cache->is_sparse();
+            std::vector<uint32_t> indices;
+            std::vector<T> values;
+            for_each_cached_point(query_group_points, use_interpolation, [&] (const size_t point_index, const T weight) {
+                if (is_sparse) {
+                    _points_cache->get_sparse_score_map(point_index, indices, values);
+                    result.increment_scores(query_group_index, indices, values, weight);
+                } else {
+                    result.increment_scores(query_group_index, _points_cache->view_score_map(point_index), weight);
+                }
+            });
+            get_logger().debug("Correlated points using cache for query group #", query_group_index);
+        }
+
+        // call function(point_index, weight) for each points cache row contributing to a query group
+
+        template <typename Function>
+        void for_each_cached_point(const std::vector<Types::Point<T>>& query_group_points, const bool use_interpolation, Function&& function) const {
             if (use_interpolation) {
                 // compute result using interpolation
                 for (const Types::Point<T>& point : query_group_points) {
@@ -449,26 +690,47 @@ namespace LinkRbrain::Scoring {
                         if (coefficient == static_cast<T>(0.0)) {
                             continue;
                         }
-                        result.increment_scores(
-                            query_group_index,
-                            _points_cache->get_score_map(point_index),
-                            coefficient * std::sqrt(point.weight)
-                        );
+                        function(point_index, coefficient * std::sqrt(point.weight));
                     }
                 }
             } else {
                 // compute result using grid
                 for (const Types::Point<T>& point : query_group_points) {
                     const size_t point_index = _density_map.compute_index(point.x, point.y, point.z);
-                    result.increment_scores(
-                        query_group_index,
-                        _points_cache->get_score_map(point_index),
-                        (point.weight >= 0) ? std::sqrt(point.weight) : -std::sqrt(-point.weight)
-                    );
+                    function(point_index, (point.weight >= 0) ? std::sqrt(point.weight) : -std::sqrt(-point.weight));
                 }
             }
-            //
-            get_logger().debug("Correlated points using cache for query group #", query_group_index);
+        }
+
+        void finish_correlation(ScoredGroupList<T>& result, const bool sort, const size_t limit, const typename CorrelationResultCache<T>::Key& key) const {
+            for (ScoredGroup<T>& scored_group : result) {
+                scored_group.overall_score = _scorer.compute_overall_score(scored_group.scores);
+            }
+            if (sort) {
+                result.sort(limit);
+                get_logger().debug("Sorted correlation result");
+                _results_cache.put(key, std::make_shared<const ScoredGroupList<T>>(result));
+            }
+        }
+
+        // sparse matrix of each group weights at the density map points, normalized like a query
+
+        const SparseMatrix<T> compute_groups_weights() {
+            SparseMatrix<T> weights(_density_map.get_size());
+            for (const Models::Group<T>& group : _dataset.get_groups()) {
+                std::vector<Types::Point<T>> points = group.get_points();
+                normalize_between_groups(points);
+                normalize_group_within(points);
+                std::vector<std::pair<uint32_t, T>> entries;
+                for (const Types::Point<T>& point : points) {
+                    const T weight = (point.weight >= 0) ? std::sqrt(point.weight) : -std::sqrt(-point.weight);
+                    if (weight != static_cast<T>(0.0)) {
+                        entries.push_back({_density_map.compute_index(point.x, point.y, point.z), weight});
+                    }
+                }
+                weights.add_row(entries);
+            }
+            return weights;
         }
 
         // density map
@@ -523,9 +785,27 @@ namespace LinkRbrain::Scoring {
                 normalize_groups_within();
                 _status = NormalizedAll;
             }
+            prepare_groups();
+        }
+
+        // packed points & spatial indexes of normalized groups are computed once, before the
+        // correlator is shared between threads, and are only read afterwards
+
+        void prepare_groups() {
+            _groups_indexes.clear();
+            _groups_packed_points.clear();
+            _groups_spatial_indexes.clear();
+            const auto& groups = _dataset.get_groups();
+            for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+                _groups_indexes.insert({&(groups[group_index]), group_index});
+                _groups_packed_points.emplace_back(groups[group_index].get_points());
+                if (_scorer.get_diameter() > 0.0) {
+                    _groups_spatial_indexes.emplace_back(groups[group_index].get_points(), _scorer.get_diameter());
+                }
+            }
         }
 
-        void normalize_group_within(std::vector<Types::Point<T>>& points) {
+        void normalize_group_within(std::vector<Types::Point<T>>& points) const {
             const T autoscore = _scorer.autoscore(points);
             if (autoscore == static_cast<T>(0.)) {
                 return;
@@ -542,7 +822,7 @@ namespace LinkRbrain::Scoring {
             get_logger().notice("Normalized groups within");
         }
 
-        void normalize_between_groups(std::vector<Types::Point<T>>& points) {
+        void normalize_between_groups(std::vector<Types::Point<T>>& points) const {
             for (auto& point : points) {
                 const T density = _density_map.get_value(point.x, point.y, point.z);
                 if (density) {
@@ -572,6 +852,9 @@ namespace LinkRbrain::Scoring {
         std::shared_ptr<Caching::ScorerCache<T>> _points_cache;
         std::shared_ptr<Caching::ScorerCache<T>> _groups_cache;
         std::unordered_map<const Models::Group<T>*, size_t> _groups_indexes;
+        std::deque<Types::PackedPoints<T>> _groups_packed_points;
+        std::deque<SpatialBucketIndex<T>> _groups_spatial_indexes;
+        mutable CorrelationResultCache<T> _results_cache;
 
     };
 
@@ -0,0 +1,456 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__KERNELS_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__KERNELS_HPP
+
+
+#include "Types/Point.hpp"
+#include "Types/PointExtrema.hpp"
+#include "Types/Array3D.hpp"
+#include "Types/PackedPoints.hpp"
+#include "Exceptions/Exception.hpp"
+#include "./SpatialBucketIndex.hpp"
+
+#include <cmath>
+#include <vector>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LINKRBRAIN_SCORING_X86
+#include <immintrin.h>
+#endif
+
+
+namespace LinkRbrain::Scoring::Kernels {
+
+
+    // profiles, as a function of the normalized distance x = d / diameter (with 0 <= x <= 1)
+
+    template <typename T>
+    struct DistanceProfile {
+        static inline const T compute(const T x) {
+            return static_cast<T>(1.) - x;
+        }
+    };
+
+    template <typename T>
+    struct SphereProfile {
+        static inline const T compute(const T x) {
+            return static_cast<T>(0.5)*x * (x*x - static_cast<T>(3.0)) + static_cast<T>(1.0);
+        }
+    };
+
+
+    // instruction sets for packed scoring, detected at runtime
+
+    enum InstructionSet : uint8_t {
+        Scalar = 0,
+        SSE4 = 1,
+        AVX2 = 2,
+    };
+
+    inline const InstructionSet detect_instruction_set() {
+        #ifdef LINKRBRAIN_SCORING_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return SSE4;
+        }
+        #endif
+        return Scalar;
+    }
+    inline const InstructionSet& get_instruction_set() {
+        static const InstructionSet instruction_set = detect_instruction_set();
+        return instruction_set;
+    }
+    inline const std::string get_instruction_set_name(const InstructionSet& instruction_set) {
+        switch (instruction_set) {
+            case Scalar:
+                return "Scalar";
+            case SSE4:
+                return "SSE4";
+            case AVX2:
+                return "AVX2";
+            default:
+                return "?";
+        }
+    }
+
+
+    // packed scoring, scalar fallback
+
+    template <typename T, typename Profile>
+    inline const T score_packed_scalar(const Types::PackedPoints<T>& points1, const Types::PackedPoints<T>& points2, const double diameter, const double diameter2) {
+        const T* x2 = points2.get_x();
+        const T* y2 = points2.get_y();
+        const T* z2 = points2.get_z();
+        const T* w2 = points2.get_signed_root_weight();
+        T result = static_cast<T>(0);
+        for (size_t i=0, n1=points1.size(); i<n1; ++i) {
+            const T x1 = points1.get_x()[i];
+            const T y1 = points1.get_y()[i];
+            const T z1 = points1.get_z()[i];
+            const T w1 = points1.get_signed_root_weight()[i];
+            for (size_t j=0, n2=points2.size(); j<n2; ++j) {
+                const T dx = x1 - x2[j];
+                const T dy = y1 - y2[j];
+                const T dz = z1 - z2[j];
+                const T distance2 = dx*dx + dy*dy + dz*dz;
+                if (distance2 > diameter2) continue;
+                const T x = std::sqrt(distance2) / diameter;
+                result += w1 * w2[j] * Profile::compute(x);
+            }
+        }
+        return result;
+    }
+
+
+    #ifdef LINKRBRAIN_SCORING_X86
+
+    // packed scoring, double precision with AVX2: 2 blocks of 4 pairs per iteration
+
+    template <typename Profile>
+    __attribute__((target("avx2")))
+    inline __m256d score_block_avx2(const __m256d x1, const __m256d y1, const __m256d z1, const __m256d w1, const double* x2, const double* y2, const double* z2, const double* w2, const __m256d diameter, const __m256d diameter2) {
+        const __m256d dx = _mm256_sub_pd(x1, _mm256_load_pd(x2));
+        const __m256d dy = _mm256_sub_pd(y1, _mm256_load_pd(y2));
+        const __m256d dz = _mm256_sub_pd(z1, _mm256_load_pd(z2));
+        const __m256d distance2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+        const __m256d mask = _mm256_cmp_pd(distance2, diameter2, _CMP_LE_OQ);
+        if (_mm256_movemask_pd(mask) == 0) {
+            return _mm256_setzero_pd();
+        }
+        const __m256d x = _mm256_div_pd(_mm256_sqrt_pd(distance2), diameter);
+        __m256d profile;
+        if constexpr (std::is_same_v<Profile, SphereProfile<double>>) {
+            profile = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(0.5), x), _mm256_sub_pd(_mm256_mul_pd(x, x), _mm256_set1_pd(3.0))), _mm256_set1_pd(1.0));
+        } else {
+            profile = _mm256_sub_pd(_mm256_set1_pd(1.0), x);
+        }
+        return _mm256_and_pd(mask, _mm256_mul_pd(_mm256_mul_pd(w1, _mm256_load_pd(w2)), profile));
+    }
+    template <typename Profile>
+    __attribute__((target("avx2")))
+    inline const double score_packed_avx2(const Types::PackedPoints<double>& points1, const Types::PackedPoints<double>& points2, const double diameter, const double diameter2) {
+        const double* x2 = points2.get_x();
+        const double* y2 = points2.get_y();
+        const double* z2 = points2.get_z();
+        const double* w2 = points2.get_signed_root_weight();
+        const __m256d d = _mm256_set1_pd(diameter);
+        const __m256d d2 = _mm256_set1_pd(diameter2);
+        __m256d sum_a = _mm256_setzero_pd();
+        __m256d sum_b = _mm256_setzero_pd();
+        for (size_t i=0, n1=points1.size(); i<n1; ++i) {
+            const __m256d x1 = _mm256_set1_pd(points1.get_x()[i]);
+            const __m256d y1 = _mm256_set1_pd(points1.get_y()[i]);
+            const __m256d z1 = _mm256_set1_pd(points1.get_z()[i]);
+            const __m256d w1 = _mm256_set1_pd(points1.get_signed_root_weight()[i]);
+            for (size_t j=0, n2=points2.get_padded_size(); j<n2; j+=8) {
+                sum_a = _mm256_add_pd(sum_a, score_block_avx2<Profile>(x1, y1, z1, w1, x2+j, y2+j, z2+j, w2+j, d, d2));
+                sum_b = _mm256_add_pd(sum_b, score_block_avx2<Profile>(x1, y1, z1, w1, x2+j+4, y2+j+4, z2+j+4, w2+j+4, d, d2));
+            }
+        }
+        alignas(32) double sums[4];
+        _mm256_store_pd(sums, _mm256_add_pd(sum_a, sum_b));
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+
+    // packed scoring, single precision with AVX2: 1 block of 8 pairs per iteration
+
+    template <typename Profile>
+    __attribute__((target("avx2")))
+    inline const float score_packed_avx2(const Types::PackedPoints<float>& points1, const Types::PackedPoints<float>& points2, const double diameter, const double diameter2) {
+        const float* x2 = points2.get_x();
+        const float* y2 = points2.get_y();
+        const float* z2 = points2.get_z();
+        const float* w2 = points2.get_signed_root_weight();
+        const __m256 d = _mm256_set1_ps(diameter);
+        const __m256 d2 = _mm256_set1_ps(diameter2);
+        __m256 sum = _mm256_setzero_ps();
+        for (size_t i=0, n1=points1.size(); i<n1; ++i) {
+            const __m256 x1 = _mm256_set1_ps(points1.get_x()[i]);
+            const __m256 y1 = _mm256_set1_ps(points1.get_y()[i]);
+            const __m256 z1 = _mm256_set1_ps(points1.get_z()[i]);
+            const __m256 w1 = _mm256_set1_ps(points1.get_signed_root_weight()[i]);
+            for (size_t j=0, n2=points2.get_padded_size(); j<n2; j+=8) {
+                const __m256 dx = _mm256_sub_ps(x1, _mm256_load_ps(x2+j));
+                const __m256 dy = _mm256_sub_ps(y1, _mm256_load_ps(y2+j));
+                const __m256 dz = _mm256_sub_ps(z1, _mm256_load_ps(z2+j));
+                const __m256 distance2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+                const __m256 mask = _mm256_cmp_ps(distance2, d2, _CMP_LE_OQ);
+                if (_mm256_movemask_ps(mask) == 0) {
+                    continue;
+                }
+                const __m256 x = _mm256_div_ps(_mm256_sqrt_ps(distance2), d);
+                __m256 profile;
+                if constexpr (std::is_same_v<Profile, SphereProfile<float>>) {
+                    profile = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), _mm256_sub_ps(_mm256_mul_ps(x, x), _mm256_set1_ps(3.0f))), _mm256_set1_ps(1.0f));
+                } else {
+                    profile = _mm256_sub_ps(_mm256_set1_ps(1.0f), x);
+                }
+                sum = _mm256_add_ps(sum, _mm256_and_ps(mask, _mm256_mul_ps(_mm256_mul_ps(w1, _mm256_load_ps(w2+j)), profile)));
+            }
+        }
+        alignas(32) float sums[8];
+        _mm256_store_ps(sums, sum);
+        return ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+    }
+
+    // packed scoring, double precision with SSE4: 4 blocks of 2 pairs per iteration
+
+    template <typename Profile>
+    __attribute__((target("sse4.1")))
+    inline __m128d score_block_sse4(const __m128d x1, const __m128d y1, const __m128d z1, const __m128d w1, const double* x2, const double* y2, const double* z2, const double* w2, const __m128d diameter, const __m128d diameter2) {
+        const __m128d dx = _mm_sub_pd(x1, _mm_load_pd(x2));
+        const __m128d dy = _mm_sub_pd(y1, _mm_load_pd(y2));
+        const __m128d dz = _mm_sub_pd(z1, _mm_load_pd(z2));
+        const __m128d distance2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+        const __m128d mask = _mm_cmple_pd(distance2, diameter2);
+        if (_mm_movemask_pd(mask) == 0) {
+            return _mm_setzero_pd();
+        }
+        const __m128d x = _mm_div_pd(_mm_sqrt_pd(distance2), diameter);
+        __m128d profile;
+        if constexpr (std::is_same_v<Profile, SphereProfile<double>>) {
+            profile = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(0.5), x), _mm_sub_pd(_mm_mul_pd(x, x), _mm_set1_pd(3.0))), _mm_set1_pd(1.0));
+        } else {
+            profile = _mm_sub_pd(_mm_set1_pd(1.0), x);
+        }
+        return _mm_and_pd(mask, _mm_mul_pd(_mm_mul_pd(w1, _mm_load_pd(w2)), profile));
+    }
+    template <typename Profile>
+    __attribute__((target("sse4.1")))
+    inline const double score_packed_sse4(const Types::PackedPoints<double>& points1, const Types::PackedPoints<double>& points2, const double diameter, const double diameter2) {
+        const double* x2 = points2.get_x();
+        const double* y2 = points2.get_y();
+        const double* z2 = points2.get_z();
+        const double* w2 = points2.get_signed_root_weight();
+        const __m128d d = _mm_set1_pd(diameter);
+        const __m128d d2 = _mm_set1_pd(diameter2);
+        __m128d sum_a = _mm_setzero_pd();
+        __m128d sum_b = _mm_setzero_pd();
+        for (size_t i=0, n1=points1.size(); i<n1; ++i) {
+            const __m128d x1 = _mm_set1_pd(points1.get_x()[i]);
+            const __m128d y1 = _mm_set1_pd(points1.get_y()[i]);
+            const __m128d z1 = _mm_set1_pd(points1.get_z()[i]);
+            const __m128d w1 = _mm_set1_pd(points1.get_signed_root_weight()[i]);
+            for (size_t j=0, n2=points2.get_padded_size(); j<n2; j+=8) {
+                sum_a = _mm_add_pd(sum_a, score_block_sse4<Profile>(x1, y1, z1, w1, x2+j, y2+j, z2+j, w2+j, d, d2));
+                sum_b = _mm_add_pd(sum_b, score_block_sse4<Profile>(x1, y1, z1, w1, x2+j+2, y2+j+2, z2+j+2, w2+j+2, d, d2));
+                sum_a = _mm_add_pd(sum_a, score_block_sse4<Profile>(x1, y1, z1, w1, x2+j+4, y2+j+4, z2+j+4, w2+j+4, d, d2));
+                sum_b = _mm_add_pd(sum_b, score_block_sse4<Profile>(x1, y1, z1, w1, x2+j+6, y2+j+6, z2+j+6, w2+j+6, d, d2));
+            }
+        }
+        alignas(16) double sums[2];
+        _mm_store_pd(sums, _mm_add_pd(sum_a, sum_b));
+        return sums[0] + sums[1];
+    }
+
+    // packed scoring, single precision with SSE4: 2 blocks of 4 pairs per iteration
+
+    template <typename Profile>
+    __attribute__((target("sse4.1")))
+    inline __m128 score_block_sse4(const __m128 x1, const __m128 y1, const __m128 z1, const __m128 w1, const float* x2, const float* y2, const float* z2, const float* w2, const __m128 diameter, const __m128 diameter2) {
+        const __m128 dx = _mm_sub_ps(x1, _mm_load_ps(x2));
+        const __m128 dy = _mm_sub_ps(y1, _mm_load_ps(y2));
+        const __m128 dz = _mm_sub_ps(z1, _mm_load_ps(z2));
+        const __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        const __m128 mask = _mm_cmple_ps(distance2, diameter2);
+        if (_mm_movemask_ps(mask) == 0) {
+            return _mm_setzero_ps();
+        }
+        const __m128 x = _mm_div_ps(_mm_sqrt_ps(distance2), diameter);
+        __m128 profile;
+        if constexpr (std::is_same_v<Profile, SphereProfile<float>>) {
+            profile = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_sub_ps(_mm_mul_ps(x, x), _mm_set1_ps(3.0f))), _mm_set1_ps(1.0f));
+        } else {
+            profile = _mm_sub_ps(_mm_set1_ps(1.0f), x);
+        }
+        return _mm_and_ps(mask, _mm_mul_ps(_mm_mul_ps(w1, _mm_load_ps(w2)), profile));
+    }
+    template <typename Profile>
+    __attribute__((target("sse4.1")))
+    inline const float score_packed_sse4(const Types::PackedPoints<float>& points1, const Types::PackedPoints<float>& points2, const double diameter, const double diameter2) {
+        const float* x2 = points2.get_x();
+        const float* y2 = points2.get_y();
+        const float* z2 = points2.get_z();
+        const float* w2 = points2.get_signed_root_weight();
+        const __m128 d = _mm_set1_ps(diameter);
+        const __m128 d2 = _mm_set1_ps(diameter2);
+        __m128 sum_a = _mm_setzero_ps();
+        __m128 sum_b = _mm_setzero_ps();
+        for (size_t i=0, n1=points1.size(); i<n1; ++i) {
+            const __m128 x1 = _mm_set1_ps(points1.get_x()[i]);
+            const __m128 y1 = _mm_set1_ps(points1.get_y()[i]);
+            const __m128 z1 = _mm_set1_ps(points1.get_z()[i]);
+            const __m128 w1 = _mm_set1_ps(points1.get_signed_root_weight()[i]);
+            for (size_t j=0, n2=points2.get_padded_size(); j<n2; j+=8) {
+                sum_a = _mm_add_ps(sum_a, score_block_sse4<Profile>(x1, y1, z1, w1, x2+j, y2+j, z2+j, w2+j, d, d2));
+                sum_b = _mm_add_ps(sum_b, score_block_sse4<Profile>(x1, y1, z1, w1, x2+j+4, y2+j+4, z2+j+4, w2+j+4, d, d2));
+            }
+        }
+        alignas(16) float sums[4];
+        _mm_store_ps(sums, _mm_add_ps(sum_a, sum_b));
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+
+    #endif // LINKRBRAIN_SCORING_X86
+
+
+    // packed scoring, dispatched according to the instruction set
+
+    template <typename T, typename Profile>
+    inline const T score_packed(const Types::PackedPoints<T>& points1, const Types::PackedPoints<T>& points2, const double diameter, const double diameter2, const InstructionSet instruction_set=get_instruction_set()) {
+        #ifdef LINKRBRAIN_SCORING_X86
+        if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>) {
+            switch (instruction_set) {
+                case AVX2:
+                    return score_packed_avx2<Profile>(points1, points2, diameter, diameter2);
+                case SSE4:
+                    return score_packed_sse4<Profile>(points1, points2, diameter, diameter2);
+                default:
+                    break;
+            }
+        }
+        #endif // LINKRBRAIN_SCORING_X86
+        return score_packed_scalar<T, Profile>(points1, points2, diameter, diameter2);
+    }
+
+
+    // radial kernel: every scoring loop is instanciated once per profile,
+    // so that no branching on the scoring mode happens within inner loops
+
+    template <typename T, typename Profile>
+    struct RadialKernel {
+
+        RadialKernel(const double _diameter) :
+            diameter(_diameter),
+            diameter2(_diameter * _diameter) {}
+
+        inline const T score(const Types::Point<T>& p1, const Types::Point<T>& p2) const {
+            const T dx = p1.x - p2.x;
+            const T dy = p1.y - p2.y;
+            const T dz = p1.z - p2.z;
+            const T distance2 = dx*dx + dy*dy + dz*dz;
+            if (distance2 > diameter2) return static_cast<T>(0.);
+            const T x = std::sqrt(distance2) / diameter;
+            //
+            const T w = p1.weight * p2.weight;
+            const T w2 = std::sqrt(std::abs(w));
+            return (w<0 ? -w2 : w2) * Profile::compute(x);
+        }
+
+        inline const T score(const Types::Point<T>& p1, const std::vector<Types::Point<T>>& points2) const {
+            T result = static_cast<T>(0);
+            for (const Types::Point<T>& p2 : points2) {
+                result += score(p1, p2);
+            }
+            return result;
+        }
+
+        inline const T score(const std::vector<Types::Point<T>>& points1, const std::vector<Types::Point<T>>& points2) const {
+            T result = static_cast<T>(0);
+            for (const Types::Point<T>& p1 : points1) {
+                for (const Types::Point<T>& p2 : points2) {
+                    result += score(p1, p2);
+                }
+            }
+            return result;
+        }
+
+        inline const T score(const Types::PackedPoints<T>& points1, const Types::PackedPoints<T>& points2, const InstructionSet instruction_set=get_instruction_set()) const {
+            return score_packed<T, Profile>(points1, points2, diameter, diameter2, instruction_set);
+        }
+
+        inline const T score(const SpatialBucketIndex<T>& index1, const SpatialBucketIndex<T>& index2) const {
+            if (index1.get_cell_size() != index2.get_cell_size() || index1.get_cell_size() < diameter) {
+                except("Spatial indexes must share the same cell size, at least equal to the scorer diameter");
+            }
+            if (index1.is_out_of_range(index2, diameter)) {
+                return static_cast<T>(0);
+            }
+            T result = static_cast<T>(0);
+            index1.for_each_neighbour_pair(index2, [&] (const Types::Point<T>* begin1, const Types::Point<T>* end1, const Types::Point<T>* begin2, const Types::Point<T>* end2) {
+                for (const Types::Point<T>* p1=begin1; p1<end1; ++p1) {
+                    for (const Types::Point<T>* p2=begin2; p2<end2; ++p2) {
+                        result += score(*p1, *p2);
+                    }
+                }
+            });
+            return result;
+        }
+
+        inline const T autoscore(const std::vector<Types::Point<T>>& points) const {
+            T result = static_cast<T>(0);
+            for (size_t i=0, n=points.size(); i<n; ++i) {
+                const Types::Point<T>& p1 = points[i];
+                const T increment = score(p1, p1);
+                if (!std::isnan(increment)) {
+                    result += increment;
+                }
+                for (size_t j=i+1; j<n; ++j) {
+                    const T increment = static_cast<T>(2.0) * score(p1, points[j]);
+                    if (!std::isnan(increment)) {
+                        result += increment;
+                    }
+                }
+            }
+            return result;
+        }
+
+        inline void project(Types::Array3D<T>& densitymap, const Types::Point<T>& point) const {
+            Types::PointExtrema<T> window(point);
+            window.inflate_dimensions(diameter);
+            for (auto& iterator : densitymap.restrict_coordinates(window)) {
+                *iterator.value += score(iterator.coordinates, point);
+            }
+        }
+
+        const double diameter;
+        const double diameter2;
+    };
+
+
+    // fallback for unknown scoring modes: every score is NaN
+
+    template <typename T>
+    struct NaNKernel {
+
+        NaNKernel(const double _diameter) :
+            diameter(_diameter) {}
+
+        inline const T score(const Types::Point<T>& p1, const Types::Point<T>& p2) const {
+            return static_cast<T>(NAN);
+        }
+        inline const T score(const Types::Point<T>& p1, const std::vector<Types::Point<T>>& points2) const {
+            return points2.size() ? static_cast<T>(NAN) : static_cast<T>(0);
+        }
+        inline const T score(const std::vector<Types::Point<T>>& points1, const std::vector<Types::Point<T>>& points2) const {
+            return (points1.size() && points2.size()) ? static_cast<T>(NAN) : static_cast<T>(0);
+        }
+        inline const T score(const Types::PackedPoints<T>& points1, const Types::PackedPoints<T>& points2, const InstructionSet instruction_set=get_instruction_set()) const {
+            return (points1.size() && points2.size()) ? static_cast<T>(NAN) : static_cast<T>(0);
+        }
+        inline const T score(const SpatialBucketIndex<T>& index1, const SpatialBucketIndex<T>& index2) const {
+            return (index1.size() && index2.size()) ? static_cast<T>(NAN) : static_cast<T>(0);
+        }
+        inline const T autoscore(const std::vector<Types::Point<T>>& points) const {
+            return static_cast<T>(0);
+        }
+        inline void project(Types::Array3D<T>& densitymap, const Types::Point<T>& point) const {}
+
+        const double diameter;
+    };
+
+
+    template <typename T>
+    using DistanceKernel = RadialKernel<T, DistanceProfile<T>>;
+
+    template <typename T>
+    using SphereKernel = RadialKernel<T, SphereProfile<T>>;
+
+
+} // LinkRbrain::Scoring::Kernels
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__KERNELS_HPP
@@ -4,7 +4,10 @@
 
 #include "./ScoredGroup.hpp"
 
-#include <map>
+#include <span>
+#include <cmath>
+#include <vector>
+#include <algorithm>
 
 
 namespace LinkRbrain::Scoring {
@@ -21,7 +24,7 @@ namespace LinkRbrain::Scoring {
             }
         }
 
-        void increment_scores(const size_t query_group_index, const std::vector<T>& values, const T& weight) {
+        void increment_scores(const size_t query_group_index, const std::span<const T> values, const T& weight) {
             if (values.size() != this->size()) {
                 except("Vector sizes do not match in ScoredGroupList::increment_scores");
             }
@@ -31,22 +34,44 @@ namespace LinkRbrain::Scoring {
             }
         }
 
-        ScoredGroupList<T> sorted(const size_t limit=-1) {
-            // first, insert into multimap
-            std::multimap<T, ScoredGroup<T>*> sorted;
-            for (ScoredGroup<T>& scored_group : *this) {
-                if (scored_group.overall_score) {
-                    sorted.insert({scored_group.overall_score, &scored_group});
+        void increment_scores(const size_t query_group_index, const std::span<const uint32_t> indices, const std::span<const T> values, const T& weight) {
+            if (indices.size() != values.size()) {
+                except("Vector sizes do not match in ScoredGroupList::increment_scores");
+            }
+            for (size_t i = 0; i < indices.size(); i++) {
+                (*this)[indices[i]].scores[query_group_index] += weight * values[i];
+            }
+        }
+
+        // groups are sorted by decreasing overall score, and equal scores by decreasing index;
+        // groups with a null overall score are left out, undefined ones are kept last
+
+        ScoredGroupList<T> sorted(const size_t limit=-1) const {
+            // first, select indices of groups to sort
+            std::vector<uint32_t> indices;
+            indices.reserve(this->size());
+            for (uint32_t index = 0; index < this->size(); index++) {
+                const T& overall_score = (*this)[index].overall_score;
+                if (overall_score) {
+                    indices.push_back(index);
                 }
             }
-            // now put this into a vector
-            size_t n = 0;
-            ScoredGroupList<T> sorted_scored_groups(_count);
-            for (auto it=sorted.rbegin(); it!=sorted.rend(); ++it) {
-                if (++n > limit) {
-                    break;
+            // only sort the best ones
+            const auto compare = [this] (const uint32_t a, const uint32_t b) {
+                const T& score_a = (*this)[a].overall_score;
+                const T& score_b = (*this)[b].overall_score;
+                if (std::isnan(score_a) || std::isnan(score_b)) {
+                    return std::isnan(score_a) ? (std::isnan(score_b) && a > b) : true;
                 }
-                sorted_scored_groups.push_back(* it->second);
+                return (score_a > score_b) || (score_a == score_b && a > b);
+            };
+            const size_t n = std::min(limit, indices.size());
+            std::partial_sort(indices.begin(), indices.begin() + n, indices.end(), compare);
+            // now copy them into a list
+            ScoredGroupList<T> sorted_scored_groups(_count);
+            sorted_scored_groups.reserve(n);
+            for (size_t i = 0; i < n; i++) {
+                sorted_scored_groups.push_back((*this)[indices[i]]);
             }
             // the end!
             return sorted_scored_groups;
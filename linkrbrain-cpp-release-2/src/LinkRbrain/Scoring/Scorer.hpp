@@ -6,6 +6,8 @@
 #include "Types/PointExtrema.hpp"
 #include "Types/Array3D.hpp"
 
+#include "./Kernels.hpp"
+
 #include <cmath>
 #include <string>
 
@@ -56,67 +58,73 @@ namespace LinkRbrain::Scoring {
             return _diameter;
         }
 
+        // kernel dispatching: the scoring mode is only examined once per call,
+        // the given function then runs with a kernel specialized for this mode
+
+        template <typename T, typename Function>
+        inline auto dispatch(Function&& function) const {
+            switch (_mode) {
+                case Distance:
+                    return function(Kernels::DistanceKernel<T>(_diameter));
+                case Sphere:
+                    return function(Kernels::SphereKernel<T>(_diameter));
+                default:
+                    return function(Kernels::NaNKernel<T>(_diameter));
+            }
+        }
+
         // scoring itself
 
         template <typename T>
-        inline const T score(const Types::Point<T>& p1, const Types::Point<T>& p2) {
-            if (_mode & 0x10) {
-                const T dx = p1.x - p2.x;
-                const T dy = p1.y - p2.y;
-                const T dz = p1.z - p2.z;
-                const T distance2 = dx*dx + dy*dy + dz*dz;
-                if (distance2 > _diameter2) return static_cast<T>(0.);
-                const T x = std::sqrt(distance2) / this->_diameter;
-                //
-                const T w = p1.weight * p2.weight;
-                const T w2 = std::sqrt(std::abs(w));
-                switch (_mode) {
-                    case Distance:
-                        return (w<0 ? -w2 : w2) * (static_cast<T>(1.) - x);
-                    case Sphere:
-                        return (w<0 ? -w2 : w2) * (static_cast<T>(0.5)*x * (x*x - static_cast<T>(3.0)) + static_cast<T>(1.0));
-                }
-            }
-            return static_cast<T>(NAN);
+        inline const T score(const Types::Point<T>& p1, const Types::Point<T>& p2) const {
+            return dispatch<T>([&] (const auto& kernel) {
+                return kernel.score(p1, p2);
+            });
         }
 
         template <typename T>
-        inline const T score(const Types::Point<T>& p1, const std::vector<Types::Point<T>>& points2) {
-            T result = static_cast<T>(0);
-            for (const Types::Point<T>& p2 : points2) {
-                result += score(p1, p2);
-            }
-            return result;
+        inline const T score(const Types::Point<T>& p1, const std::vector<Types::Point<T>>& points2) const {
+            return dispatch<T>([&] (const auto& kernel) {
+                return kernel.score(p1, points2);
+            });
         }
 
         template <typename T>
-        inline const T score(const std::vector<Types::Point<T>>& points1, const std::vector<Types::Point<T>>& points2) {
-            T result = static_cast<T>(0);
-            for (const Types::Point<T>& p1 : points1) {
-                for (const Types::Point<T>& p2 : points2) {
-                    result += score(p1, p2);
-                }
-            }
-            return result;
+        inline const T score(const std::vector<Types::Point<T>>& points1, const std::vector<Types::Point<T>>& points2) const {
+            return dispatch<T>([&] (const auto& kernel) {
+                return kernel.score(points1, points2);
+            });
         }
 
         template <typename T>
-        inline const T autoscore(const std::vector<Types::Point<T>>& points) {
-            T result = static_cast<T>(0);
-            for (size_t i=0, n=points.size(); i<n; ++i) {
-                const Types::Point<T>& p1 = points[i];
-                const T increment = score(p1, p1);
-                if (!isnan(increment)) {
-                    result += increment;
-                }
-                for (size_t j=i+1; j<n; ++j) {
-                    const T increment = static_cast<T>(2.0) * score(p1, points[j]);
-                    if (!isnan(increment)) {
-                        result += increment;
-                    }
-                }
-            }
-            return result;
+        inline const T score(const Types::PackedPoints<T>& points1, const Types::PackedPoints<T>& points2, const Kernels::InstructionSet instruction_set=Kernels::get_instruction_set()) const {
+            return dispatch<T>([&] (const auto& kernel) {
+                return kernel.score(points1, points2, instruction_set);
+            });
+        }
+
+        template <typename T>
+        inline const T score(const SpatialBucketIndex<T>& index1, const SpatialBucketIndex<T>& index2) const {
+            return dispatch<T>([&] (const auto& kernel) {
+                return kernel.score(index1, index2);
+            });
+        }
+
+        template <typename T>
+        inline const T autoscore(const std::vector<Types::Point<T>>& points) const {
+            return dispatch<T>([&] (const auto& kernel) {
+                return kernel.autoscore(points);
+            });
+        }
+
+        // groups whose bounding boxes are farther apart than the diameter cannot score
+
+        template <typename T>
+        inline const bool are_distant(const Types::PointExtrema<T>& extrema1, const Types::PointExtrema<T>& extrema2) const {
+            return
+                extrema1.min.x - extrema2.max.x > _diameter || extrema2.min.x - extrema1.max.x > _diameter ||
+                extrema1.min.y - extrema2.max.y > _diameter || extrema2.min.y - extrema1.max.y > _diameter ||
+                extrema1.min.z - extrema2.max.z > _diameter || extrema2.min.z - extrema1.max.z > _diameter;
         }
 
         // projection
@@ -131,14 +139,10 @@ namespace LinkRbrain::Scoring {
         }
 
         template <typename T>
-        inline void project(Types::Array3D<T>& densitymap, const Types::Point<T>& point) {
-            Types::PointExtrema<T> window(point);
-            window.inflate_dimensions(_diameter);
-            if (_mode & 0x10) {
-                for (auto& iterator : densitymap.restrict_coordinates(window)) {
-                    *iterator.value += score(iterator.coordinates, point);
-                }
-            }
+        inline void project(Types::Array3D<T>& densitymap, const Types::Point<T>& point) const {
+            dispatch<T>([&] (const auto& kernel) {
+                kernel.project(densitymap, point);
+            });
         }
 
         template <typename T>
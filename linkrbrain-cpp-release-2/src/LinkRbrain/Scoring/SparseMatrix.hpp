@@ -0,0 +1,76 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__SPARSEMATRIX_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__SPARSEMATRIX_HPP
+
+
+#include <stdint.h>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+
+namespace LinkRbrain::Scoring {
+
+
+    // sparse matrix in compressed sparse row (CSR) format, built row by row;
+    // columns are sorted within each row, and duplicate columns are summed
+
+    template <typename T>
+    class SparseMatrix {
+    public:
+
+        SparseMatrix(const size_t columns_count=0) :
+            _columns_count(columns_count),
+            _offsets(1, 0) {}
+
+        void add_row(std::vector<std::pair<uint32_t, T>> entries) {
+            std::stable_sort(entries.begin(), entries.end(), [] (const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+            for (const auto& [column, value] : entries) {
+                if (_columns.size() > _offsets.back() && _columns.back() == column) {
+                    _values.back() += value;
+                } else {
+                    _columns.push_back(column);
+                    _values.push_back(value);
+                }
+            }
+            _offsets.push_back(_columns.size());
+        }
+
+        inline const size_t get_rows_count() const {
+            return _offsets.size() - 1;
+        }
+        inline const size_t& get_columns_count() const {
+            return _columns_count;
+        }
+        inline const size_t get_nonzero_count() const {
+            return _values.size();
+        }
+        inline const size_t& get_row_begin(const size_t row) const {
+            return _offsets[row];
+        }
+        inline const size_t& get_row_end(const size_t row) const {
+            return _offsets[row + 1];
+        }
+        inline const uint32_t& get_column(const size_t offset) const {
+            return _columns[offset];
+        }
+        inline const T& get_value(const size_t offset) const {
+            return _values[offset];
+        }
+
+    private:
+
+        size_t _columns_count;
+        std::vector<size_t> _offsets;
+        std::vector<uint32_t> _columns;
+        std::vector<T> _values;
+
+    };
+
+
+} // LinkRbrain::Scoring
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__SPARSEMATRIX_HPP
@@ -0,0 +1,151 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__SPATIALBUCKETINDEX_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__SPATIALBUCKETINDEX_HPP
+
+
+#include "Types/Point.hpp"
+#include "Types/PointExtrema.hpp"
+
+#include <stdint.h>
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+
+namespace LinkRbrain::Scoring {
+
+
+    // uniform grid over a list of points; with a cell size equal to the scorer
+    // diameter, every pair of points within scoring range lies in neighbouring cells
+
+    template <typename T>
+    class SpatialBucketIndex {
+    public:
+
+        struct Cell {
+            uint64_t key;
+            int32_t x, y, z;
+            uint32_t begin, end;
+        };
+
+        SpatialBucketIndex(const std::vector<Types::Point<T>>& points, const double cell_size) :
+            _cell_size(cell_size)
+        {
+            // sort points by cell key
+            std::vector<uint64_t> keys(points.size());
+            std::vector<uint32_t> order(points.size());
+            if (points.size()) {
+                _extrema = Types::PointExtrema<T>(points[0]);
+            }
+            for (size_t i=0; i<points.size(); ++i) {
+                keys[i] = make_key(get_cell_coordinate(points[i].x), get_cell_coordinate(points[i].y), get_cell_coordinate(points[i].z));
+                _extrema.integrate(points[i]);
+            }
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&keys] (const uint32_t a, const uint32_t b) {
+                return keys[a] < keys[b];
+            });
+            // fill points & cells
+            _points.reserve(points.size());
+            for (const uint32_t i : order) {
+                if (_cells.empty() || _cells.back().key != keys[i]) {
+                    const Types::Point<T>& point = points[i];
+                    _cells.push_back({
+                        .key = keys[i],
+                        .x = get_cell_coordinate(point.x),
+                        .y = get_cell_coordinate(point.y),
+                        .z = get_cell_coordinate(point.z),
+                        .begin = (uint32_t) _points.size(),
+                        .end = (uint32_t) _points.size(),
+                    });
+                    _keys.push_back(keys[i]);
+                }
+                _points.push_back(points[i]);
+                ++_cells.back().end;
+            }
+        }
+
+        inline const double& get_cell_size() const {
+            return _cell_size;
+        }
+        inline const std::vector<Types::Point<T>>& get_points() const {
+            return _points;
+        }
+        inline const std::vector<Cell>& get_cells() const {
+            return _cells;
+        }
+        inline const Types::PointExtrema<T>& get_extrema() const {
+            return _extrema;
+        }
+        inline const size_t size() const {
+            return _points.size();
+        }
+
+        // are both indexes far enough from each other to ignore every pair?
+        inline const bool is_out_of_range(const SpatialBucketIndex<T>& other, const double range) const {
+            if (_points.empty() || other._points.empty()) {
+                return true;
+            }
+            return (
+                _extrema.min.x - other._extrema.max.x > range || other._extrema.min.x - _extrema.max.x > range ||
+                _extrema.min.y - other._extrema.max.y > range || other._extrema.min.y - _extrema.max.y > range ||
+                _extrema.min.z - other._extrema.max.z > range || other._extrema.min.z - _extrema.max.z > range
+            );
+        }
+
+        // call function(begin1, end1, begin2, end2) for each pair of neighbouring cells, the first one from
+        // this index and the second one from the other; as keys are ordered by x, then y, then z, neighbours
+        // along z are contiguous, and for each of the 9 (x, y) offsets a single merge walk is enough
+        template <typename Function>
+        inline void for_each_neighbour_pair(const SpatialBucketIndex<T>& other, Function&& function) const {
+            const Types::Point<T>* points1 = _points.data();
+            const Types::Point<T>* points2 = other._points.data();
+            const size_t n2 = other._keys.size();
+            for (int64_t dx=-1; dx<=1; ++dx) {
+                for (int64_t dy=-1; dy<=1; ++dy) {
+                    const int64_t shift = (dx << 42) + (dy << 21);
+                    size_t j = 0;
+                    for (const Cell& cell : _cells) {
+                        const uint64_t key_min = cell.key + shift - 1;
+                        const uint64_t key_max = cell.key + shift + 1;
+                        while (j < n2 && other._keys[j] < key_min) {
+                            ++j;
+                        }
+                        for (size_t k=j; k<n2 && other._keys[k]<=key_max; ++k) {
+                            const Cell& other_cell = other._cells[k];
+                            function(points1 + cell.begin, points1 + cell.end, points2 + other_cell.begin, points2 + other_cell.end);
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+
+        static const int32_t coordinate_offset = 1 << 20;
+        static const uint64_t coordinate_mask = (1 << 21) - 1;
+
+        inline const int32_t get_cell_coordinate(const T& value) const {
+            return (int32_t) std::floor(value / _cell_size);
+        }
+        static inline const uint64_t make_key(const int32_t x, const int32_t y, const int32_t z) {
+            return
+                ((uint64_t) ((x + coordinate_offset) & coordinate_mask) << 42) |
+                ((uint64_t) ((y + coordinate_offset) & coordinate_mask) << 21) |
+                ((uint64_t) ((z + coordinate_offset) & coordinate_mask));
+        }
+
+        double _cell_size;
+        Types::PointExtrema<T> _extrema;
+        std::vector<Types::Point<T>> _points;
+        std::vector<Cell> _cells;
+        std::vector<uint64_t> _keys;
+
+    };
+
+
+} // LinkRbrain::Scoring
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__SCORING__SPATIALBUCKETINDEX_HPP
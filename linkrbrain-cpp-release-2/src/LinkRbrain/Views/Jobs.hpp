@@ -0,0 +1,41 @@
+#ifndef LINKRBRAIN2019__SRC__LINKRBRAIN__VIEWS__JOBS_HPP
+#define LINKRBRAIN2019__SRC__LINKRBRAIN__VIEWS__JOBS_HPP
+
+
+#include "./BaseView.hpp"
+
+
+namespace LinkRbrain::Views {
+
+
+    template <typename T>
+    class Jobs : public BaseView<T> {
+    public:
+
+        using BaseView<T>::BaseView;
+        typedef Controllers::AppController<T> AppController;
+
+        virtual void GET(const Request& request, Response& response, AppController& app) {
+            const size_t job_id = std::stoul(request.url_parameters[1]);
+            app.get_jobs_controller().serialize(response.data, job_id);
+        }
+
+        virtual void DELETE(const Request& request, Response& response, AppController& app) {
+            const size_t job_id = std::stoul(request.url_parameters[1]);
+            if (!app.get_jobs_controller().cancel(job_id)) {
+                throw Exceptions::BadDataException("This job has already finished, it cannot be cancelled", {
+                    {"resource", "jobs"},
+                    {"action", "cancel"},
+                    {"problem", "finished"}
+                });
+            }
+            app.get_jobs_controller().serialize(response.data, job_id);
+        }
+
+    };
+
+
+} // LinkRbrain::Views
+
+
+#endif // LINKRBRAIN2019__SRC__LINKRBRAIN__VIEWS__JOBS_HPP
@@ -17,7 +17,7 @@ namespace LinkRbrain::Views {
 
         virtual void GET(const Request& request, Response& response, AppController& app) {
             response.data["data"].set_vector();
-            std::vector<Types::Variant>& data = response.data["data"].get_vector();
+            Types::VariantVector& data = response.data["data"].get_vector();
             const auto& organs = app.get_data_controller().get_organs();
             const size_t n = organs.size();
             data.resize(n);
@@ -49,18 +49,65 @@ namespace LinkRbrain::Views {
                 data["correlations"].unset();
                 data["graph"].unset();
             }
-            // save and return
-            app.get_db_controller().queries.update_data(query, data);
-            // recompute when specified
-            if (data.has("is_computed") && data["is_computed"].get_boolean()) {
-                auto& dataset_controller = app.get_data_controller().get_dataset(query.settings["correlations"]["dataset"]["id"]);
-                dataset_controller.compute(query);
-                app.get_db_controller().queries.update(query, {"correlations", "graph"});
+            // computation is requested; query is only flagged as computed once the job is done
+            const bool must_compute = data.has("is_computed") && data["is_computed"].get_boolean();
+            if (must_compute) {
+                data["is_computed"] = false;
+            }
+            // save; when the computation is invalidated or requested, results of jobs submitted
+            // before are stale, so the query is revised along with the update
+            if (!data.has("is_computed")) {
+                app.get_db_controller().queries.update_data(query, data);
+            } else {
+                const auto previous_query = query;
+                app.get_jobs_controller().revise("queries", query_id, [&] (const size_t revision) {
+                    app.get_db_controller().queries.update_data(query, data);
+                    // recompute in background when specified; the job reads the saved query, but when it
+                    // cannot be queued, the query is restored and left unrevised instead of staying
+                    // uncomputed with no job to compute it
+                    if (must_compute) {
+                        size_t job_id;
+                        try {
+                            job_id = submit_computation(app, query_id, revision);
+                        } catch (...) {
+                            std::vector<std::string> fields_names;
+                            for (const auto& [key, value] : data.get_map()) {
+                                fields_names.push_back(key);
+                            }
+                            app.get_db_controller().queries.update(previous_query, fields_names);
+                            throw;
+                        }
+                        response.code = 202;
+                        app.get_jobs_controller().serialize(response.data["job"], job_id);
+                    }
+                });
             }
             // serialize
             app.get_db_controller().queries.serialize(response.data, query);
         }
 
+    private:
+
+        // results are only saved if the query was not revised since the job was submitted
+
+        const size_t submit_computation(AppController& app, const size_t query_id, const size_t revision) {
+            return app.get_jobs_controller().submit([&app, query_id, revision] (const Controllers::JobsController::Job& job) {
+                auto query = app.get_db_controller().queries.fetch(query_id);
+                auto& dataset_controller = app.get_data_controller().get_dataset(query.settings["correlations"]["dataset"]["id"]);
+                dataset_controller.compute(query);
+                if (!job.is_cancelled()) {
+                    app.get_jobs_controller().save_revision("queries", query_id, revision, [&] {
+                        app.get_db_controller().queries.update(query, {"correlations", "graph", "is_computed"});
+                    });
+                }
+            }, 0, {
+                {"resource", "queries"},
+                {"action", "compute"},
+                {"id", (int64_t) query_id},
+                {"revision", (int64_t) revision}
+            });
+        }
+
     };
 
 
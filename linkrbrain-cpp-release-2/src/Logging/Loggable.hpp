@@ -19,6 +19,10 @@ namespace Logging {
             }
             return * _logger_reference.logger;
         }
+        // logging does not modify the object, even when it is only accessible as const
+        Logger& get_logger() const {
+            return const_cast<Loggable&>(*this).get_logger();
+        }
 
     protected:
 
@@ -2,8 +2,6 @@
 #define LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__BASERESOURCE_HPP
 
 
-#include <regex>
-
 #include "./Connection.hpp"
 
 
@@ -15,23 +13,11 @@ namespace Network::Server::HTTP {
 
         typedef void ParameterType;
 
-        BaseResource(const std::string& url) : _regex_url(url) {}
+        BaseResource(const std::string& url) : _url_pattern(url) {}
         virtual ~BaseResource() {}
 
-        const bool match(Connection& connection) const {
-            // does it match?
-            std::smatch matches;
-            if (!std::regex_match(connection.request.url, matches, _regex_url)) {
-                return false;
-            }
-            // extract matches within path
-            connection.request.url_parameters.resize(matches.size());
-            int index = 0;
-            for (const auto& match : matches) {
-                connection.request.url_parameters[index++] = match;
-            }
-            // that was it!
-            return true;
+        inline const std::string& get_url_pattern() const {
+            return _url_pattern;
         }
 
         virtual void process(Connection& connection) {
@@ -73,7 +59,7 @@ namespace Network::Server::HTTP {
             response.data["message"] = "method not allowed";
         }
 
-        const std::regex _regex_url;
+        const std::string _url_pattern;
 
     };
 
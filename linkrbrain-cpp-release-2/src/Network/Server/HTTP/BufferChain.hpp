@@ -0,0 +1,139 @@
+#ifndef LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__BUFFERCHAIN_HPP
+#define LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__BUFFERCHAIN_HPP
+
+
+#include "Conversion/JSON/serialize.hpp"
+#include "Compression/Zlib/OStream.hpp"
+
+#include <microhttpd.h>
+
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+
+namespace Network::Server::HTTP {
+
+
+    // output buffer made of fixed-size chunks, so that growing it never moves what has
+    // already been written; it is read back by microhttpd through `read_callback`
+
+    class BufferChain : public std::streambuf {
+    public:
+
+        BufferChain(const size_t chunk_size=64 << 10) :
+            _chunk_size(chunk_size) {}
+        BufferChain(const BufferChain&) = delete;
+        BufferChain& operator = (const BufferChain&) = delete;
+
+        // serialize data as is; whether to compress it is decided by the connection
+
+        void write_json(const Types::Variant& data) {
+            std::ostream stream(this);
+            Conversion::JSON::serialize(stream, data);
+        }
+
+        // append the compressed contents of another chain; responses are compressed while
+        // the client waits, so speed matters more than ratio
+
+        void write_gzip(const BufferChain& source) {
+            std::ostream stream(this);
+            Compression::Zlib::OStream compressed(stream, Compression::Zlib::OStreamBuf::default_buff_size, Z_BEST_SPEED);
+            const size_t source_size = source.size();
+            for (size_t offset=0; offset<source_size; offset+=source._chunk_size) {
+                compressed.write(source._chunks[offset / source._chunk_size].get(), std::min(source._chunk_size, source_size - offset));
+            }
+        }
+
+        inline const size_t size() const {
+            return _chunks.empty() ? 0 : (_chunks.size() - 1) * _chunk_size + (pptr() - pbase());
+        }
+        inline const size_t get_chunk_size() const {
+            return _chunk_size;
+        }
+
+        // copy at most `max_size` bytes, starting from `offset`; return the copied size
+
+        const size_t read(const size_t offset, char* destination, const size_t max_size) const {
+            const size_t total_size = size();
+            size_t copied_size = 0;
+            while (copied_size < max_size && offset + copied_size < total_size) {
+                const size_t position = offset + copied_size;
+                const size_t chunk_offset = position % _chunk_size;
+                const size_t copy_size = std::min({
+                    max_size - copied_size,
+                    _chunk_size - chunk_offset,
+                    total_size - position
+                });
+                std::memcpy(destination + copied_size, _chunks[position / _chunk_size].get() + chunk_offset, copy_size);
+                copied_size += copy_size;
+            }
+            return copied_size;
+        }
+
+        const std::string str() const {
+            std::string result(size(), '\0');
+            read(0, result.data(), result.size());
+            return result;
+        }
+
+        // for `MHD_create_response_from_callback`, which takes ownership of the chain
+
+        static ssize_t read_callback(void* _chain, uint64_t position, char* destination, size_t max_size) {
+            const BufferChain& chain = * (BufferChain*) _chain;
+            if (position >= chain.size()) {
+                return MHD_CONTENT_READER_END_OF_STREAM;
+            }
+            return chain.read(position, destination, max_size);
+        }
+        static void free_callback(void* _chain) {
+            delete (BufferChain*) _chain;
+        }
+
+    protected:
+
+        virtual int_type overflow(int_type c) {
+            if (traits_type::eq_int_type(c, traits_type::eof())) {
+                return traits_type::not_eof(c);
+            }
+            add_chunk();
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+            return c;
+        }
+
+        virtual std::streamsize xsputn(const char* source, std::streamsize size) {
+            std::streamsize written_size = 0;
+            while (written_size < size) {
+                if (pptr() == epptr()) {
+                    add_chunk();
+                }
+                const std::streamsize available_size = std::min<std::streamsize>(epptr() - pptr(), size - written_size);
+                std::memcpy(pptr(), source + written_size, available_size);
+                pbump(available_size);
+                written_size += available_size;
+            }
+            return written_size;
+        }
+
+    private:
+
+        void add_chunk() {
+            _chunks.emplace_back(new char[_chunk_size]);
+            char* chunk = _chunks.back().get();
+            setp(chunk, chunk + _chunk_size);
+        }
+
+        const size_t _chunk_size;
+        std::vector<std::unique_ptr<char[]>> _chunks;
+
+    };
+
+
+} // Network::Server::HTTP
+
+
+#endif // LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__BUFFERCHAIN_HPP
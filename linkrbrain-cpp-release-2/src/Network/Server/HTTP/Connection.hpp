@@ -2,10 +2,13 @@
 #define LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__CONNECTION_HPP
 
 
+#include "./BufferChain.hpp"
+#include "./Headers.hpp"
 #include "./Request.hpp"
 #include "./Response.hpp"
 
 #include "Conversion/JSON.hpp"
+#include "Types/VariantArena.hpp"
 
 #include <microhttpd.h>
 #include <map>
@@ -32,7 +35,9 @@ namespace Network::Server::HTTP {
             _post_processor = post_processor;
         }
 
-        void parse_request() {
+        // the size of the body is limited by the server while it is being uploaded, and
+        // its depth by the limit given here, which is always the one of the server
+        void parse_request(const size_t max_json_depth) {
             static std::vector<std::pair<std::string, Format>> content_types = {
                 {"application/json", JSON},
                 {"text/x-json", JSON},
@@ -43,7 +48,7 @@ namespace Network::Server::HTTP {
                     if (it->second.find(content_type) != std::string::npos) {
                         switch (buffering_format) {
                             case JSON:
-                                Conversion::JSON::parse(request.raw, request.data);
+                                Conversion::JSON::Parser(max_json_depth).parse(request.raw.str(), request.data);
                                 return;
                             default:
                                 return;
@@ -52,13 +57,21 @@ namespace Network::Server::HTTP {
                 }
             }
         }
+        // data is only serialized when answering, straight into the response chunks
+
+        const bool has_json_body() {
+            // 304 responses must not have a body
+            const bool has_contents = response.buffer || response.file_descriptor >= 0 || response.code == 304;
+            return !has_contents && response.raw.tellp() == 0  &&  response.data.get_type() != Types::Variant::Undefined;
+        }
+
         void compose_response() {
-            if (response.raw.tellp() == 0  &&  response.data.get_type() != Types::Variant::Undefined) {
+            const bool has_json_body = this->has_json_body();
+            if (has_json_body) {
                 response.headers["Content-Type"] = "application/json";
-                Conversion::JSON::serialize(response.raw, response.data);
             }
             if (response.code == 0) {
-                if (response.raw.tellp()) {
+                if (has_json_body || response.buffer || response.file_descriptor >= 0 || response.raw.tellp()) {
                     response.code = 200;
                 } else {
                     response.code = 204;
@@ -66,17 +79,54 @@ namespace Network::Server::HTTP {
             }
         }
 
-        const int answer() {
+        // JSON bodies are compressed only when allowed and at least `gzip_min_size` bytes long
+
+        const int answer(const bool allow_gzip=false, const size_t gzip_min_size=0) {
             // build MHD response
             struct MHD_Response *mhd_response;
-            bool is_persistent = false;
-            // add response data to MHD response
-            const std::string& contents = response.raw.str();
-            mhd_response = MHD_create_response_from_buffer(
-                contents.size(),
-                (void*) contents.data(),
-                is_persistent ? MHD_RESPMEM_PERSISTENT : MHD_RESPMEM_MUST_COPY
-            );
+            // add response data to MHD response; shared buffers outlive the connection,
+            // which is only destroyed once the response has been sent
+            if (response.buffer) {
+                mhd_response = MHD_create_response_from_buffer(
+                    response.buffer->size(),
+                    (void*) response.buffer->data(),
+                    MHD_RESPMEM_PERSISTENT
+                );
+            } else if (response.file_descriptor >= 0) {
+                mhd_response = MHD_create_response_from_fd(response.file_size, response.file_descriptor);
+                // now owned by microhttpd
+                response.file_descriptor = -1;
+            } else if (has_json_body()) {
+                const auto it = request.headers.find("Accept-Encoding");
+                const bool use_gzip = allow_gzip && it != request.headers.end() && Headers::accepts_gzip(it->second);
+                if (allow_gzip) {
+                    response.headers["Vary"] = "Accept-Encoding";
+                }
+                // freed by microhttpd
+                BufferChain* chain = new BufferChain();
+                chain->write_json(response.data);
+                if (use_gzip && chain->size() >= gzip_min_size) {
+                    BufferChain* compressed_chain = new BufferChain();
+                    compressed_chain->write_gzip(*chain);
+                    delete chain;
+                    chain = compressed_chain;
+                    response.headers["Content-Encoding"] = "gzip";
+                }
+                mhd_response = MHD_create_response_from_callback(
+                    chain->size(),
+                    chain->get_chunk_size(),
+                    &BufferChain::read_callback,
+                    chain,
+                    &BufferChain::free_callback
+                );
+            } else {
+                const std::string& contents = response.raw.str();
+                mhd_response = MHD_create_response_from_buffer(
+                    contents.size(),
+                    (void*) contents.data(),
+                    MHD_RESPMEM_MUST_COPY
+                );
+            }
             // add headers
             for (const auto& header : response.headers) {
                 MHD_add_response_header(mhd_response, header.first.c_str(), header.second.c_str());
@@ -87,6 +137,9 @@ namespace Network::Server::HTTP {
             return ret;
         }
 
+        // holds the variants of the request & response while they are processed, so it
+        // is destroyed after them
+        Types::VariantArena arena;
         Request request;
         Response response;
 
@@ -5,6 +5,7 @@
 #include "./Processor.hpp"
 #include "./BaseResource.hpp"
 #include "./ParametrizedResource.hpp"
+#include "./Router.hpp"
 
 #include <vector>
 #include <typeinfo>
@@ -21,20 +22,18 @@ namespace Network::Server::HTTP {
             _parameter_type_hash(0) {}
 
         virtual const bool process(Connection& connection) {
-            for (auto& resource : _resources) {
-                if (resource->match(connection)) {
-                    resource->process(connection);
-                    return true;
-                }
+            const size_t index = _router.find(connection.request.url, connection.request.url_parameters);
+            if (index == Router<std::shared_ptr<BaseResource>>::npos) {
+                return false;
             }
-            return false;
+            _router[index]->process(connection);
+            return true;
         }
 
 
         void add_resource(BaseResource* resource) {
-            _resources.push_back(
-                std::shared_ptr<BaseResource>(resource)
-            );
+            std::shared_ptr<BaseResource> shared_resource(resource);
+            _router.add(shared_resource->get_url_pattern(), shared_resource);
         }
         // BaseResource
         template <typename Resource, std::enable_if_t<std::is_base_of<BaseResource, Resource>::value, int> = 0, std::enable_if_t<!std::is_same<typename Resource::ParameterType, void>::value, int> = 0>
@@ -66,7 +65,7 @@ namespace Network::Server::HTTP {
 
     private:
 
-        std::vector<std::shared_ptr<BaseResource>> _resources;
+        Router<std::shared_ptr<BaseResource>> _router;
         void* _parameter_pointer;
         size_t _parameter_type_hash;
 
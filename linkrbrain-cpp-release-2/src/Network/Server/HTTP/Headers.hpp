@@ -0,0 +1,71 @@
+#ifndef LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__HEADERS_HPP
+#define LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__HEADERS_HPP
+
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+
+namespace Network::Server::HTTP::Headers {
+
+
+    const std::string trim(const std::string& source) {
+        const size_t begin = source.find_first_not_of(" \t");
+        if (begin == std::string::npos) {
+            return "";
+        }
+        return source.substr(begin, source.find_last_not_of(" \t") + 1 - begin);
+    }
+
+    // `Accept-Encoding` values such as "gzip, deflate" or "br;q=1.0, gzip;q=0.8, *;q=0.1"
+
+    const bool accepts_gzip(const std::string& accept_encoding) {
+        double gzip_quality = -1.0;
+        double any_quality = -1.0;
+        std::istringstream stream(accept_encoding);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            const size_t semicolon = item.find(';');
+            const std::string coding = trim(item.substr(0, semicolon));
+            double quality = 1.0;
+            if (semicolon != std::string::npos) {
+                const size_t q = item.find("q=", semicolon);
+                if (q != std::string::npos) {
+                    quality = std::strtod(item.c_str() + q + 2, NULL);
+                }
+            }
+            if (coding == "gzip" || coding == "x-gzip") {
+                gzip_quality = quality;
+            } else if (coding == "*") {
+                any_quality = quality;
+            }
+        }
+        return (gzip_quality >= 0.0) ? (gzip_quality > 0.0) : (any_quality > 0.0);
+    }
+
+    // `If-None-Match` can list several tags, and uses weak comparison
+
+    const bool matches_etag(const std::string& if_none_match, const std::string& etag) {
+        if (trim(if_none_match) == "*") {
+            return true;
+        }
+        std::istringstream stream(if_none_match);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            item = trim(item);
+            if (item.compare(0, 2, "W/") == 0) {
+                item.erase(0, 2);
+            }
+            if (item == etag) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+} // Network::Server::HTTP::Headers
+
+
+#endif // LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__HEADERS_HPP
@@ -4,7 +4,7 @@
 
 #include "./Processor.hpp"
 
-#include <vector>
+#include <string>
 
 
 namespace Network::Server::HTTP {
@@ -16,7 +16,7 @@ namespace Network::Server::HTTP {
             Temporary = 302,
             Invisible = 0,
         };
-        std::regex pattern;
+        std::string pattern;
         std::string replacement;
         Type type;
         const bool is_last;
@@ -7,9 +7,12 @@
 #include <microhttpd.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <sstream>
 
+#include <unistd.h>
+
 
 namespace Network::Server::HTTP {
 
@@ -18,13 +21,14 @@ namespace Network::Server::HTTP {
     public:
 
         Response() :
-            code(0) {}
-
-        Response(const Response& source) {
-            code = source.code;
-            data = source.data;
-            raw << source.raw.str();
-            headers = source.headers;
+            code(0),
+            file_descriptor(-1),
+            file_size(0) {}
+
+        Response(const Response& source) :
+            file_descriptor(-1)
+        {
+            *this = source;
         }
 
         Response& operator= (const Response& source) {
@@ -32,13 +36,30 @@ namespace Network::Server::HTTP {
             data = source.data;
             raw << source.raw.str();
             headers = source.headers;
+            buffer = source.buffer;
+            if (file_descriptor >= 0) {
+                close(file_descriptor);
+            }
+            file_descriptor = (source.file_descriptor >= 0) ? dup(source.file_descriptor) : -1;
+            file_size = source.file_size;
             return *this;
         }
 
+        ~Response() {
+            if (file_descriptor >= 0) {
+                close(file_descriptor);
+            }
+        }
+
         uint16_t code;
         Types::Variant data;
         std::stringstream raw;
         std::unordered_map<std::string, std::string> headers;
+        // when set, sent instead of `raw` without being copied
+        std::shared_ptr<const std::string> buffer;
+        // when open, sent instead of `raw`; the descriptor is closed afterwards
+        int file_descriptor;
+        size_t file_size;
     };
 
 
@@ -0,0 +1,415 @@
+#ifndef LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__ROUTER_HPP
+#define LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__ROUTER_HPP
+
+
+#include <array>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace Network::Server::HTTP {
+
+
+    // URL patterns are regular expressions, matched against the whole URL; behaves like a
+    // linear scan over them, i.e. the first registered pattern that matches wins.
+    //
+    // Patterns made of '/'-separated segments are compiled into a trie, where each segment is
+    // either literal, `\d+`, `\w+` or `[\w\-]+` (captured or not, e.g. `(\d+)`), and the last one
+    // can also be `.+` or `.*` followed by a literal suffix (e.g. `(.+\.css)`), capturing the
+    // rest of the URL; patterns can end with `/?`. Other patterns are kept as regular expressions.
+
+    template <typename Target>
+    class Router {
+    public:
+
+        static constexpr size_t npos = -1;
+
+        // return the index of the added pattern
+
+        const size_t add(const std::string& pattern, const Target& target) {
+            const size_t index = _targets.size();
+            _targets.push_back(target);
+            if (!compile(pattern, index)) {
+                _regex_rules.push_back({index, std::regex(pattern)});
+            }
+            return index;
+        }
+
+        // return the index of the first matching pattern, starting from `first_index`, or `npos`;
+        // `parameters` then receives the whole URL, followed by the captured segments
+
+        const size_t find(const std::string& url, std::vector<std::string>& parameters, const size_t first_index=0) const {
+            Search search(url, first_index);
+            if (!url.empty() && url[0] == '/') {
+                search_node(_root, 1, 0, search);
+            }
+            // regular expressions registered before the trie match
+            for (const auto& [index, regex] : _regex_rules) {
+                if (index >= search.best_index) {
+                    break;
+                }
+                if (index < first_index) {
+                    continue;
+                }
+                std::smatch matches;
+                if (std::regex_match(url, matches, regex)) {
+                    parameters.resize(matches.size());
+                    for (size_t i=0; i<matches.size(); ++i) {
+                        parameters[i] = matches[i];
+                    }
+                    return index;
+                }
+            }
+            if (search.best_index != npos) {
+                parameters.resize(1 + search.best_captures_count);
+                parameters[0] = url;
+                for (size_t i=0; i<search.best_captures_count; ++i) {
+                    parameters[1 + i] = search.best_captures[i];
+                }
+            }
+            return search.best_index;
+        }
+
+        inline Target& operator[](const size_t index) {
+            return _targets[index];
+        }
+        inline const Target& operator[](const size_t index) const {
+            return _targets[index];
+        }
+        inline const size_t size() const {
+            return _targets.size();
+        }
+        inline const size_t get_compiled_count() const {
+            return _targets.size() - _regex_rules.size();
+        }
+
+        // substitute `$1`...`$99`, `$&` and `$$` in a replacement, like `std::regex_replace`
+
+        static const std::string format(const std::string& replacement, const std::vector<std::string>& parameters) {
+            std::string result;
+            result.reserve(replacement.size());
+            for (size_t i=0; i<replacement.size(); ++i) {
+                const char c = replacement[i];
+                if (c != '$' || i + 1 == replacement.size()) {
+                    result += c;
+                } else if (replacement[i + 1] == '$') {
+                    result += '$';
+                    ++i;
+                } else if (replacement[i + 1] == '&') {
+                    result += parameters.empty() ? "" : parameters[0];
+                    ++i;
+                } else if (std::isdigit(replacement[i + 1])) {
+                    size_t n = replacement[++i] - '0';
+                    if (i + 1 < replacement.size() && std::isdigit(replacement[i + 1])) {
+                        n = 10 * n + (replacement[++i] - '0');
+                    }
+                    if (n < parameters.size()) {
+                        result += parameters[n];
+                    }
+                } else {
+                    result += c;
+                }
+            }
+            return result;
+        }
+
+    private:
+
+        static constexpr size_t max_captures_count = 16;
+
+        enum SegmentType {
+            Digits,
+            Word,
+            Slug,
+        };
+
+        struct Node;
+
+        struct ParameterEdge {
+            SegmentType type;
+            bool is_captured;
+            std::unique_ptr<Node> node;
+        };
+
+        // matches the rest of the URL, slashes included
+
+        struct RestEdge {
+            std::string suffix;
+            bool is_captured;
+            bool allows_empty;
+            size_t index;
+        };
+
+        struct Node {
+            std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+            std::vector<ParameterEdge> parameters;
+            std::vector<RestEdge> rests;
+            // patterns ending here, without or with a trailing slash, in registration order
+            std::vector<size_t> indexes;
+            std::vector<size_t> slash_indexes;
+        };
+
+        struct RegexRule {
+            size_t index;
+            std::regex regex;
+        };
+
+        struct Search {
+            Search(const std::string& _url, const size_t _first_index) :
+                url(_url),
+                first_index(_first_index),
+                best_index(npos),
+                best_captures_count(0) {}
+            const std::string_view url;
+            const size_t first_index;
+            size_t best_index;
+            std::array<std::string_view, max_captures_count> captures;
+            std::array<std::string_view, max_captures_count> best_captures;
+            size_t best_captures_count;
+        };
+
+        // pattern compilation
+
+        static const bool unescape(const std::string_view source, std::string& destination) {
+            destination.clear();
+            for (size_t i=0; i<source.size(); ++i) {
+                const char c = source[i];
+                if (c == '\\') {
+                    if (++i == source.size() || std::isalnum(source[i])) {
+                        return false;
+                    }
+                    destination += source[i];
+                } else if (std::string_view(".[](){}*+?^$|").find(c) != std::string_view::npos) {
+                    return false;
+                } else {
+                    destination += c;
+                }
+            }
+            return true;
+        }
+
+        static const bool parse_parameter(std::string_view segment, SegmentType& type, bool& is_captured) {
+            is_captured = (segment.size() > 2 && segment.front() == '(' && segment.back() == ')');
+            if (is_captured) {
+                segment = segment.substr(1, segment.size() - 2);
+            }
+            if (segment == "\\d+") {
+                type = Digits;
+            } else if (segment == "\\w+") {
+                type = Word;
+            } else if (segment == "[\\w\\-]+" || segment == "[\\w-]+") {
+                type = Slug;
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        static const bool parse_rest(std::string_view segment, RestEdge& rest) {
+            rest.is_captured = (segment.size() > 2 && segment.front() == '(' && segment.back() == ')');
+            if (rest.is_captured) {
+                segment = segment.substr(1, segment.size() - 2);
+            }
+            if (segment.size() < 2 || segment[0] != '.' || (segment[1] != '+' && segment[1] != '*')) {
+                return false;
+            }
+            rest.allows_empty = (segment[1] == '*');
+            return unescape(segment.substr(2), rest.suffix);
+        }
+
+        const bool compile(const std::string& pattern, const size_t index) {
+            std::string_view source = pattern;
+            if (!source.empty() && source.front() == '^') {
+                source.remove_prefix(1);
+            }
+            if (!source.empty() && source.back() == '$' && (source.size() < 2 || source[source.size() - 2] != '\\')) {
+                source.remove_suffix(1);
+            }
+            if (source.empty() || source.front() != '/') {
+                return false;
+            }
+            source.remove_prefix(1);
+            bool has_optional_slash = false;
+            if (source.size() >= 2 && source.substr(source.size() - 2) == "/?") {
+                has_optional_slash = true;
+                source.remove_suffix(2);
+            }
+            // parse every segment before altering the trie
+            struct Segment {
+                bool is_literal;
+                std::string literal;
+                SegmentType type;
+                bool is_captured;
+            };
+            std::vector<Segment> segments;
+            RestEdge rest = {"", false, false, npos};
+            size_t captures_count = 0;
+            while (true) {
+                const size_t slash = source.find('/');
+                const std::string_view segment_source = source.substr(0, slash);
+                Segment segment;
+                if (parse_parameter(segment_source, segment.type, segment.is_captured)) {
+                    segment.is_literal = false;
+                    captures_count += segment.is_captured;
+                } else if (unescape(segment_source, segment.literal)) {
+                    segment.is_literal = true;
+                } else if (slash == std::string_view::npos && !has_optional_slash && parse_rest(segment_source, rest)) {
+                    rest.index = index;
+                    captures_count += rest.is_captured;
+                    break;
+                } else {
+                    return false;
+                }
+                segments.push_back(std::move(segment));
+                if (slash == std::string_view::npos) {
+                    break;
+                }
+                source.remove_prefix(slash + 1);
+            }
+            if (captures_count > max_captures_count) {
+                return false;
+            }
+            // insert into the trie
+            Node* node = &_root;
+            for (Segment& segment : segments) {
+                if (segment.is_literal) {
+                    auto it = node->children.find(segment.literal);
+                    if (it == node->children.end()) {
+                        it = node->children.insert({segment.literal, std::make_unique<Node>()}).first;
+                    }
+                    node = it->second.get();
+                } else {
+                    ParameterEdge* edge = NULL;
+                    for (ParameterEdge& parameter : node->parameters) {
+                        if (parameter.type == segment.type && parameter.is_captured == segment.is_captured) {
+                            edge = &parameter;
+                        }
+                    }
+                    if (edge == NULL) {
+                        node->parameters.push_back({segment.type, segment.is_captured, std::make_unique<Node>()});
+                        edge = &node->parameters.back();
+                    }
+                    node = edge->node.get();
+                }
+            }
+            if (rest.index != npos) {
+                node->rests.push_back(std::move(rest));
+            } else {
+                node->indexes.push_back(index);
+                if (has_optional_slash) {
+                    node->slash_indexes.push_back(index);
+                }
+            }
+            return true;
+        }
+
+        // matching
+
+        static const bool is_word_character(const char c) {
+            return std::isalnum((unsigned char) c) || c == '_';
+        }
+        static const bool matches(const SegmentType type, const std::string_view segment) {
+            if (segment.empty()) {
+                return false;
+            }
+            for (const char c : segment) {
+                switch (type) {
+                    case Digits:
+                        if (c < '0' || c > '9') {
+                            return false;
+                        }
+                        break;
+                    case Word:
+                        if (!is_word_character(c)) {
+                            return false;
+                        }
+                        break;
+                    case Slug:
+                        if (!is_word_character(c) && c != '-') {
+                            return false;
+                        }
+                        break;
+                }
+            }
+            return true;
+        }
+
+        static void propose(const std::vector<size_t>& indexes, const size_t captures_count, Search& search) {
+            for (const size_t index : indexes) {
+                if (index >= search.best_index) {
+                    return;
+                }
+                if (index >= search.first_index) {
+                    search.best_index = index;
+                    search.best_captures = search.captures;
+                    search.best_captures_count = captures_count;
+                    return;
+                }
+            }
+        }
+
+        // `begin` is the position following a slash in the URL
+
+        void search_node(const Node& node, const size_t begin, const size_t captures_count, Search& search) const {
+            const std::string_view remaining = search.url.substr(begin);
+            for (const RestEdge& rest : node.rests) {
+                if (rest.index < search.first_index || rest.index >= search.best_index) {
+                    continue;
+                }
+                if (remaining.size() < rest.suffix.size() + (rest.allows_empty ? 0 : 1)) {
+                    continue;
+                }
+                if (remaining.substr(remaining.size() - rest.suffix.size()) != rest.suffix) {
+                    continue;
+                }
+                search.best_index = rest.index;
+                search.best_captures = search.captures;
+                search.best_captures_count = captures_count;
+                if (rest.is_captured) {
+                    search.best_captures[search.best_captures_count++] = remaining;
+                }
+            }
+            const size_t slash = remaining.find('/');
+            const std::string_view segment = remaining.substr(0, slash);
+            const size_t next = (slash == std::string_view::npos) ? npos : begin + slash + 1;
+            const auto it = node.children.find(segment);
+            if (it != node.children.end()) {
+                search_child(*it->second, next, captures_count, search);
+            }
+            for (const ParameterEdge& parameter : node.parameters) {
+                if (matches(parameter.type, segment)) {
+                    if (parameter.is_captured) {
+                        search.captures[captures_count] = segment;
+                    }
+                    search_child(*parameter.node, next, captures_count + parameter.is_captured, search);
+                }
+            }
+        }
+
+        void search_child(const Node& child, const size_t next, const size_t captures_count, Search& search) const {
+            if (next == npos) {
+                propose(child.indexes, captures_count, search);
+                return;
+            }
+            if (next == search.url.size()) {
+                propose(child.slash_indexes, captures_count, search);
+            }
+            search_node(child, next, captures_count, search);
+        }
+
+        Node _root;
+        std::vector<RegexRule> _regex_rules;
+        std::vector<Target> _targets;
+
+    };
+
+
+} // Network::Server::HTTP
+
+
+#endif // LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__ROUTER_HPP
@@ -4,8 +4,7 @@
 
 #include "./Processor.hpp"
 #include "./Redirection.hpp"
-
-#include <vector>
+#include "./Router.hpp"
 
 
 namespace Network::Server::HTTP {
@@ -20,32 +19,28 @@ namespace Network::Server::HTTP {
             Redirection::Type type,
             const bool is_last)
         {
-            _redirections.push_back({
-                .pattern = std::regex(pattern),
+            _router.add(pattern, {
+                .pattern = pattern,
                 .replacement = replacement,
                 .type = type,
                 .is_last = is_last
             });
         }
 
+        // redirections are applied in the order they were added, then again from the
+        // first one as long as the URL is changed
+
         virtual const bool process(Connection& connection) {
-            if (_redirections.size() == 0) {
+            if (_router.size() == 0) {
                 return false;
             }
             std::string url = connection.request.url;
-            std::string old_url;
+            std::vector<std::string> parameters;
             while (true) {
                 bool nochange = true;
-                old_url = url;
-                for (const Redirection& redirection : _redirections) {
-                    if (!std::regex_match(url, redirection.pattern)) {
-                        continue;
-                    }
-                    url = std::regex_replace(
-                        url,
-                        redirection.pattern,
-                        redirection.replacement
-                    );
+                for (size_t index = _router.find(url, parameters); index != Router<Redirection>::npos; index = _router.find(url, parameters, index + 1)) {
+                    const Redirection& redirection = _router[index];
+                    url = Router<Redirection>::format(redirection.replacement, parameters);
                     switch (redirection.type) {
                         case Redirection::Permanent:
                         case Redirection::Temporary:
@@ -68,7 +63,7 @@ namespace Network::Server::HTTP {
 
     private:
 
-        std::vector<Redirection> _redirections;
+        Router<Redirection> _router;
     };
 
 
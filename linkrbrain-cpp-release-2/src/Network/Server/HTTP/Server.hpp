@@ -5,6 +5,7 @@
 #include <arpa/inet.h>
 #include <microhttpd.h>
 
+#include <cstdlib>
 #include <exception>
 #include <vector>
 #include <map>
@@ -15,6 +16,7 @@
 #include "./Connection.hpp"
 
 #include "Exceptions/Exception.hpp"
+#include "Exceptions/GenericExceptions.hpp"
 #include "Logging/Loggable.hpp"
 
 
@@ -34,6 +36,10 @@ namespace Network::Server::HTTP {
             _routing(true),
             _static_processing(true),
             _dynamic_processing(true),
+            _gzip_responses(false),
+            _gzip_min_size(4 << 10),
+            _max_upload_size(64 << 20),
+            _max_json_depth(64),
             _persistent(false) {}
         ~Server() {
             stop();
@@ -51,6 +57,10 @@ namespace Network::Server::HTTP {
             CREATE_GETTER_SETTER(bool, routing)
             CREATE_GETTER_SETTER(bool, static_processing)
             CREATE_GETTER_SETTER(bool, dynamic_processing)
+            CREATE_GETTER_SETTER(bool, gzip_responses)
+            CREATE_GETTER_SETTER(size_t, gzip_min_size)
+            CREATE_GETTER_SETTER(size_t, max_upload_size)
+            CREATE_GETTER_SETTER(size_t, max_json_depth)
         #endif // CREATE_GETTER_SETTER
         void set_server_caching(const bool server_caching) {
             _static_processor.set_server_caching(server_caching);
@@ -63,6 +73,8 @@ namespace Network::Server::HTTP {
             // daemon options
             _daemon_options.clear();
             _daemon_options.push_back({MHD_OPTION_CONNECTION_TIMEOUT, _timeout, NULL});
+            _daemon_options.push_back({MHD_OPTION_NOTIFY_COMPLETED, (intptr_t) &completed_callback, this});
+            // requests are processed by a pool of threads, each one with its own event loop
             if (_threading > 1) {
                 _daemon_options.push_back({MHD_OPTION_THREAD_POOL_SIZE, _threading, NULL});
             }
@@ -143,6 +155,10 @@ namespace Network::Server::HTTP {
             }
             return MHD_YES;
         }
+        static void completed_callback(void* _server, struct MHD_Connection* mhd_connection, void** con_cls, enum MHD_RequestTerminationCode termination_code) {
+            delete static_cast<Connection*>(*con_cls);
+            *con_cls = NULL;
+        }
         static int connection_callback(
             void *_server,
             struct MHD_Connection* mhd_connection,
@@ -173,6 +189,15 @@ namespace Network::Server::HTTP {
                 // extract upload data for POST, PUT, PATCH requests
                 step = 0x00;
                 if (method[0] == 'P') {
+                    // refuse bodies that are announced as too large before receiving them
+                    if (new_connection) {
+                        const auto content_length = connection.request.headers.find("Content-Length");
+                        if (content_length != connection.request.headers.end() && std::strtoull(content_length->second.c_str(), NULL, 10) > server._max_upload_size) {
+                            throw Exceptions::PayloadTooLargeException("Request body is too large", {
+                                {"max_upload_size", (int64_t) server._max_upload_size}
+                            });
+                        }
+                    }
                     // files form
                     if (connection.request.method == "POST" && connection.request.headers["Content-Type"].find("multipart/form-data") == 0) {
                         if (new_connection) {
@@ -194,6 +219,11 @@ namespace Network::Server::HTTP {
                         connection.request.is_uploading = true;
                         return MHD_YES;
                     } else if (*upload_size) {
+                        if ((size_t) connection.request.raw.tellp() + *upload_size > server._max_upload_size) {
+                            throw Exceptions::PayloadTooLargeException("Request body is too large", {
+                                {"max_upload_size", (int64_t) server._max_upload_size}
+                            });
+                        }
                         connection.request.raw.write(upload_data, *upload_size);
                         *upload_size = 0;
                         return MHD_YES;
@@ -216,7 +246,8 @@ namespace Network::Server::HTTP {
                         message += "unknown";
                         break;
                 }
-                connection.response.code = 400;
+                const Exceptions::GenericException* generic_error = dynamic_cast<const Exceptions::GenericException*>(&error);
+                connection.response.code = generic_error ? generic_error->get_http_code() : 400;
                 connection.response.data = {
                     {"message", message},
                     {"details", error.what()}
@@ -244,10 +275,12 @@ namespace Network::Server::HTTP {
                     error.what()
                 );
             }
+            // from here on, request parsing, processing & serialization share one arena
+            Types::VariantArena::Scope arena_scope(connection.arena);
             // try to parse & apply processors
             if (!has_failed) {
                 try {
-                    connection.parse_request();
+                    connection.parse_request(server._max_json_depth);
                     if (!(server._routing && server._routing_processor.process(connection))) {
                         if (!(server._static_processing && server._static_processor.process(connection))) {
                             if (!(server._dynamic_processing && server._dynamic_processor.process(connection))) {
@@ -282,9 +315,12 @@ namespace Network::Server::HTTP {
                 connection.request.url, " ",
                 connection.response.code
             );
-            server.get_logger().detail(connection.request.raw.str());
-            server.get_logger().detail(Conversion::JSON::serialize(connection.response.data));
-            return connection.answer();
+            // avoid serializing large responses twice when details are not logged
+            if (server.get_logger().get_level() <= Logging::Detail) {
+                server.get_logger().detail(connection.request.raw.str());
+                server.get_logger().detail(Conversion::JSON::serialize(connection.response.data));
+            }
+            return connection.answer(server._gzip_responses, server._gzip_min_size);
         }
 
     protected:
@@ -306,6 +342,10 @@ namespace Network::Server::HTTP {
         bool _routing;
         bool _static_processing;
         bool _dynamic_processing;
+        bool _gzip_responses;
+        size_t _gzip_min_size;
+        size_t _max_upload_size;
+        size_t _max_json_depth;
         StaticProcessor _static_processor;
         DynamicProcessor _dynamic_processor;
         RoutingProcessor _routing_processor;
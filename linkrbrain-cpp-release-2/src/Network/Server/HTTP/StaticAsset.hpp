@@ -0,0 +1,124 @@
+#ifndef LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__STATICASSET_HPP
+#define LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__STATICASSET_HPP
+
+
+#include "Compression/Zlib/OStream.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+
+namespace Network::Server::HTTP {
+
+
+    // snapshot of a static file, with its compressed variant; it is shared between the cache
+    // and the responses being sent, which point directly to its buffers; only the file status
+    // is read on load, contents are read and compressed by the first responses needing them
+
+    struct StaticAsset {
+    public:
+
+        std::filesystem::path path;
+        std::filesystem::file_time_type last_write_time;
+        uintmax_t size;
+        std::string content_type;
+        std::string etag;
+        std::string gzip_etag;
+        // contents are not kept in memory when the file is too large
+        bool is_buffered;
+        int gzip_level;
+
+        // compare with the file on disk; a file that disappeared is also considered modified
+
+        const bool is_modified() const {
+            std::error_code error;
+            const auto current_last_write_time = std::filesystem::last_write_time(path, error);
+            if (error) {
+                return true;
+            }
+            const uintmax_t current_size = std::filesystem::file_size(path, error);
+            return error || current_last_write_time != last_write_time || current_size != size;
+        }
+
+        // null when the file is not buffered, or could not be read
+
+        const std::string* get_identity() const {
+            std::call_once(_identity_flag, [this] {
+                if (!is_buffered) {
+                    return;
+                }
+                std::ifstream file(path, std::ios::binary);
+                if (!file.good()) {
+                    return;
+                }
+                _identity.resize(size);
+                file.read(_identity.data(), size);
+                _identity.resize(file.gcount());
+                _is_read = true;
+            });
+            return _is_read ? &_identity : nullptr;
+        }
+
+        // null when compression does not make the file smaller
+
+        const std::string* get_gzip() const {
+            std::call_once(_gzip_flag, [this] {
+                const std::string* identity = get_identity();
+                if (!identity) {
+                    return;
+                }
+                std::stringstream compressed_stream;
+                {
+                    Compression::Zlib::OStream compressed(compressed_stream, Compression::Zlib::OStreamBuf::default_buff_size, gzip_level);
+                    compressed.write(identity->data(), identity->size());
+                }
+                if (compressed_stream.tellp() < (std::streamoff) identity->size()) {
+                    _gzip = compressed_stream.str();
+                }
+            });
+            return _gzip.empty() ? nullptr : &_gzip;
+        }
+
+        static std::shared_ptr<const StaticAsset> load(const std::filesystem::path& path, const std::string& content_type, const uintmax_t max_buffered_size, const int gzip_level=Z_BEST_COMPRESSION) {
+            std::shared_ptr<StaticAsset> asset = std::make_shared<StaticAsset>();
+            asset->path = path;
+            asset->content_type = content_type;
+            asset->gzip_level = gzip_level;
+            std::error_code error;
+            asset->last_write_time = std::filesystem::last_write_time(path, error);
+            if (error) {
+                return nullptr;
+            }
+            asset->size = std::filesystem::file_size(path, error);
+            if (error) {
+                return nullptr;
+            }
+            // ETag depends on modification time & size
+            std::stringstream etag_stream;
+            etag_stream << std::hex << asset->last_write_time.time_since_epoch().count() << '-' << asset->size;
+            asset->etag = '"' + etag_stream.str() + '"';
+            asset->gzip_etag = '"' + etag_stream.str() + "-gz\"";
+            // large files will be sent from their descriptor
+            asset->is_buffered = (asset->size <= max_buffered_size);
+            return asset;
+        }
+
+    private:
+
+        mutable std::once_flag _identity_flag;
+        mutable bool _is_read = false;
+        mutable std::string _identity;
+        mutable std::once_flag _gzip_flag;
+        mutable std::string _gzip;
+
+    };
+
+
+} // Network::Server::HTTP
+
+
+#endif // LINKRBRAIN2019__SRC__NETWORK__SERVER__HTTP__STATICASSET_HPP
@@ -3,172 +3,196 @@
 
 
 #include "./Processor.hpp"
-
-#include "Compression/Zlib/OStream.hpp"
+#include "./Headers.hpp"
+#include "./StaticAsset.hpp"
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
-#include <fstream>
 #include <filesystem>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 
 namespace Network::Server::HTTP {
 
 
+    // with server caching, files are read on their first request and compressed on the first
+    // one accepting gzip, then kept in memory until they are modified on disk; without it,
+    // they are only read, or compressed, by the responses needing it; large files are never
+    // kept, and sent straight from their descriptor
+
     struct StaticProcessor : public Processor {
     public:
 
         StaticProcessor() :
             _client_caching(true),
             _server_caching(true),
-            _gzip(true) {}
+            _gzip(true),
+            _max_buffered_size(8 << 20) {}
 
         void add_path(const std::string& path) {
             _folders.push_back(path);
         }
 
-        const std::string compute_etag(const Connection& connection) const {
-            for (const auto& folder : _folders) {
-                if (_client_caching) {
-                    std::string fullpath = folder + '/' + connection.request.url;
-                    const uint64_t last_write_time =
-                        std::filesystem::last_write_time(fullpath).time_since_epoch().count();
-                    std::stringstream etag_stream;
-                    etag_stream << std::hex << last_write_time;
-                    return "\"" + etag_stream.str() + "\"";
+        virtual const bool process(Connection& connection) {
+            const std::shared_ptr<const StaticAsset> asset = get_asset(connection.request.url);
+            if (!asset) {
+                return false;
+            }
+            Response& response = connection.response;
+            response.headers["Content-Type"] = asset->content_type;
+            // content negotiation; files that do not get smaller are sent as is, but with the
+            // gzip ETag, so that it is known before compressing them
+            bool use_gzip = false;
+            if (_gzip && asset->is_buffered) {
+                response.headers["Vary"] = "Accept-Encoding";
+                const auto it = connection.request.headers.find("Accept-Encoding");
+                use_gzip = (it != connection.request.headers.end() && Headers::accepts_gzip(it->second));
+            }
+            // client caching
+            if (_client_caching) {
+                const std::string& etag = use_gzip ? asset->gzip_etag : asset->etag;
+                response.headers["ETag"] = etag;
+                const auto it = connection.request.headers.find("If-None-Match");
+                if (it != connection.request.headers.end() && Headers::matches_etag(it->second, etag)) {
+                    response.code = 304;
+                    return true;
+                }
+            }
+            // buffers are shared with the asset, so they stay valid while the response is sent
+            const std::string* gzip = use_gzip ? asset->get_gzip() : nullptr;
+            if (gzip) {
+                response.headers["Content-Encoding"] = "gzip";
+                response.buffer = std::shared_ptr<const std::string>(asset, gzip);
+            } else if (asset->is_buffered) {
+                const std::string* identity = asset->get_identity();
+                if (!identity) {
+                    return false;
+                }
+                response.buffer = std::shared_ptr<const std::string>(asset, identity);
+            } else {
+                response.file_descriptor = open(asset->path.c_str(), O_RDONLY);
+                struct stat file_stat;
+                if (response.file_descriptor < 0) {
+                    return false;
+                }
+                if (fstat(response.file_descriptor, &file_stat) != 0) {
+                    close(response.file_descriptor);
+                    response.file_descriptor = -1;
+                    return false;
+                }
+                response.file_size = file_stat.st_size;
+            }
+            response.code = 200;
+            return true;
+        }
+
+        void reset_cache() {
+            std::unique_lock<std::shared_mutex> lock(_cache_mutex);
+            _cache.clear();
+        }
+
+        void set_server_caching(const bool server_caching) {
+            _server_caching = server_caching;
+        }
+        void set_client_caching(const bool client_caching) {
+            _client_caching = client_caching;
+        }
+        void set_gzip(const bool gzip) {
+            _gzip = gzip;
+            reset_cache();
+        }
+        void set_max_buffered_size(const uintmax_t max_buffered_size) {
+            _max_buffered_size = max_buffered_size;
+            reset_cache();
+        }
+
+    private:
+
+        const std::shared_ptr<const StaticAsset> get_asset(const std::string& url) {
+            // cached asset, if still up to date
+            if (_server_caching) {
+                std::shared_lock<std::shared_mutex> lock(_cache_mutex);
+                const auto it = _cache.find(url);
+                if (it != _cache.end() && !it->second->is_modified()) {
+                    return it->second;
                 }
             }
-            return "";
+            // otherwise, load it again
+            const std::shared_ptr<const StaticAsset> asset = load_asset(url);
+            if (_server_caching) {
+                std::unique_lock<std::shared_mutex> lock(_cache_mutex);
+                if (asset) {
+                    _cache.insert_or_assign(url, asset);
+                } else {
+                    _cache.erase(url);
+                }
+            }
+            return asset;
         }
 
-        const bool process_nocache(Connection& connection) {
+        const std::shared_ptr<const StaticAsset> load_asset(const std::string& url) const {
+            // do not serve anything outside of the folders
+            if (url.find("..") != std::string::npos) {
+                return nullptr;
+            }
             for (const auto& folder : _folders) {
-                // open file
-                std::string fullpath = folder + '/' + connection.request.url;
+                std::string fullpath = folder + '/' + url;
                 if (std::filesystem::is_directory(fullpath)) {
                     if (*fullpath.rbegin() != '/') {
                         fullpath += "/";
                     }
                     fullpath += "index.html";
                 }
-                std::ifstream file(fullpath);
-                // is it a good file?
-                if (!file.good()) {
+                if (!std::filesystem::is_regular_file(fullpath)) {
                     continue;
                 }
-                // compute ETAG
-                if (_client_caching) {
-                    const uint64_t last_write_time =
-                        std::filesystem::last_write_time(fullpath).time_since_epoch().count();
-                    std::stringstream etag_stream;
-                    etag_stream << std::hex << last_write_time;
-                    std::string etag = "\"" + etag_stream.str() + "\"";
-                    connection.response.headers["ETag"] = etag;
-                }
                 // find content type
+                std::string content_type = "application/octet-stream";
                 const std::size_t last_dot = fullpath.rfind('.');
                 if (last_dot != std::string::npos) {
-                    const std::string ending = fullpath.substr(last_dot + 1);
-                    auto it = _content_types.find(ending);
+                    const auto it = _content_types.find(fullpath.substr(last_dot + 1));
                     if (it != _content_types.end()) {
-                        connection.response.headers["Content-Type"] = it->second;
+                        content_type = it->second;
                     }
                 }
-                // find size
-                file.seekg(0, std::ios::end);
-                std::size_t length = file.tellg();
-                file.seekg(0, std::ios::beg);
-                // read file
-                if (_gzip && connection.request.headers["Accept-Encoding"].find("gzip") != std::string::npos) {
-                    connection.response.headers["Content-Encoding"] = "gzip";
-                    Compression::Zlib::OStream compressed(connection.response.raw);
-                    std::copy(
-                        std::istreambuf_iterator<char>(file),
-                        std::istreambuf_iterator<char>(),
-                        std::ostreambuf_iterator<char>(compressed));
-                } else {
-                    std::copy(
-                        std::istreambuf_iterator<char>(file),
-                        std::istreambuf_iterator<char>(),
-                        std::ostreambuf_iterator<char>(connection.response.raw));
+                // compressed once for all requests when cached, or for each of them otherwise
+                const std::shared_ptr<const StaticAsset> asset = StaticAsset::load(fullpath, content_type, _max_buffered_size, _server_caching ? Z_BEST_COMPRESSION : Z_BEST_SPEED);
+                if (asset) {
+                    return asset;
                 }
-                // that was it!
-                return true;
             }
-            return false;
+            return nullptr;
         }
-        virtual const bool process(Connection& connection) {
-            // with server cache
-            if (_server_caching) {
-                // retrieve cache element
-                const auto cache_it = _cache.find(connection.request.url);
-                if (cache_it != _cache.end()) {
-                    // find out if client caching can be applied
-                    if (_client_caching) {
-                        const auto headers_it = connection.request.headers.find("If-None-Match");
-                        if (headers_it != connection.request.headers.end()) {
-                            if (headers_it->second == cache_it->second.headers["ETag"]) {
-                                connection.response.code = 304;
-                                return true;
-                            }
-                        }
-                    }
-                    // otherwise, send full response
-                    connection.response = cache_it->second;
-                    return true;
-                }
-                // if nothing is present in server cache, generate it
-                if (process_nocache(connection)) {
-                    _cache.insert({connection.request.url, connection.response});
-                    return true;
-                }
-                return false;
-            }
-            // without server cache
-            if (_client_caching) {
-                const auto it = connection.request.headers.find("If-None-Match");
-                if (it != connection.request.headers.end()) {
-                    if (compute_etag(connection) == it->second) {
-                        connection.response.code = 304;
-                        return true;
-                    }
-                }
-            }
-            return process_nocache(connection);
-        }
-
-        void reset_cache() {
-            _cache.clear();
-            _gzip_cache.clear();
-        }
-
-        void set_server_caching(const bool server_caching) {
-            _server_caching = server_caching;
-        }
-        void set_client_caching(const bool client_caching) {
-            _client_caching = client_caching;
-        }
-
-    private:
 
         std::vector<std::string> _folders;
         bool _server_caching;
         bool _client_caching;
         bool _gzip;
-        std::map<std::string, Response> _cache;
-        std::map<std::string, Response> _gzip_cache;
+        uintmax_t _max_buffered_size;
+        std::unordered_map<std::string, std::shared_ptr<const StaticAsset>> _cache;
+        std::shared_mutex _cache_mutex;
         static std::map<std::string, std::string> _content_types;
     };
 
     std::map<std::string, std::string> StaticProcessor::_content_types = {
+        {"css", "text/css"},
         {"gif", "image/gif"},
         {"htm", "text/html"},
         {"html", "text/html"},
+        {"ico", "image/x-icon"},
         {"jpg", "image/jpeg"},
         {"jpeg", "image/jpeg"},
         {"js", "text/javascript"},
         {"json", "application/json"},
         {"png", "image/png"},
+        {"svg", "image/svg+xml"},
         {"txt", "text/plain"},
         {"xml", "text/xml"},
         {"obj", "application/object"},
@@ -29,7 +29,7 @@ namespace Paged {
         size_t _cache_size;
         std::atomic<bool> _is_cleaning_cache;
         size_t _cache_cleaning_count;
-        std::thread* _cache_cleaning_thread;
+        std::thread _cache_cleaning_thread;
 
         std::unordered_map<std::string, File<Header, char>*> _files_by_name;
         std::unordered_map<int, File<Header, char>*> _files_by_handle;
@@ -42,14 +42,14 @@ namespace Paged {
         , _cache_size(0)
         , _is_cleaning_cache(false)
         , _cache_cleaning_count(0) {
-            // start the cleaning thread
-            _cache_cleaning_thread = new std::thread(clean_cache_daemon, this);
-            _cache_cleaning_thread->detach();
+            // start the cleaning thread; it is joined on destruction, so it
+            // never outlives the manager
+            _cache_cleaning_thread = std::thread(clean_cache_daemon, this);
         }
         inline ~Manager() {
             _is_open = false;
-            if (_cache_cleaning_thread->joinable()) {
-                _cache_cleaning_thread->join();
+            if (_cache_cleaning_thread.joinable()) {
+                _cache_cleaning_thread.join();
             }
             get_logger().debug("Destruction: terminating filesystem manager cache cleaning daemon (called", _cache_cleaning_count, "times)");
             // terminate cache
@@ -125,9 +125,12 @@ namespace Paged {
             while (manager._is_open) {
                 // check every millisecond
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                while (manager._cache_size < manager._max_cache_size || manager._is_cleaning_cache) {
+                while (manager._is_open && (manager._cache_size < manager._max_cache_size || manager._is_cleaning_cache)) {
                     std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 }
+                if (!manager._is_open) {
+                    break;
+                }
                 // clean if conditions are met
                 clean_cache(manager, 0.25);
             }
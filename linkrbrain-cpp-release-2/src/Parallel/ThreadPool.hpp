@@ -0,0 +1,182 @@
+#ifndef LINKRBRAIN2019__SRC__PARALLEL__THREADPOOL_HPP
+#define LINKRBRAIN2019__SRC__PARALLEL__THREADPOOL_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Parallel {
+
+
+    // fixed number of workers, each one with its own queue of tasks;
+    // an idle worker steals tasks from the front of the other queues
+
+    class ThreadPool {
+    public:
+
+        typedef std::function<void()> Task;
+
+        ThreadPool(const size_t n_threads=std::thread::hardware_concurrency()) :
+            _queues(n_threads ? n_threads : 1),
+            _next_queue(0),
+            _pending(0),
+            _is_running(true)
+        {
+            for (size_t i=0; i<_queues.size(); ++i) {
+                _queues[i] = std::make_unique<Queue>();
+            }
+            for (size_t i=0; i<_queues.size(); ++i) {
+                _workers.emplace_back(&ThreadPool::work, this, i);
+            }
+        }
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _is_running = false;
+            }
+            _tasks_condition.notify_all();
+            for (std::thread& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        inline const size_t get_size() const {
+            return _workers.size();
+        }
+
+        // tasks are distributed among workers in a round-robin fashion
+
+        void submit(Task task) {
+            Queue& queue = *_queues[_next_queue++ % _queues.size()];
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                std::lock_guard<std::mutex> queue_lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+                ++_pending;
+            }
+            _tasks_condition.notify_one();
+        }
+
+        // block until every submitted task is done; the first exception thrown by a task is rethrown here
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _done_condition.wait(lock, [this] { return _pending == 0; });
+            if (_exception) {
+                std::exception_ptr exception = _exception;
+                _exception = nullptr;
+                std::rethrow_exception(exception);
+            }
+        }
+
+        // call function(begin, end) on chunks of [0, size), then wait for all of them
+
+        template <typename Function>
+        void parallel_for(const size_t size, const size_t chunk_size, Function&& function) {
+            const size_t step = chunk_size ? chunk_size : 1;
+            for (size_t begin=0; begin<size; begin+=step) {
+                const size_t end = std::min(begin + step, size);
+                submit([&function, begin, end] {
+                    function(begin, end);
+                });
+            }
+            wait();
+        }
+
+    private:
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        // own tasks are taken from the back, stolen ones from the front
+
+        inline bool pop(const size_t index, Task& task) {
+            Queue& own_queue = *_queues[index];
+            {
+                std::lock_guard<std::mutex> lock(own_queue.mutex);
+                if (!own_queue.tasks.empty()) {
+                    task = std::move(own_queue.tasks.back());
+                    own_queue.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (size_t i=1; i<_queues.size(); ++i) {
+                Queue& queue = *_queues[(index + i) % _queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void work(const size_t index) {
+            Task task;
+            while (true) {
+                if (pop(index, task)) {
+                    try {
+                        task();
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (!_exception) {
+                            _exception = std::current_exception();
+                        }
+                    }
+                    task = nullptr;
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (--_pending == 0) {
+                        _done_condition.notify_all();
+                    }
+                    continue;
+                }
+                // nothing to do: sleep until a task is submitted, or the pool is destroyed
+                std::unique_lock<std::mutex> lock(_mutex);
+                _tasks_condition.wait(lock, [this] { return !_is_running || has_tasks(); });
+                if (!_is_running && !has_tasks()) {
+                    return;
+                }
+            }
+        }
+
+        inline bool has_tasks() {
+            for (const auto& queue : _queues) {
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                if (!queue->tasks.empty()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::vector<std::thread> _workers;
+        std::atomic<size_t> _next_queue;
+        std::mutex _mutex;
+        std::condition_variable _tasks_condition;
+        std::condition_variable _done_condition;
+        size_t _pending;
+        bool _is_running;
+        std::exception_ptr _exception;
+
+    };
+
+
+} // Parallel
+
+
+#endif // LINKRBRAIN2019__SRC__PARALLEL__THREADPOOL_HPP
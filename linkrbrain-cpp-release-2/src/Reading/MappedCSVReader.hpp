@@ -0,0 +1,334 @@
+#ifndef LINKRBRAIN2019__SRC__READING__MAPPEDCSVREADER_HPP
+#define LINKRBRAIN2019__SRC__READING__MAPPEDCSVREADER_HPP
+
+
+#include "Exceptions/Exception.hpp"
+#include "Exceptions/GenericExceptions.hpp"
+#include "Parallel/ThreadPool.hpp"
+
+#include <charconv>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace Reading {
+
+
+    // fields of a CSV row, as views on the mapped file; as with `CSVReader`, double quotes
+    // protect commas & newlines, and are removed from values
+
+    class CSVRow {
+    public:
+
+        struct Field {
+            const char* begin;
+            const char* end;
+            bool is_quoted;
+        };
+
+        inline const size_t size() const {
+            return _fields.size();
+        }
+        inline const std::string_view get_raw(const size_t index) const {
+            const Field& field = _fields[index];
+            return std::string_view(field.begin, field.end - field.begin);
+        }
+        const std::string get_string(const size_t index) const {
+            const Field& field = _fields[index];
+            if (!field.is_quoted) {
+                return std::string(field.begin, field.end);
+            }
+            std::string result;
+            result.reserve(field.end - field.begin);
+            for (const char* c = field.begin; c < field.end; ++c) {
+                if (*c != '\"') {
+                    result.push_back(*c);
+                }
+            }
+            return result;
+        }
+        void get_strings(std::vector<std::string>& result) const {
+            result.resize(_fields.size());
+            for (size_t i = 0; i < _fields.size(); i++) {
+                result[i] = get_string(i);
+            }
+        }
+
+        // surrounding blanks are ignored, as with `std::stod`, but values must be entirely numeric
+
+        template <typename T>
+        const T get_number(const size_t index) const {
+            const Field& field = _fields[index];
+            if (field.is_quoted) {
+                const std::string value = get_string(index);
+                return parse_number<T>(value.data(), value.data() + value.size());
+            }
+            return parse_number<T>(field.begin, field.end);
+        }
+
+    private:
+
+        template <typename T>
+        static const T parse_number(const char* begin, const char* end) {
+            while (begin < end && (*begin == ' ' || *begin == '\t')) {
+                ++begin;
+            }
+            while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) {
+                --end;
+            }
+            if (begin < end && *begin == '+') {
+                ++begin;
+            }
+            T value;
+            const auto [pointer, error] = std::from_chars(begin, end, value);
+            if (error != std::errc() || pointer != end) {
+                throw Exceptions::BadDataException("Cannot parse number from CSV value: `" + std::string(begin, end) + "`");
+            }
+            return value;
+        }
+
+        std::vector<Field> _fields;
+
+        friend class MappedCSVReader;
+
+    };
+
+
+    // maps a whole CSV file in memory; rows can be read sequentially, or the file can be
+    // split into chunks that start at the beginning of a row, parsed by several threads
+    //
+    // Unlike `CSVReader`, commas within quotes are kept, a trailing "\r" is removed from
+    // rows, and the last row is kept even without a final newline.
+
+    class MappedCSVReader {
+    public:
+
+        // below that size, chunks are not worth a thread
+        static const size_t default_min_chunk_size = 1 << 20;
+
+        MappedCSVReader(const std::filesystem::path& path, const size_t skip_lines=0, const size_t threads_count=std::thread::hardware_concurrency()) :
+            _path(path),
+            _data(NULL),
+            _size(0),
+            _threads_count(threads_count ? threads_count : 1),
+            _min_chunk_size(default_min_chunk_size)
+        {
+            const int fd = open(_path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                throw Exceptions::NotFoundException("File not found: " + path.native(), {});
+            }
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) == -1) {
+                const std::string message = strerror(errno);
+                close(fd);
+                except("Could not stat file " + _path.native() + ", " + message);
+            }
+            _size = file_stat.st_size;
+            if (_size) {
+                _data = (const char*) mmap(NULL, _size, PROT_READ, MAP_SHARED, fd, 0);
+                const std::string message = strerror(errno);
+                close(fd);
+                if (_data == MAP_FAILED) {
+                    _data = NULL;
+                    except("Could not map file " + _path.native() + ", " + message);
+                }
+                madvise((void*) _data, _size, MADV_SEQUENTIAL);
+            } else {
+                close(fd);
+            }
+            // skip header lines
+            _begin = _data;
+            for (size_t i = 0; i < skip_lines && _begin < _data + _size; i++) {
+                _begin = find_row_end(_begin, _data + _size, false) + 1;
+            }
+            if (_begin > _data + _size) {
+                _begin = _data + _size;
+            }
+        }
+        MappedCSVReader(const MappedCSVReader&) = delete;
+        MappedCSVReader& operator = (const MappedCSVReader&) = delete;
+
+        ~MappedCSVReader() {
+            if (_data != NULL) {
+                munmap((void*) _data, _size);
+            }
+        }
+
+        inline const size_t get_size() const {
+            return _size;
+        }
+        inline void set_min_chunk_size(const size_t min_chunk_size) {
+            _min_chunk_size = min_chunk_size ? min_chunk_size : 1;
+        }
+
+        // call function(row) for every row, in order
+
+        template <typename Function>
+        void for_each_row(Function&& function) const {
+            parse_rows(_begin, _data + _size, function);
+        }
+
+        // call function(row, result) for every row, on several threads; each chunk of the
+        // file has its own result, and results are returned in the order of the file
+
+        template <typename Result, typename Function>
+        std::vector<Result> map_chunks(Function&& function) const {
+            const std::vector<const char*> bounds = compute_chunks_bounds();
+            const size_t chunks_count = bounds.size() - 1;
+            std::vector<Result> results(chunks_count);
+            if (chunks_count == 1 || _threads_count == 1) {
+                for (size_t c = 0; c < chunks_count; c++) {
+                    parse_rows(bounds[c], bounds[c + 1], [&function, &result = results[c]] (const CSVRow& row) {
+                        function(row, result);
+                    });
+                }
+                return results;
+            }
+            Parallel::ThreadPool thread_pool(std::min(_threads_count, chunks_count));
+            thread_pool.parallel_for(chunks_count, 1, [&] (const size_t begin, const size_t end) {
+                for (size_t c = begin; c < end; c++) {
+                    parse_rows(bounds[c], bounds[c + 1], [&function, &result = results[c]] (const CSVRow& row) {
+                        function(row, result);
+                    });
+                }
+            });
+            return results;
+        }
+
+    private:
+
+        // end of the row starting at `begin`, i.e. the first newline outside of quotes, or `end`
+
+        static const char* find_row_end(const char* begin, const char* end, bool is_quoting) {
+            while (begin < end) {
+                const char* newline = (const char*) memchr(begin, '\n', end - begin);
+                if (newline == NULL) {
+                    newline = end;
+                }
+                for (const char* quote = begin; (quote = (const char*) memchr(quote, '\"', newline - quote)); ++quote) {
+                    is_quoting = !is_quoting;
+                }
+                if (!is_quoting) {
+                    return newline;
+                }
+                begin = newline + 1;
+            }
+            return end;
+        }
+
+        // the file is first split evenly, then the quotes of each part are counted, so that
+        // every chunk can start right after the first newline outside of quotes
+
+        const std::vector<const char*> compute_chunks_bounds() const {
+            const char* end = _data + _size;
+            const size_t size = end - _begin;
+            size_t chunks_count = std::min(4 * _threads_count, size / _min_chunk_size);
+            if (chunks_count <= 1) {
+                return {_begin, end};
+            }
+            std::vector<const char*> bounds(chunks_count + 1);
+            for (size_t c = 0; c < chunks_count; c++) {
+                bounds[c] = _begin + size * c / chunks_count;
+            }
+            bounds[chunks_count] = end;
+            // count quotes in each part
+            std::vector<size_t> quotes_counts(chunks_count, 0);
+            auto count_quotes = [&bounds, &quotes_counts] (const size_t begin, const size_t end) {
+                for (size_t c = begin; c < end; c++) {
+                    for (const char* quote = bounds[c]; (quote = (const char*) memchr(quote, '\"', bounds[c + 1] - quote)); ++quote) {
+                        ++quotes_counts[c];
+                    }
+                }
+            };
+            if (_threads_count > 1) {
+                Parallel::ThreadPool thread_pool(std::min(_threads_count, chunks_count));
+                thread_pool.parallel_for(chunks_count, 1, count_quotes);
+            } else {
+                count_quotes(0, chunks_count);
+            }
+            // align parts on rows
+            bool is_quoting = false;
+            for (size_t c = 1; c < chunks_count; c++) {
+                is_quoting ^= quotes_counts[c - 1] & 1;
+                const char* row_end = find_row_end(bounds[c], end, is_quoting);
+                bounds[c] = std::max(bounds[c - 1], std::min(row_end + 1, end));
+            }
+            return bounds;
+        }
+
+        // split rows of [begin, end), which starts at the beginning of a row, into fields
+
+        template <typename Function>
+        static void parse_rows(const char* begin, const char* end, Function&& function) {
+            CSVRow row;
+            while (begin < end) {
+                row._fields.clear();
+                const char* newline = (const char*) memchr(begin, '\n', end - begin);
+                if (newline == NULL) {
+                    newline = end;
+                }
+                const char* quote = (const char*) memchr(begin, '\"', newline - begin);
+                if (quote == NULL) {
+                    // no quote: fields are separated by every comma
+                    const char* row_end = (newline > begin && newline[-1] == '\r') ? newline - 1 : newline;
+                    for (const char* field_begin = begin; ; ) {
+                        const char* comma = (const char*) memchr(field_begin, ',', row_end - field_begin);
+                        if (comma == NULL) {
+                            row._fields.push_back({field_begin, row_end, false});
+                            break;
+                        }
+                        row._fields.push_back({field_begin, comma, false});
+                        field_begin = comma + 1;
+                    }
+                    begin = newline + 1;
+                } else {
+                    // quotes: look at every character
+                    const char* row_end = find_row_end(begin, end, false);
+                    begin = parse_quoted_row(begin, row_end, row) + 1;
+                }
+                function((const CSVRow&) row);
+            }
+        }
+        static const char* parse_quoted_row(const char* begin, const char* row_end, CSVRow& row) {
+            const char* fields_end = (row_end > begin && row_end[-1] == '\r') ? row_end - 1 : row_end;
+            CSVRow::Field field = {begin, begin, false};
+            bool is_quoting = false;
+            for (const char* c = begin; c < fields_end; ++c) {
+                if (*c == '\"') {
+                    is_quoting = !is_quoting;
+                    field.is_quoted = true;
+                } else if (*c == ',' && !is_quoting) {
+                    field.end = c;
+                    row._fields.push_back(field);
+                    field = {c + 1, c + 1, false};
+                }
+            }
+            field.end = fields_end;
+            row._fields.push_back(field);
+            return row_end;
+        }
+
+        const std::filesystem::path _path;
+        const char* _data;
+        size_t _size;
+        const char* _begin;
+        size_t _threads_count;
+        size_t _min_chunk_size;
+
+    };
+
+
+} // Reading
+
+
+#endif // LINKRBRAIN2019__SRC__READING__MAPPEDCSVREADER_HPP
@@ -21,7 +21,7 @@ namespace Types {
         DateTime() {
             memset(this, 0, sizeof(DateTime));
         }
-        DateTime(const DateTime& source) {
+        DateTime(const DateTime& source) noexcept {
             memcpy(this, &source, sizeof(DateTime));
         }
         template <typename T, std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
@@ -0,0 +1,187 @@
+#ifndef LINKRBRAIN2019__SRC__TYPES__FLATMAP_HPP
+#define LINKRBRAIN2019__SRC__TYPES__FLATMAP_HPP
+
+
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace Types {
+
+
+    // associative container stored as a vector of pairs sorted by key, for the small
+    // objects variants are mostly made of; iterating yields the same order as `std::map`
+    //
+    // Unlike `std::map`, inserting or erasing invalidates references to other values.
+
+    template <typename K, typename V, typename Allocator=std::allocator<std::pair<K, V>>>
+    class FlatMap {
+    public:
+
+        typedef K key_type;
+        typedef V mapped_type;
+        typedef std::pair<K, V> value_type;
+        typedef Allocator allocator_type;
+        typedef std::vector<value_type, Allocator> container_type;
+        typedef typename container_type::iterator iterator;
+        typedef typename container_type::const_iterator const_iterator;
+        typedef typename container_type::size_type size_type;
+
+        // below this size, keys are searched linearly
+        static const size_t linear_search_size = 16;
+
+        FlatMap() {}
+        FlatMap(const Allocator& allocator) :
+            _items(allocator) {}
+        template <typename InputIterator>
+        FlatMap(InputIterator first, InputIterator last) {
+            insert(first, last);
+        }
+        FlatMap(std::initializer_list<value_type> items) {
+            insert(items.begin(), items.end());
+        }
+
+        // iteration
+
+        inline iterator begin() { return _items.begin(); }
+        inline iterator end() { return _items.end(); }
+        inline const_iterator begin() const { return _items.begin(); }
+        inline const_iterator end() const { return _items.end(); }
+        inline const_iterator cbegin() const { return _items.cbegin(); }
+        inline const_iterator cend() const { return _items.cend(); }
+
+        // capacity
+
+        inline const size_type size() const { return _items.size(); }
+        inline const bool empty() const { return _items.empty(); }
+        inline void reserve(const size_type size) { _items.reserve(size); }
+        inline void clear() { _items.clear(); }
+        inline allocator_type get_allocator() const { return _items.get_allocator(); }
+
+        // lookup
+
+        iterator find(const K& key) {
+            const iterator it = lower_bound(key);
+            return (it != _items.end() && it->first == key) ? it : _items.end();
+        }
+        const_iterator find(const K& key) const {
+            const const_iterator it = lower_bound(key);
+            return (it != _items.end() && it->first == key) ? it : _items.end();
+        }
+        inline const size_type count(const K& key) const {
+            return find(key) != _items.end();
+        }
+        inline const bool contains(const K& key) const {
+            return find(key) != _items.end();
+        }
+        V& at(const K& key) {
+            const iterator it = find(key);
+            if (it == _items.end()) {
+                throw std::out_of_range("FlatMap::at");
+            }
+            return it->second;
+        }
+        const V& at(const K& key) const {
+            const const_iterator it = find(key);
+            if (it == _items.end()) {
+                throw std::out_of_range("FlatMap::at");
+            }
+            return it->second;
+        }
+
+        // insertion, which keeps existing values like `std::map` does
+
+        V& operator[](const K& key) {
+            return try_emplace(key).first->second;
+        }
+        V& operator[](K&& key) {
+            return try_emplace(std::move(key)).first->second;
+        }
+        template <typename Key, typename ... Args>
+        std::pair<iterator, bool> try_emplace(Key&& key, Args&& ... args) {
+            // keys often come already sorted, for instance from serialized data
+            if (_items.empty() || _items.back().first < key) {
+                _items.emplace_back(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<Key>(key)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+                return {_items.end() - 1, true};
+            }
+            const iterator it = lower_bound(key);
+            if (it != _items.end() && it->first == key) {
+                return {it, false};
+            }
+            return {_items.emplace(it, std::piecewise_construct,
+                std::forward_as_tuple(std::forward<Key>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...)), true};
+        }
+        std::pair<iterator, bool> insert(const value_type& item) {
+            return try_emplace(item.first, item.second);
+        }
+        std::pair<iterator, bool> insert(value_type&& item) {
+            return try_emplace(std::move(item.first), std::move(item.second));
+        }
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            for (; first != last; ++first) {
+                try_emplace(first->first, first->second);
+            }
+        }
+        template <typename ... Args>
+        std::pair<iterator, bool> emplace(Args&& ... args) {
+            return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        // removal
+
+        iterator erase(const_iterator position) {
+            return _items.erase(position);
+        }
+        const size_type erase(const K& key) {
+            const iterator it = find(key);
+            if (it == _items.end()) {
+                return 0;
+            }
+            _items.erase(it);
+            return 1;
+        }
+
+        // comparison
+
+        const bool operator == (const FlatMap& other) const {
+            return _items == other._items;
+        }
+
+    private:
+
+        template <typename Iterator>
+        static Iterator lower_bound(Iterator first, Iterator last, const K& key) {
+            if (last - first <= (ptrdiff_t) linear_search_size) {
+                while (first != last && first->first < key) {
+                    ++first;
+                }
+                return first;
+            }
+            return std::lower_bound(first, last, key, [] (const value_type& item, const K& key) {
+                return item.first < key;
+            });
+        }
+        inline iterator lower_bound(const K& key) {
+            return lower_bound(_items.begin(), _items.end(), key);
+        }
+        inline const_iterator lower_bound(const K& key) const {
+            return lower_bound(_items.begin(), _items.end(), key);
+        }
+
+        container_type _items;
+
+    };
+
+
+} // Types
+
+
+#endif // LINKRBRAIN2019__SRC__TYPES__FLATMAP_HPP
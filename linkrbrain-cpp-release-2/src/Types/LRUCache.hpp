@@ -0,0 +1,176 @@
+#ifndef LINKRBRAIN2019__SRC__TYPES__LRUCACHE_HPP
+#define LINKRBRAIN2019__SRC__TYPES__LRUCACHE_HPP
+
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace Types {
+
+
+    // LRU cache bounded in bytes, split into shards that are locked independently, so that
+    // concurrent accesses to different keys seldom wait for each other; each shard gets an
+    // equal part of the maximum size, and evicts its own least recently used values
+    //
+    // Values are meant to be shared pointers: a null value is returned for missing keys,
+    // and values that are evicted stay alive for as long as they are used.
+
+    template <typename Key, typename Value, typename Hash=std::hash<Key>>
+    class LRUCache {
+    public:
+
+        struct Stats {
+            size_t hits;
+            size_t misses;
+            size_t evictions;
+            size_t size;
+            size_t count;
+        };
+
+        LRUCache(const size_t max_size, const size_t shards_count=16) :
+            _shards(shards_count ? shards_count : 1),
+            _hits(0),
+            _misses(0),
+            _evictions(0)
+        {
+            set_max_size(max_size);
+        }
+        LRUCache(const LRUCache&) = delete;
+        LRUCache& operator = (const LRUCache&) = delete;
+
+        Value get(const Key& key) {
+            Shard& shard = get_shard(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto it = shard.index.find(key);
+            if (it == shard.index.end()) {
+                ++_misses;
+                return Value();
+            }
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            ++_hits;
+            return it->second->value;
+        }
+
+        // `size` is the memory used by the value, in bytes; values larger than a shard are
+        // not stored; if the key is already present, its value is replaced
+
+        void put(const Key& key, Value value, const size_t size) {
+            Shard& shard = get_shard(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto it = shard.index.find(key);
+            if (it != shard.index.end()) {
+                shard.size -= it->second->size;
+                shard.entries.erase(it->second);
+                shard.index.erase(it);
+            }
+            if (size > shard.max_size) {
+                return;
+            }
+            shard.entries.push_front({key, std::move(value), size});
+            shard.index.insert({key, shard.entries.begin()});
+            shard.size += size;
+            evict(shard);
+        }
+
+        // compute the value outside of any lock when it is missing; concurrent misses on the
+        // same key may therefore compute it more than once, the last one being kept
+
+        template <typename Compute>
+        Value get_or_compute(const Key& key, Compute compute) {
+            Value value = get(key);
+            if (!value) {
+                size_t size;
+                value = compute(size);
+                put(key, value, size);
+            }
+            return value;
+        }
+
+        void clear() {
+            for (Shard& shard : _shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.entries.clear();
+                shard.index.clear();
+                shard.size = 0;
+            }
+        }
+
+        void set_max_size(const size_t max_size) {
+            for (Shard& shard : _shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.max_size = max_size / _shards.size();
+                evict(shard);
+            }
+        }
+        const size_t get_max_size() {
+            size_t max_size = 0;
+            for (Shard& shard : _shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                max_size += shard.max_size;
+            }
+            return max_size;
+        }
+        inline const size_t get_shards_count() const {
+            return _shards.size();
+        }
+
+        // counters are kept until the cache is destroyed
+
+        const Stats get_stats() {
+            Stats stats = {_hits, _misses, _evictions, 0, 0};
+            for (Shard& shard : _shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                stats.size += shard.size;
+                stats.count += shard.entries.size();
+            }
+            return stats;
+        }
+
+    private:
+
+        struct Entry {
+            Key key;
+            Value value;
+            size_t size;
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            std::list<Entry> entries;
+            std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+            size_t max_size = 0;
+            size_t size = 0;
+        };
+
+        inline Shard& get_shard(const Key& key) {
+            return _shards[Hash()(key) % _shards.size()];
+        }
+
+        // must be called with the shard's mutex locked
+        inline void evict(Shard& shard) {
+            while (shard.size > shard.max_size && !shard.entries.empty()) {
+                shard.size -= shard.entries.back().size;
+                shard.index.erase(shard.entries.back().key);
+                shard.entries.pop_back();
+                ++_evictions;
+            }
+        }
+
+        std::vector<Shard> _shards;
+        std::atomic<size_t> _hits;
+        std::atomic<size_t> _misses;
+        std::atomic<size_t> _evictions;
+
+    };
+
+
+} // Types
+
+
+#endif // LINKRBRAIN2019__SRC__TYPES__LRUCACHE_HPP
@@ -0,0 +1,91 @@
+#ifndef LINKRBRAIN2019__SRC__TYPES__PACKEDPOINTS_HPP
+#define LINKRBRAIN2019__SRC__TYPES__PACKEDPOINTS_HPP
+
+
+#include "./Point.hpp"
+#include "Exceptions/Exception.hpp"
+
+#include <stdlib.h>
+#include <limits>
+#include <vector>
+
+
+namespace Types {
+
+    // structure-of-arrays version of a list of points, for vectorized scoring;
+    // instead of the raw weight, the signed square root of its absolute value is stored;
+    // arrays are padded to a multiple of `lanes` with null-weighted points at infinity
+
+    template <typename T>
+    class PackedPoints {
+    public:
+
+        static const size_t alignment = 64;
+        static const size_t lanes = 8;
+
+        PackedPoints(const std::vector<Point<T>>& points) :
+            _size(points.size()),
+            _padded_size(lanes * ((points.size() + lanes - 1) / lanes)),
+            _data(NULL)
+        {
+            if (_padded_size == 0) {
+                return;
+            }
+            const size_t data_size = 4 * _padded_size * sizeof(T);
+            _data = (T*) aligned_alloc(alignment, data_size + (alignment - data_size % alignment) % alignment);
+            if (_data == NULL) {
+                except("Could not allocate", data_size, "bytes for PackedPoints");
+            }
+            T* x = _data;
+            T* y = x + _padded_size;
+            T* z = y + _padded_size;
+            T* w = z + _padded_size;
+            for (size_t i=0; i<_size; ++i) {
+                const Point<T>& point = points[i];
+                x[i] = point.x;
+                y[i] = point.y;
+                z[i] = point.z;
+                w[i] = (point.weight < 0) ? -std::sqrt(-point.weight) : std::sqrt(point.weight);
+            }
+            for (size_t i=_size; i<_padded_size; ++i) {
+                x[i] = y[i] = z[i] = std::numeric_limits<T>::infinity();
+                w[i] = static_cast<T>(0);
+            }
+        }
+        PackedPoints(const PackedPoints&) = delete;
+        PackedPoints& operator = (const PackedPoints&) = delete;
+        ~PackedPoints() {
+            free(_data);
+        }
+
+        inline const size_t& size() const {
+            return _size;
+        }
+        inline const size_t& get_padded_size() const {
+            return _padded_size;
+        }
+        inline const T* get_x() const {
+            return _data;
+        }
+        inline const T* get_y() const {
+            return _data + _padded_size;
+        }
+        inline const T* get_z() const {
+            return _data + 2 * _padded_size;
+        }
+        inline const T* get_signed_root_weight() const {
+            return _data + 3 * _padded_size;
+        }
+
+    private:
+
+        const size_t _size;
+        const size_t _padded_size;
+        T* _data;
+
+    };
+
+} // Types
+
+
+#endif // LINKRBRAIN2019__SRC__TYPES__PACKEDPOINTS_HPP
@@ -10,6 +10,9 @@
 #include <ostream>
 #include <unordered_map>
 
+#include "./FlatMap.hpp"
+#include "./VariantArena.hpp"
+
 
 namespace Types {
 
@@ -17,8 +20,8 @@ namespace Types {
     struct VariantNull{
         const bool operator== (const VariantNull& other) const { return true; }
     };
-    typedef std::vector<Variant> VariantVector;
-    typedef std::map<std::string, Variant> VariantMap;
+    typedef std::vector<Variant, VariantAllocator<Variant>> VariantVector;
+    typedef FlatMap<std::string, Variant, VariantAllocator<std::pair<std::string, Variant>>> VariantMap;
 
 } // Types
 
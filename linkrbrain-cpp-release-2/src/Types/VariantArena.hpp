@@ -0,0 +1,109 @@
+#ifndef LINKRBRAIN2019__SRC__TYPES__VARIANTARENA_HPP
+#define LINKRBRAIN2019__SRC__TYPES__VARIANTARENA_HPP
+
+
+#include <cstddef>
+#include <memory_resource>
+
+
+namespace Types {
+
+
+    // memory resource used by the containers of variants created on the current thread;
+    // it is only changed by `VariantArena::Scope`
+    inline thread_local std::pmr::memory_resource* variant_memory_resource = std::pmr::new_delete_resource();
+
+
+    // allocator of `VariantVector` & `VariantMap`
+    //
+    // Containers take the memory resource of the current thread when they are created,
+    // and keep it when moved. Copies are always allocated on the heap, so that a copy
+    // can be stored for longer than the arena it was copied from.
+
+    template <typename T>
+    class VariantAllocator {
+    public:
+
+        typedef T value_type;
+
+        VariantAllocator() noexcept :
+            _resource(variant_memory_resource) {}
+        VariantAllocator(std::pmr::memory_resource* resource) noexcept :
+            _resource(resource) {}
+        template <typename U>
+        VariantAllocator(const VariantAllocator<U>& other) noexcept :
+            _resource(other.get_resource()) {}
+
+        T* allocate(const size_t count) {
+            return static_cast<T*>(_resource->allocate(count * sizeof(T), alignof(T)));
+        }
+        void deallocate(T* pointer, const size_t count) noexcept {
+            _resource->deallocate(pointer, count * sizeof(T), alignof(T));
+        }
+
+        VariantAllocator select_on_container_copy_construction() const {
+            return VariantAllocator(std::pmr::new_delete_resource());
+        }
+
+        inline std::pmr::memory_resource* get_resource() const {
+            return _resource;
+        }
+
+        template <typename U>
+        const bool operator == (const VariantAllocator<U>& other) const noexcept {
+            return _resource == other.get_resource() || _resource->is_equal(*other.get_resource());
+        }
+
+    private:
+
+        std::pmr::memory_resource* _resource;
+
+    };
+
+
+    // monotonic arena for variants that all die at once, typically with a request
+    //
+    // While a scope is alive, variant containers created on its thread are allocated in
+    // the arena, and their memory is only given back when the arena is destroyed. The
+    // arena must therefore outlive these variants, and they should not be moved into
+    // anything that lives longer (copying them is fine).
+
+    class VariantArena {
+    public:
+
+        VariantArena(const size_t initial_size=16 << 10) :
+            _resource(initial_size, std::pmr::new_delete_resource()) {}
+        VariantArena(const VariantArena&) = delete;
+        VariantArena& operator = (const VariantArena&) = delete;
+
+        inline std::pmr::memory_resource* get_resource() {
+            return &_resource;
+        }
+
+        class Scope {
+        public:
+            Scope(VariantArena& arena) :
+                _previous_resource(variant_memory_resource)
+            {
+                variant_memory_resource = arena.get_resource();
+            }
+            Scope(const Scope&) = delete;
+            Scope& operator = (const Scope&) = delete;
+            ~Scope() {
+                variant_memory_resource = _previous_resource;
+            }
+        private:
+            std::pmr::memory_resource* const _previous_resource;
+        };
+
+    private:
+
+        std::pmr::monotonic_buffer_resource _resource;
+
+    };
+
+
+} // Types
+
+
+#endif // LINKRBRAIN2019__SRC__TYPES__VARIANTARENA_HPP
@@ -30,6 +30,8 @@ int main(int argc, char const *argv[]) {
         );
         root.add_option('L', "log-level", "log level, within this set of possible values: detail, debug, notice, message, warning, error, fatal, none", "none");
         root.add_option('d', "data", "Location where LinkRbrain data is stored", "var/data");
+        root.add_option('c', "cache-type", "Correlator caches to load; can be either 'mmap' for computed caches, or 'sparse' for caches compressed with 'dataset compact-cache'", "mmap");
+        root.add_option('M', "cache-lock", "Lock memory-mapped correlator caches in RAM; only applies to 'mmap' caches, and is limited by RLIMIT_MEMLOCK", CLI::Arguments::Option::Flag);
         root.add_option('D', "debug", "Debugging mode", CLI::Arguments::Option::Flag | CLI::Arguments::Option::Hidden);
         root.add_option('t', "db-type", "Database type; for now, only 'postgres' is supported", default_db_type);
         root.add_option('s', "db-connection", "Connection string for database", default_db_connection);
@@ -126,11 +128,15 @@ int main(int argc, char const *argv[]) {
         dataset_rename.add_option('o', "organ", "Name or identifier of the organ to which the considered dataset is attached", CLI::Arguments::Option::Required);
         dataset_rename.add_option('d', "dataset", "Name or identifier of the dataset to rename", CLI::Arguments::Option::Required);
         dataset_rename.add_option('n', "name", "New name of the dataset", CLI::Arguments::Option::Required);
+        // dataset compact-cache
+        auto& dataset_compact_cache = dataset.add_subcommand("compact-cache", "Write compressed copies of the correlator caches of an existing dataset, where only nonzero scores are stored", LinkRbrain::Commands::dataset_compact_cache);
+        dataset_compact_cache.add_option('o', "organ", "Name or identifier of the organ to which the considered dataset is attached", CLI::Arguments::Option::Required);
+        dataset_compact_cache.add_option('d', "dataset", "Name or identifier of the dataset whose caches have to be compacted", CLI::Arguments::Option::Required);
         // dataset correlate
         auto& dataset_query = dataset.add_subcommand("query", "Correlate points with an existing dataset", LinkRbrain::Commands::dataset_query);
         dataset_query.add_option('o', "organ", "Name or identifier of the organ to which the considered dataset is attached", CLI::Arguments::Option::Required);
         dataset_query.add_option('d', "dataset", "Name or identifier of the dataset against which the user input has to be correlated", CLI::Arguments::Option::Required);
-        dataset_query.add_option('t', "source-type", "Source type for the input to be correlated with the dataset; can take one of the following values: 'points' for given coordinates, 'group' for an existing dataset group, 'text' for a text file, 'nifti' for a NIfTI file", CLI::Arguments::Option::Required);
+        dataset_query.add_option('t', "source-type", "Source type for the input to be correlated with the dataset; can take one of the following values: 'points' for given coordinates, 'group' for an existing dataset group, 'text' for a text file, 'nifti' for a NIfTI file, 'batch' for a JSON file listing several queries", CLI::Arguments::Option::Required);
         dataset_query.add_option('P', "source-point", "Input points, where floating-point coordinates are separated with spaces", CLI::Arguments::Option::Multiple).depends_on("source-type", "points");
         dataset_query.add_option('D', "source-dataset", "Name or identifier of the dataset from which input data should be taken; defaults to the dataset against which correlation will happen; if unspecified, takes the same value as --dataset").depends_on("source-type", "group");
         dataset_query.add_option('G', "source-group", "Name of the input group to be correlated", CLI::Arguments::Option::Required).depends_on("source-type", "group");
@@ -138,6 +144,7 @@ int main(int argc, char const *argv[]) {
         dataset_query.add_option('T', "source-text", "Path to a text file listing input points", CLI::Arguments::Option::Required).depends_on("source-type", "text");
         dataset_query.add_option('N', "source-nifti", "Path to the input NIfTI file", CLI::Arguments::Option::Required).depends_on("source-type", "nifti");
         dataset_query.add_option('R', "resolution", "Resolution to use for points extraction from NIfTI file", "4").depends_on("source-type", "nifti");
+        dataset_query.add_option('b', "source-batch", "Path to a JSON file listing queries to be correlated together; each query is an object with 'groups' (each one having a 'label' and 'points') and optional 'settings'", CLI::Arguments::Option::Required).depends_on("source-type", "batch");
         dataset_query.add_option('l', "limit", "Maximum number of results to display", "20");
         dataset_query.add_option('u', "uncached", "Force just-in-time calculations, event when cache is present", CLI::Arguments::Option::Flag);
         dataset_query.add_option('i', "interpolate", "Use interpolation when calculations are computed using cache", CLI::Arguments::Option::Flag);
@@ -164,6 +171,14 @@ int main(int argc, char const *argv[]) {
         auto& webserver_start = webserver.add_subcommand("start", "Start web server", LinkRbrain::Commands::linkrbrain_webserver);
         webserver_start.add_option('c', "client-caching", "Use client-side caching with 304", CLI::Arguments::Option::Flag);
         webserver_start.add_option('C', "server-caching", "Use server-side caching, keeping static resources in memory", CLI::Arguments::Option::Flag);
+        webserver_start.add_option('g', "gzip", "Compress JSON responses of at least 4KiB for clients accepting gzip", CLI::Arguments::Option::Flag);
+        webserver_start.add_option('T', "http-threads", "Number of threads answering HTTP requests; 0 for one per processor core", "0");
+        webserver_start.add_option('j', "jobs-workers", "Number of threads computing queries in background", "1");
+        webserver_start.add_option('q', "jobs-queue-size", "Maximum number of queued computations; further requests are answered with 503", "64");
+        webserver_start.add_option('p', "pdf-workers", "Number of threads rendering PDF reports in background", "1");
+        webserver_start.add_option('Q', "pdf-queue-size", "Maximum number of queued PDF reports; further requests are answered with 503", "16");
+        webserver_start.add_option('M', "pdf-cache-size", "Maximum size of rendered PDF reports kept on disk, in MiB; least recently used ones are removed first", "512");
+        webserver_start.add_option('A', "pdf-cache-age", "Maximum age of rendered PDF reports kept on disk, in hours", "168");
         webserver.add_subcommand("status", "Display web server status", LinkRbrain::Commands::linkrbrain_webserver);
         webserver.add_subcommand("stop", "Stop web server", LinkRbrain::Commands::linkrbrain_webserver);
         webserver.add_subcommand("restart", "Restart web server", LinkRbrain::Commands::linkrbrain_webserver);
@@ -1,25 +1,252 @@
-#include "Utils/Logger.hpp"
+#include "Reading/MappedCSVReader.hpp"
 #include "Reading/CSVReader.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
 #include <vector>
 
 
+typedef std::vector<std::vector<std::string>> Rows;
+
 const std::string path = "data/old/genes/SampleAnnot.csv";
 const size_t skip_lines = 1;
+const std::filesystem::path tmp_path = std::filesystem::temp_directory_path() / "linkrbrain-tests-csv";
+const size_t benchmark_size = 1 << 30;
+const size_t benchmark_columns_count = 100;
 
 
-int main(int argc, char const *argv[]) {
+void write_file(const std::filesystem::path& path, const std::string& contents) {
+    std::ofstream(path, std::ios::binary) << contents;
+}
 
-    Logger logger(std::cerr, true);
-    logger.notice("instanciated logger");
-    Reading::CSVReader csv(path, skip_lines);
-    logger.notice("instanciated reader");
+const Rows read_sequentially(const std::filesystem::path& path, const size_t skip_lines=0) {
+    Rows rows;
+    Reading::MappedCSVReader csv(path, skip_lines);
+    csv.for_each_row([&rows] (const Reading::CSVRow& row) {
+        rows.emplace_back();
+        row.get_strings(rows.back());
+    });
+    return rows;
+}
 
+const Rows read_in_chunks(const std::filesystem::path& path, const size_t min_chunk_size, const size_t threads_count, const size_t skip_lines=0) {
+    Reading::MappedCSVReader csv(path, skip_lines, threads_count);
+    csv.set_min_chunk_size(min_chunk_size);
+    Rows rows;
+    for (const Rows& chunk_rows : csv.map_chunks<Rows>([] (const Reading::CSVRow& row, Rows& rows) {
+        rows.emplace_back();
+        row.get_strings(rows.back());
+    })) {
+        rows.insert(rows.end(), chunk_rows.begin(), chunk_rows.end());
+    }
+    return rows;
+}
+
+const Rows read_with_previous_reader(const std::filesystem::path& path) {
+    Rows rows;
+    Reading::CSVReader csv(path);
     std::vector<std::string> values;
     while (csv.parse_line(values)) {
-        std::cout << values[12] << '\n';
+        rows.push_back(values);
     }
-    logger.notice("read whole file");
+    return rows;
+}
+
+// the previous reader dropped commas within quotes
+
+const Rows remove_commas(Rows rows) {
+    for (auto& row : rows) {
+        for (auto& value : row) {
+            value.erase(std::remove(value.begin(), value.end(), ','), value.end());
+        }
+    }
+    return rows;
+}
+
+void check_rows(const Rows& rows, const Rows& expected_rows, const std::string& description) {
+    if (rows != expected_rows) {
+        except("Wrong rows", description, ": got", rows.size(), "rows instead of", expected_rows.size());
+    }
+}
+
+// fields are either plain, or quoted with commas, newlines & doubled quotes inside
+
+const std::string make_csv(std::mt19937& generator, const size_t rows_count, const std::string& newline) {
+    std::uniform_int_distribution<int> columns_count(1, 6), length(0, 5), kind(0, 3);
+    const std::string plain_characters = "ab1 .";
+    const std::vector<std::string> quoted_characters = {"a", ",", "\n", "\"\"", newline};
+    std::string result;
+    for (size_t r = 0; r < rows_count; r++) {
+        for (int c = 0, n = columns_count(generator); c < n; c++) {
+            if (c) {
+                result += ',';
+            }
+            const bool is_quoted = (kind(generator) == 0);
+            result += is_quoted ? "\"" : "";
+            for (int i = 0, l = length(generator); i < l; i++) {
+                result += is_quoted
+                    ? quoted_characters[generator() % quoted_characters.size()]
+                    : std::string(1, plain_characters[generator() % plain_characters.size()]);
+            }
+            result += is_quoted ? "\"" : "";
+        }
+        result += newline;
+    }
+    return result;
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("csv");
+    std::filesystem::create_directories(tmp_path);
+    const std::filesystem::path csv_path = tmp_path / "test.csv";
+
+    // sample annotations, if available
+    if (std::filesystem::exists(path)) {
+        Reading::CSVReader csv(path, skip_lines);
+        Reading::MappedCSVReader mapped_csv(path, skip_lines);
+        std::vector<std::string> values;
+        mapped_csv.for_each_row([&] (const Reading::CSVRow& row) {
+            if (!csv.parse_line(values)) {
+                except("Previous reader found less rows");
+            }
+            if (std::stod(values[12]) != row.get_number<double>(12)) {
+                except("Readers disagree on", row.get_raw(12));
+            }
+        });
+        logger.message("Read", path);
+    }
+
+    // quoting, as before
+    {
+        write_file(csv_path, "a,\"b,c\",d\n\"e\"\"f\",,\"g\nh\"\n\n1, 2 ,\"3\"\n");
+        const Rows expected_rows = {{"a", "b,c", "d"}, {"ef", "", "g\nh"}, {""}, {"1", " 2 ", "3"}};
+        check_rows(read_with_previous_reader(csv_path), remove_commas(expected_rows), "with previous reader");
+        check_rows(read_sequentially(csv_path), expected_rows, "with quotes");
+        check_rows(read_sequentially(csv_path, 1), Rows(expected_rows.begin() + 1, expected_rows.end()), "after header");
+        check_rows(read_sequentially(csv_path, 2), Rows(expected_rows.begin() + 2, expected_rows.end()), "after multiline header");
+        check_rows(read_sequentially(csv_path, 10), {}, "after whole file");
+        Reading::MappedCSVReader csv(csv_path, 3);
+        csv.for_each_row([] (const Reading::CSVRow& row) {
+            if (row.get_number<int>(0) != 1 || row.get_number<double>(1) != 2. || row.get_number<uint64_t>(2) != 3) {
+                except("Wrong numbers");
+            }
+        });
+        write_file(csv_path, "1.5,x,-3e2,4x\n");
+        Reading::MappedCSVReader(csv_path).for_each_row([] (const Reading::CSVRow& row) {
+            if (row.get_number<double>(0) != 1.5 || row.get_number<double>(2) != -300.) {
+                except("Wrong numbers");
+            }
+            for (const size_t index : {1, 3}) {
+                bool is_thrown = false;
+                try {
+                    row.get_number<double>(index);
+                } catch (const Exceptions::BadDataException&) {
+                    is_thrown = true;
+                }
+                if (!is_thrown) {
+                    except("Non-numeric value should not be parsed:", row.get_raw(index));
+                }
+            }
+        });
+    }
+    logger.message("Quoted fields are read as before");
+
+    // CRLF, and missing final newline
+    {
+        write_file(csv_path, "a,b\r\n\"c\r\nd\",\"e\"\r\n\r\n1,2");
+        check_rows(read_sequentially(csv_path), {{"a", "b"}, {"c\r\nd", "e"}, {""}, {"1", "2"}}, "with CRLF");
+        write_file(csv_path, "");
+        check_rows(read_sequentially(csv_path), {}, "from empty file");
+        check_rows(read_in_chunks(csv_path, 1, 4), {}, "from empty file in chunks");
+    }
+    logger.message("CRLF are removed");
+
+    // chunk boundaries
+    {
+        std::mt19937 generator(1);
+        for (const std::string newline : {"\n", "\r\n"}) {
+            for (size_t i = 0; i < 20; i++) {
+                write_file(csv_path, make_csv(generator, 1 + i * i, newline));
+                const Rows expected_rows = read_sequentially(csv_path);
+                if (newline == "\n") {
+                    check_rows(read_with_previous_reader(csv_path), remove_commas(expected_rows), "with previous reader");
+                }
+                for (const size_t min_chunk_size : {1, 2, 3, 7, 64, 1 << 20}) {
+                    for (const size_t threads_count : {1, 4}) {
+                        check_rows(read_in_chunks(csv_path, min_chunk_size, threads_count), expected_rows, "in chunks");
+                        check_rows(read_in_chunks(csv_path, min_chunk_size, threads_count, 2), read_sequentially(csv_path, 2), "in chunks after header");
+                    }
+                }
+            }
+        }
+    }
+    logger.message("Chunks start at the beginning of rows");
+
+    // benchmark, on a file looking like MicroarrayExpression.csv
+    {
+        const std::filesystem::path benchmark_path = tmp_path / "benchmark.csv";
+        {
+            std::mt19937 generator(1);
+            std::uniform_real_distribution<double> expression(0., 16.);
+            std::ofstream file(benchmark_path, std::ios::binary);
+            std::string row;
+            char buffer[32];
+            for (size_t size = 0, probe_id = 1000000; size < benchmark_size; size += row.size(), ++probe_id) {
+                row = std::to_string(probe_id);
+                for (size_t c = 0; c < benchmark_columns_count; c++) {
+                    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), expression(generator), std::chars_format::fixed, 6);
+                    row += ',';
+                    row.append(buffer, result.ptr);
+                }
+                row += '\n';
+                file << row;
+            }
+        }
+        // parse every value as `GenomicsV1Parser` did, then as it does now
+        double t0 = Logging::Logger::get_millitime();
+        size_t rows_count = 0;
+        double sum = 0.;
+        {
+            Reading::CSVReader csv(benchmark_path);
+            std::vector<std::string> columns;
+            while (csv.parse_line(columns)) {
+                ++rows_count;
+                for (size_t i = 1; i < columns.size(); i++) {
+                    sum += std::stod(columns[i]);
+                }
+            }
+        }
+        const double previous_dt = Logging::Logger::get_millitime() - t0;
+        t0 = Logging::Logger::get_millitime();
+        Reading::MappedCSVReader csv(benchmark_path);
+        const std::vector<std::pair<size_t, double>> results = csv.map_chunks<std::pair<size_t, double>>([] (const Reading::CSVRow& row, std::pair<size_t, double>& result) {
+            ++result.first;
+            for (size_t i = 1; i < row.size(); i++) {
+                result.second += row.get_number<double>(i);
+            }
+        });
+        for (const auto& [chunk_rows_count, chunk_sum] : results) {
+            rows_count -= chunk_rows_count;
+            sum -= chunk_sum;
+        }
+        const double dt = Logging::Logger::get_millitime() - t0;
+        if (rows_count != 0 || std::abs(sum) > 1e-6 * benchmark_size) {
+            except("Readers should find the same values");
+        }
+        logger.message("Read", csv.get_size() >> 20, "MiB: previous reader with std::stod in", previous_dt, "s, mapped reader with std::from_chars in", dt, "s, on", std::thread::hardware_concurrency(), "threads");
+        std::filesystem::remove(benchmark_path);
+    }
+
+    // the end!
+    std::filesystem::remove_all(tmp_path);
+    logger.message("All tests passed");
     return 0;
 }
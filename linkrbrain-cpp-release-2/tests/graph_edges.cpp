@@ -0,0 +1,188 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Graph/Graph.hpp"
+#include "LinkRbrain/Scoring/Scorer.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+
+typedef LinkRbrain::Graph::Graph<double> Graph;
+
+static const size_t groups_count = 1000;
+static const size_t group_points_count = 20;
+static const double diameter = 10.0;
+static const int seed = 1;
+
+
+// as for layouts, with a few links per node and weights spanning several orders of magnitude
+
+void make_links(Graph& graph, std::mt19937& generator, const double links_per_node=8.) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    for (size_t i = 0; i < graph.count; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (uniform(generator) < links_per_node / graph.count) {
+                graph.add_link(j, i, std::pow(10., -4. * uniform(generator)));
+            }
+        }
+    }
+}
+
+// small clusters of points scattered in the brain, as activation foci
+
+const std::vector<Types::Point<double>> make_group(std::mt19937& generator) {
+    std::uniform_real_distribution<double> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    std::normal_distribution<double> spread(0, 3);
+    const Types::Point<double> center(x(generator), y(generator), z(generator));
+    std::vector<Types::Point<double>> points;
+    for (size_t i = 0; i < group_points_count; i++) {
+        points.push_back({center.x + spread(generator), center.y + spread(generator), center.z + spread(generator), weight(generator)});
+    }
+    return points;
+}
+
+const Types::PointExtrema<double> compute_extrema(const std::vector<Types::Point<double>>& points) {
+    Types::PointExtrema<double> extrema(points[0]);
+    for (const auto& point : points) {
+        extrema.integrate(point);
+    }
+    return extrema;
+}
+
+// check that both formats have the same entries above the cutoff
+
+void check_equivalence(const Graph& graph, const double min_k_spring) {
+    Types::Variant dense, sparse;
+    graph.serialize_edges(dense, Graph::Dense, min_k_spring);
+    graph.serialize_edges(sparse, Graph::Sparse, min_k_spring);
+    if (dense.get_vector().size() != graph.count) {
+        except("Dense edges should have one row per node");
+    }
+    size_t nonzero_count = 0;
+    for (size_t i = 0; i < graph.count; i++) {
+        for (size_t j = 0; j < graph.count; j++) {
+            const double weight = dense[i][j].get_number();
+            if (weight != 0.) {
+                if (j <= i || weight <= min_k_spring || weight != graph.get_link(i, j)) {
+                    except("Wrong dense edge between", i, "and", j);
+                }
+                ++nonzero_count;
+            }
+        }
+    }
+    if (sparse.get_vector().size() != nonzero_count) {
+        except("Sparse edges should have", nonzero_count, "entries, got", sparse.get_vector().size());
+    }
+    int64_t previous_i = -1, previous_j = -1;
+    for (const auto& edge : sparse.get_vector()) {
+        const int64_t i = edge[0].get_number();
+        const int64_t j = edge[1].get_number();
+        if (i >= j || dense[i][j].get_number() != edge[2].get_number()) {
+            except("Sparse edge between", i, "and", j, "differs from dense one");
+        }
+        if (i < previous_i || (i == previous_i && j <= previous_j)) {
+            except("Sparse edges should be sorted");
+        }
+        previous_i = i;
+        previous_j = j;
+    }
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("graph");
+    std::mt19937 generator(seed);
+
+    // equivalence of formats
+    {
+        Graph graph(200);
+        make_links(graph, generator);
+        graph.normalize_links();
+        for (const double min_k_spring : {0., 1e-3, 0.5}) {
+            check_equivalence(graph, min_k_spring);
+        }
+        Graph empty_graph(3);
+        check_equivalence(empty_graph, 0.);
+        Types::Variant sparse;
+        empty_graph.serialize_edges(sparse, Graph::Sparse);
+        if (Conversion::JSON::serialize(sparse) != "[]") {
+            except("Graph without links should have no sparse edges");
+        }
+    }
+    logger.message("Dense & sparse edges are equivalent");
+
+    // distant groups do not score
+    std::vector<std::vector<Types::Point<double>>> groups;
+    std::deque<Types::PackedPoints<double>> packed_groups;
+    std::vector<Types::PointExtrema<double>> groups_extrema;
+    for (size_t i = 0; i < groups_count; i++) {
+        groups.push_back(make_group(generator));
+        packed_groups.emplace_back(groups.back());
+        groups_extrema.push_back(compute_extrema(groups.back()));
+    }
+    for (const auto mode : {LinkRbrain::Scoring::Scorer::Distance, LinkRbrain::Scoring::Scorer::Sphere}) {
+        const LinkRbrain::Scoring::Scorer scorer(mode, diameter);
+        size_t distant_count = 0, zero_count = 0;
+        for (size_t i = 0; i < 200; i++) {
+            for (size_t j = 0; j < i; j++) {
+                const double score = scorer.score(packed_groups[i], packed_groups[j]);
+                if (scorer.are_distant(groups_extrema[i], groups_extrema[j])) {
+                    if (score != 0.) {
+                        except("Groups", i, "and", j, "were deemed distant, but score", score);
+                    }
+                    ++distant_count;
+                }
+                zero_count += (score == 0.);
+            }
+        }
+        logger.debug(distant_count, "distant pairs out of", zero_count, "with a zero score");
+    }
+    logger.message("Distant groups do not score");
+
+    // benchmark: scoring pairs of 1000 groups
+    {
+        const LinkRbrain::Scoring::Scorer scorer(LinkRbrain::Scoring::Scorer::Sphere, diameter);
+        double scores_sums[2] = {0., 0.};
+        double dts[2];
+        size_t scored_count = 0;
+        for (const bool use_extrema : {false, true}) {
+            const double t0 = Logging::Logger::get_millitime();
+            for (size_t i = 0; i < groups_count; i++) {
+                for (size_t j = 0; j < i; j++) {
+                    if (use_extrema && scorer.are_distant(groups_extrema[i], groups_extrema[j])) {
+                        continue;
+                    }
+                    scores_sums[use_extrema] += scorer.score(packed_groups[i], packed_groups[j]);
+                    scored_count += use_extrema;
+                }
+            }
+            dts[use_extrema] = Logging::Logger::get_millitime() - t0;
+        }
+        if (scores_sums[0] != scores_sums[1]) {
+            except("Skipping distant pairs should not change scores");
+        }
+        logger.message(groups_count, "groups, scoring every pair:", dts[0], "s, skipping distant pairs:", dts[1], "s (", scored_count, "pairs out of", groups_count * (groups_count - 1) / 2, ")");
+    }
+
+    // benchmark: formatting edges of a graph with 1000 nodes
+    {
+        Graph graph(groups_count);
+        make_links(graph, generator);
+        graph.normalize_links();
+        for (const auto format : {Graph::Dense, Graph::Sparse}) {
+            const double t0 = Logging::Logger::get_millitime();
+            Types::Variant edges;
+            graph.serialize_edges(edges, format);
+            const std::string json = Conversion::JSON::serialize(edges);
+            const double dt = Logging::Logger::get_millitime() - t0;
+            logger.message(groups_count, "nodes,", graph.edges.size(), "edges,", (format == Graph::Dense) ? "dense" : "sparse", "format:", json.size(), "bytes of JSON in", dt, "s");
+        }
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include "LinkRbrain/Graph/Graph.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+typedef LinkRbrain::Graph::Graph<double> Graph;
+
+static const size_t benchmark_iterations_count = 20;
+
+
+// sparse links, about as many per node whatever the size of the graph
+
+void make_links(Graph& graph, const int seed, const double links_per_node=8.) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> weight(0, 1);
+    for (size_t i = 0; i < graph.count; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (weight(generator) < links_per_node / graph.count) {
+                graph.add_link(j, i, weight(generator));
+            }
+        }
+    }
+}
+
+// larger graphs take very long to cool down with the default friction, so it increases
+// faster there; both layouts get the same schedule anyway
+
+const double compute_layout(Graph& graph, const Graph::Repulsion repulsion, size_t& iterations_count, double& dt) {
+    graph.repulsion = repulsion;
+    size_t max_iterations_count = -1;
+    if (graph.count > 100) {
+        graph.df *= 10.;
+        max_iterations_count = 15000;
+    }
+    const double t0 = Logging::Logger::get_millitime();
+    iterations_count = graph.compute(100, max_iterations_count);
+    dt = Logging::Logger::get_millitime() - t0;
+    return graph.compute_potential_energy();
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("graph");
+
+    // sparse links
+    {
+        Graph graph(5);
+        graph.add_link(1, 3, 0.5);
+        graph.add_link(3, 1, 0.25);
+        graph.add_link(2, 4, 0.);
+        graph.add_link(2, 2, 1.);
+        if (graph.edges.size() != 1 || graph.get_link(1, 3) != graph.k_spring * 0.75 || graph.get_link(3, 1) != graph.get_link(1, 3) || graph.get_link(2, 4) != 0.) {
+            except("Wrong links");
+        }
+        graph.add_link(0, 4, 0.25);
+        graph.normalize_links();
+        if (graph.get_link(1, 3) != 1. || graph.get_link(0, 4) != 0.25 / 0.75 || graph.get_link(0, 1) != 0.) {
+            except("Missing links should count as zero when normalized");
+        }
+    }
+    logger.message("Links are stored sparsely");
+
+    // repulsive links, and pairs without a spring, are normalized as in a dense matrix
+    {
+        Graph graph(5);
+        graph.add_link(0, 1, -0.5);
+        graph.add_link(2, 3, 0.5);
+        graph.normalize_links();
+        if (graph.get_link(0, 1) != 0. || graph.get_link(2, 3) != 1. || graph.get_link(0, 4) != 0.5 || graph.get_missing_link() != 0.5) {
+            except("Missing links should be normalized like the others");
+        }
+        Types::Variant dense;
+        graph.serialize_edges(dense, Graph::Dense);
+        if (dense[0][4].get_number() != 0.5 || dense[4][0].get_number() != 0. || dense[0][1].get_number() != 0. || dense[2][3].get_number() != 1.) {
+            except("Dense edges should hold missing links");
+        }
+        // links added afterwards start from the stiffness of missing ones
+        graph.add_link(1, 4, 0.1 / graph.k_spring);
+        if (std::abs(graph.get_link(1, 4) - 0.6) > 1e-12) {
+            except("Wrong link added after normalization:", graph.get_link(1, 4));
+        }
+    }
+    {
+        // repulsive springs act on the layout
+        Graph graph(4), repulsive_graph(4);
+        repulsive_graph.add_link(0, 1, -1.);
+        graph.compute(50, 50);
+        repulsive_graph.compute(50, 50);
+        const auto get_distance = [] (const Graph& graph, const size_t i, const size_t j) {
+            return std::hypot(graph.nodes[i].x - graph.nodes[j].x, graph.nodes[i].y - graph.nodes[j].y);
+        };
+        if (get_distance(repulsive_graph, 0, 1) <= get_distance(graph, 0, 1)) {
+            except("Repulsive springs should push nodes apart");
+        }
+        // once normalized, missing links are springs too, as if every pair was linked
+        Graph normalized_graph(6), dense_graph(6);
+        normalized_graph.add_link(0, 1, -1.);
+        normalized_graph.add_link(2, 3, 1.);
+        normalized_graph.normalize_links();
+        dense_graph.k_spring = 1.;
+        for (size_t i = 0; i < 6; i++) {
+            for (size_t j = 0; j < i; j++) {
+                dense_graph.add_link(j, i, normalized_graph.get_link(i, j));
+            }
+        }
+        normalized_graph.compute(50, 50);
+        dense_graph.compute(50, 50);
+        for (size_t i = 0; i < 6; i++) {
+            if (std::abs(normalized_graph.nodes[i].x - dense_graph.nodes[i].x) > 1e-9 || std::abs(normalized_graph.nodes[i].y - dense_graph.nodes[i].y) > 1e-9) {
+                except("Missing links should act as springs once normalized");
+            }
+        }
+    }
+    logger.message("Repulsive & missing links are kept");
+
+    // Barnes-Hut repulsion matches the exact one
+    {
+        std::mt19937 generator(1);
+        std::normal_distribution<double> coordinate(0, 10);
+        std::vector<LinkRbrain::Graph::Node<double>> nodes;
+        for (size_t i = 0; i < 2000; i++) {
+            nodes.push_back({coordinate(generator), coordinate(generator), 0.5});
+        }
+        nodes.push_back(nodes[0]);
+        nodes.back().x += 1e-3;
+        LinkRbrain::Graph::QuadTree<double> quadtree;
+        quadtree.build(nodes);
+        for (const double theta : {0., 0.5, 1.}) {
+            double error_2 = 0., force_2 = 0.;
+            for (size_t i = 0; i < nodes.size(); i += 7) {
+                double exact_ax = 0., exact_ay = 0., ax = 0., ay = 0.;
+                for (size_t j = 0; j < nodes.size(); j++) {
+                    if (j != i) {
+                        quadtree.add_repulsion(nodes[i].x - nodes[j].x, nodes[i].y - nodes[j].y, 1.5, exact_ax, exact_ay);
+                    }
+                }
+                quadtree.add_repulsion(nodes, i, theta, 1.5, ax, ay);
+                error_2 += (ax - exact_ax) * (ax - exact_ax) + (ay - exact_ay) * (ay - exact_ay);
+                force_2 += exact_ax * exact_ax + exact_ay * exact_ay;
+            }
+            const double error = std::sqrt(error_2 / force_2);
+            if (error > 1e-9 + 0.05 * theta) {
+                except("Too large error on repulsion for theta =", theta, ":", error);
+            }
+            logger.debug("Relative error with theta =", theta, ":", error);
+        }
+    }
+    logger.message("Barnes-Hut approximates repulsion");
+
+    // threads give the same layout
+    {
+        Graph sequential_graph(600);
+        make_links(sequential_graph, 3);
+        sequential_graph.threads_count = 1;
+        sequential_graph.compute(50, 50);
+        // graphs computed concurrently share the pool, or fall back to sequential layout
+        std::vector<std::unique_ptr<Graph>> parallel_graphs;
+        std::vector<std::thread> threads;
+        for (size_t k = 0; k < 3; k++) {
+            parallel_graphs.emplace_back(new Graph(600));
+            make_links(*parallel_graphs.back(), 3);
+            parallel_graphs.back()->threads_count = 4;
+        }
+        for (auto& parallel_graph : parallel_graphs) {
+            threads.emplace_back([&parallel_graph] {
+                parallel_graph->compute(50, 50);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& parallel_graph : parallel_graphs) {
+            for (size_t i = 0; i < sequential_graph.count; i++) {
+                if (sequential_graph.nodes[i].x != parallel_graph->nodes[i].x || sequential_graph.nodes[i].y != parallel_graph->nodes[i].y) {
+                    except("Parallel layout differs at node", i);
+                }
+            }
+        }
+    }
+    logger.message("Parallel layouts are identical");
+
+    // final layouts are comparable
+    for (const size_t count : {50, 500}) {
+        Graph exact_graph(count);
+        Graph approximate_graph(count);
+        make_links(exact_graph, count);
+        make_links(approximate_graph, count);
+        size_t exact_iterations_count, approximate_iterations_count;
+        double exact_dt, approximate_dt;
+        const double exact_energy = compute_layout(exact_graph, Graph::Exact, exact_iterations_count, exact_dt);
+        const double approximate_energy = compute_layout(approximate_graph, Graph::BarnesHut, approximate_iterations_count, approximate_dt);
+        logger.message(count, "nodes, exact: energy", exact_energy, "after", exact_iterations_count, "iterations in", exact_dt, "s, Barnes-Hut: energy", approximate_energy, "after", approximate_iterations_count, "iterations in", approximate_dt, "s");
+        if (std::abs(approximate_energy - exact_energy) > 0.05 * exact_energy) {
+            except("Layouts should reach comparable energy");
+        }
+    }
+
+    // benchmark
+    for (const size_t count : {50, 500, 5000}) {
+        double dts[2];
+        for (const Graph::Repulsion repulsion : {Graph::Exact, Graph::BarnesHut}) {
+            Graph graph(count);
+            make_links(graph, 1);
+            graph.repulsion = repulsion;
+            const double t0 = Logging::Logger::get_millitime();
+            graph.compute(benchmark_iterations_count, benchmark_iterations_count);
+            dts[repulsion == Graph::BarnesHut] = (Logging::Logger::get_millitime() - t0) / benchmark_iterations_count;
+        }
+        logger.message(count, "nodes, time per iteration, exact:", dts[0], "s, Barnes-Hut:", dts[1], "s");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "Network/Server/HTTP/BufferChain.hpp"
+#include "Compression/Zlib/IStream.hpp"
+#include "Conversion/JSON.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <random>
+#include <sstream>
+#include <string>
+
+
+using Network::Server::HTTP::BufferChain;
+
+static const size_t correlations_count = 20000;
+static const size_t benchmark_iterations_count = 20;
+static const size_t mhd_buffer_size = 32 << 10;
+
+
+// what microhttpd does with the chain: read it piece by piece
+
+const std::string drain(BufferChain& chain, const size_t buffer_size) {
+    std::string result;
+    std::vector<char> buffer(buffer_size);
+    for (uint64_t position=0; ; ) {
+        const ssize_t size = BufferChain::read_callback(&chain, position, buffer.data(), buffer.size());
+        if (size == MHD_CONTENT_READER_END_OF_STREAM) {
+            break;
+        }
+        result.append(buffer.data(), size);
+        position += size;
+    }
+    return result;
+}
+
+const std::string expand(const std::string& compressed) {
+    std::istringstream compressed_stream(compressed);
+    Compression::Zlib::IStream expanded(compressed_stream);
+    return std::string(std::istreambuf_iterator<char>(expanded), std::istreambuf_iterator<char>());
+}
+
+// looks like what is sent by `Views::Queries`
+
+const Types::Variant make_correlations(const size_t count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> score(0, 1);
+    Types::Variant correlations;
+    correlations.set_vector();
+    for (size_t i=0; i<count; ++i) {
+        correlations.push_back({
+            {"group", {
+                {"id", (int64_t) i},
+                {"label", "Group \"#" + std::to_string(i) + "\"\n"},
+            }},
+            {"scores", {score(generator), score(generator), score(generator)}},
+            {"overall_score", score(generator)},
+        });
+    }
+    return {{"correlations", correlations}, {"is_computed", true}};
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("http");
+
+    // byte-for-byte equality with the serializer, for every chunk & read size
+    std::vector<Types::Variant> samples(7);
+    samples[1] = true;
+    samples[2] = (int64_t) -42;
+    samples[3] = 3.25;
+    samples[4] = "escaped \"\\\t\n\r string";
+    samples[5] = std::string(1000, 'x');
+    samples[6]["a"].push_back(1.5);
+    samples[6]["a"].push_back("b");
+    samples[6]["a"].push_back(Types::Variant());
+    samples[6]["c"]["d"] = false;
+    samples.push_back(make_correlations(100));
+    for (const auto& sample : samples) {
+        const std::string expected = Conversion::JSON::serialize(sample);
+        for (const size_t chunk_size : {1, 7, 64, 4096, 64 << 10}) {
+            BufferChain chain(chunk_size);
+            chain.write_json(sample);
+            if (chain.size() != expected.size() || chain.str() != expected) {
+                except("Chained serialization differs with chunks of", chunk_size, "bytes");
+            }
+            for (const size_t buffer_size : {1, 5, 4096}) {
+                if (drain(chain, buffer_size) != expected) {
+                    except("Reading with a buffer of", buffer_size, "bytes differs, with chunks of", chunk_size, "bytes");
+                }
+            }
+            BufferChain compressed_chain(4096);
+            compressed_chain.write_gzip(chain);
+            if (expand(drain(compressed_chain, 4096)) != expected) {
+                except("Compressing a chain differs with chunks of", chunk_size, "bytes");
+            }
+        }
+    }
+    logger.message("Chained serialization is identical to the serializer");
+
+    // benchmark on a large correlation result
+    const Types::Variant correlations = make_correlations(correlations_count);
+    std::vector<char> mhd_buffer(mhd_buffer_size);
+    size_t checksum = 0;
+    // previously: serialize into a stream, copy it with `str()`, then with MHD_RESPMEM_MUST_COPY
+    double t0 = Logging::Logger::get_millitime();
+    for (size_t i=0; i<benchmark_iterations_count; ++i) {
+        std::stringstream raw;
+        Conversion::JSON::serialize(raw, correlations);
+        const std::string contents = raw.str();
+        std::vector<char> copy(contents.begin(), contents.end());
+        checksum += copy.size();
+    }
+    const double stream_dt = Logging::Logger::get_millitime() - t0;
+    // now: serialize into chunks, which are read by microhttpd
+    t0 = Logging::Logger::get_millitime();
+    size_t size;
+    for (size_t i=0; i<benchmark_iterations_count; ++i) {
+        BufferChain chain;
+        chain.write_json(correlations);
+        size = chain.size();
+        for (uint64_t position=0; position<size; position+=mhd_buffer_size) {
+            BufferChain::read_callback(&chain, position, mhd_buffer.data(), mhd_buffer_size);
+        }
+        checksum -= size;
+    }
+    const double chain_dt = Logging::Logger::get_millitime() - t0;
+    if (checksum != 0) {
+        except("Benchmarked serializations differ in size");
+    }
+    // with compression, as done by the connection
+    t0 = Logging::Logger::get_millitime();
+    size_t compressed_size;
+    for (size_t i=0; i<benchmark_iterations_count; ++i) {
+        BufferChain chain;
+        chain.write_json(correlations);
+        BufferChain compressed_chain;
+        compressed_chain.write_gzip(chain);
+        compressed_size = compressed_chain.size();
+    }
+    const double gzip_dt = Logging::Logger::get_millitime() - t0;
+    logger.message(correlations_count, "correlations (", size, "bytes), stream:", stream_dt / benchmark_iterations_count, "s, chain:", chain_dt / benchmark_iterations_count, "s, gzip chain:", gzip_dt / benchmark_iterations_count, "s (", compressed_size, "bytes)");
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
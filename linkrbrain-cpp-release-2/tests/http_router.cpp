@@ -0,0 +1,218 @@
+#include "Network/Server/HTTP/Router.hpp"
+#include "Network/Server/HTTP/RoutingProcessor.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <regex>
+#include <string>
+#include <vector>
+
+
+using namespace Network::Server::HTTP;
+
+
+// routes registered by LinkRbrain::Controllers::HTTPController
+
+static const std::vector<std::string> resource_patterns = {
+    "/upload-target",
+    "/api/uploads",
+    "/api/points",
+    "/api/organs/(\\d+)",
+    "/api/organs",
+    "/api/datasets/(\\d+)",
+    "/api/datasets",
+    "/api/datasets/(\\d+)/groups/(\\d+)",
+    "/api/datasets/(\\d+)/groups",
+    "/api/queries",
+    "/api/queries/(\\d+)",
+    "/api/queries/(\\d+)/pdf",
+    "/api/jobs/(\\d+)",
+    "/api/users/(\\d+)",
+    "/api/users/me",
+    "/api/users",
+    "/api/tokens",
+    "/api/test",
+};
+static const std::vector<std::pair<std::string, std::string>> redirections = {
+    {"^/platform/?$", "/organs.html"},
+    {"^/platform/[\\w\\-]+$", "/platform.html"},
+    {"^/(\\w+)/?$", "/$1.html"},
+    {"^/(.+\\.css)$", "/css/$1"},
+    {"^/(.+\\.js)$", "/js/$1"},
+    {"^/(.+\\.json)$", "/json/$1"},
+    {"^/(.+\\.obj)$", "/obj/$1"},
+    {"^/(.+\\.jpg)$", "/images/$1"},
+    {"^/(.+\\.jpeg)$", "/images/$1"},
+    {"^/(.+\\.png)$", "/images/$1"},
+    {"^/(.+\\.gif)$", "/images/$1"},
+    {"^/(.+\\.ico)$", "/images/$1"},
+};
+static const std::vector<std::string> urls = {
+    "/", "", "/upload-target", "/api/uploads", "/api/uploads/", "/api/points",
+    "/api/organs", "/api/organs/", "/api/organs/12", "/api/organs/12/", "/api/organs/x12", "/api/organs/12x",
+    "/api/datasets/3", "/api/datasets", "/api/datasets/3/groups", "/api/datasets/3/groups/456", "/api/datasets/3/groups/456/x",
+    "/api/datasets//groups", "/api/queries", "/api/queries/7", "/api/queries/7/pdf", "/api/queries/7/pdf/", "/api/jobs/42",
+    "/api/jobs/", "/api/users/1", "/api/users/me", "/api/users/you", "/api/users", "/api/tokens", "/api/test", "/api",
+    "/platform", "/platform/", "/platform/my-query_1", "/platform/a/b", "/platform/a.b",
+    "/people", "/people/", "/people.html", "/upload", "/a-b",
+    "/style.css", "/css/style.css", "/.css", "/js/platform.js", "/json/organs.json", "/obj/brain.obj", "/brain/left.obj",
+    "/images/icons.png", "/favicon.ico", "/a/b/c.jpeg", "/picture.jpg", "/loading.gif", "/x.gif/y",
+};
+
+
+// reference: linear scan over regular expressions
+
+const size_t reference_find(const std::vector<std::regex>& regexes, const std::string& url, std::vector<std::string>& parameters, const size_t first_index=0) {
+    for (size_t index=first_index; index<regexes.size(); ++index) {
+        std::smatch matches;
+        if (std::regex_match(url, matches, regexes[index])) {
+            parameters.assign(matches.begin(), matches.end());
+            return index;
+        }
+    }
+    return Router<size_t>::npos;
+}
+
+void compare(const std::vector<std::string>& patterns, const Router<size_t>& router, const std::vector<std::regex>& regexes, const std::string& url, const size_t first_index=0) {
+    std::vector<std::string> parameters, expected_parameters;
+    const size_t index = router.find(url, parameters, first_index);
+    const size_t expected_index = reference_find(regexes, url, expected_parameters, first_index);
+    if (index != expected_index) {
+        except("URL", url, "should match pattern", expected_index, "instead of", index);
+    }
+    if (index != Router<size_t>::npos && parameters != expected_parameters) {
+        except("Wrong parameters for", url, "with", patterns[index]);
+    }
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("http");
+
+    // resources & redirection patterns are compiled into the trie
+    std::vector<std::string> redirection_patterns;
+    for (const auto& [pattern, replacement] : redirections) {
+        redirection_patterns.push_back(pattern);
+    }
+    for (const auto& patterns : {resource_patterns, redirection_patterns}) {
+        Router<size_t> router;
+        std::vector<std::regex> regexes;
+        for (const std::string& pattern : patterns) {
+            router.add(pattern, regexes.size());
+            regexes.push_back(std::regex(pattern));
+        }
+        if (router.get_compiled_count() != patterns.size()) {
+            except("Every pattern should have been compiled,", router.get_compiled_count(), "out of", patterns.size());
+        }
+        for (const std::string& url : urls) {
+            for (size_t first_index=0; first_index<patterns.size(); ++first_index) {
+                compare(patterns, router, regexes, url, first_index);
+            }
+        }
+    }
+    logger.message("Compiled routes match like regular expressions");
+
+    // patterns that cannot be compiled are kept as regular expressions, and priorities are kept
+    {
+        const std::vector<std::string> patterns = {
+            "/api/(?:a|b)/(\\d+)",
+            "/api/(\\w+)/(\\d+)",
+            "/api/a/\\d{3}",
+            "/api/a/(\\d+)",
+            "/(.*)",
+            "/files/(.+)",
+            "/files/\\w+\\.txt",
+        };
+        Router<size_t> router;
+        std::vector<std::regex> regexes;
+        for (const std::string& pattern : patterns) {
+            router.add(pattern, regexes.size());
+            regexes.push_back(std::regex(pattern));
+        }
+        if (router.get_compiled_count() != 4) {
+            except("Wrong number of compiled patterns:", router.get_compiled_count());
+        }
+        for (const char* url : {"/api/a/123", "/api/b/1", "/api/c/12", "/api/a/x", "/files/", "/files/a/b.txt", "/files/a.txt", "/", "/x/y"}) {
+            for (size_t first_index=0; first_index<patterns.size(); ++first_index) {
+                compare(patterns, router, regexes, url, first_index);
+            }
+        }
+    }
+    logger.message("Regular expressions are used as a fallback");
+
+    // replacements are formatted like with std::regex_replace
+    for (const auto& [pattern, replacement] : std::vector<std::pair<std::string, std::string>>{
+        {"/(\\w+)/(\\w+)", "/$2/$1"},
+        {"/(\\w+)/(\\w+)", "$&-$$1-$3-$"},
+        {"/(\\w+)/(\\w+)", "/$12/$01"},
+    }) {
+        const std::string url = "/first/second";
+        std::vector<std::string> parameters;
+        Router<size_t> router;
+        router.add(pattern, 0);
+        router.find(url, parameters);
+        const std::string expected = std::regex_replace(url, std::regex(pattern), replacement);
+        const std::string result = Router<size_t>::format(replacement, parameters);
+        if (result != expected) {
+            except("Replacement", replacement, "gives", result, "instead of", expected);
+        }
+    }
+    {
+        RoutingProcessor processor;
+        for (const auto& [pattern, replacement] : redirections) {
+            processor.add_redirection(pattern, replacement, Redirection::Invisible, true);
+        }
+        processor.add_redirection("^/old/(\\d+)$", "/new/$1", Redirection::Permanent, false);
+        for (const auto& [url, expected_url, expected_code] : std::vector<std::tuple<std::string, std::string, int>>{
+            {"/platform/", "/organs.html", 0},
+            {"/platform/query-1", "/platform.html", 0},
+            {"/people/", "/people.html", 0},
+            {"/brain/left.obj", "/obj/brain/left.obj", 0},
+            {"/a/b.jpeg", "/images/a/b.jpeg", 0},
+            {"/api/test", "/api/test", 0},
+            {"/old/12", "/old/12", 301},
+        }) {
+            Connection connection(nullptr, "GET", url);
+            processor.process(connection);
+            if (connection.request.url != expected_url || connection.response.code != expected_code) {
+                except("Wrong redirection for", url, ":", connection.request.url, connection.response.code);
+            }
+            if (expected_code && connection.response.headers["Location"] != "/new/12") {
+                except("Wrong location for", url);
+            }
+        }
+    }
+    logger.message("Redirections are applied");
+
+    // micro-benchmark, on the resources
+    {
+        Router<size_t> router;
+        std::vector<std::regex> regexes;
+        for (const std::string& pattern : resource_patterns) {
+            router.add(pattern, regexes.size());
+            regexes.push_back(std::regex(pattern));
+        }
+        const size_t iterations_count = 20000;
+        std::vector<std::string> parameters;
+        size_t checksum = 0;
+        double t0 = Logging::Logger::get_millitime();
+        for (size_t i=0; i<iterations_count; ++i) {
+            checksum += reference_find(regexes, urls[i % urls.size()], parameters);
+        }
+        const double regex_dt = Logging::Logger::get_millitime() - t0;
+        t0 = Logging::Logger::get_millitime();
+        for (size_t i=0; i<iterations_count; ++i) {
+            checksum -= router.find(urls[i % urls.size()], parameters);
+        }
+        const double router_dt = Logging::Logger::get_millitime() - t0;
+        if (checksum != 0) {
+            except("Benchmark results differ");
+        }
+        logger.message(iterations_count, "lookups among", resource_patterns.size(), "resources, regex:", regex_dt, "s, trie:", router_dt, "s");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
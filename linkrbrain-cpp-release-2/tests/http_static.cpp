@@ -0,0 +1,202 @@
+#include "Network/Server/HTTP/StaticProcessor.hpp"
+#include "Compression/Zlib/IStream.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+
+using namespace Network::Server::HTTP;
+
+
+// requests are processed directly, without going through a running server
+
+std::unique_ptr<Connection> get(StaticProcessor& processor, const std::string& url, const std::unordered_map<std::string, std::string>& headers={}) {
+    std::unique_ptr<Connection> connection = std::make_unique<Connection>(nullptr, "GET", url);
+    connection->request.headers = headers;
+    if (!processor.process(*connection)) {
+        connection->response.code = 404;
+    }
+    connection->compose_response();
+    return connection;
+}
+
+const std::string get_body(const Response& response) {
+    const std::string body = response.buffer ? *response.buffer : response.raw.str();
+    const auto it = response.headers.find("Content-Encoding");
+    if (it == response.headers.end()) {
+        return body;
+    }
+    if (it->second != "gzip") {
+        except("Unexpected content encoding:", it->second);
+    }
+    std::istringstream compressed_stream(body);
+    Compression::Zlib::IStream expanded(compressed_stream);
+    return std::string(std::istreambuf_iterator<char>(expanded), std::istreambuf_iterator<char>());
+}
+
+void write(const std::filesystem::path& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("http");
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "linkrbrain-test-static";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "folder");
+
+    // static files
+    std::string text;
+    for (int i=0; i<200; ++i) {
+        text += "Line #" + std::to_string(i) + " of a very compressible text\n";
+    }
+    write(directory / "text.txt", text);
+    write(directory / "tiny.js", "f()");
+    write(directory / "folder" / "index.html", "<html></html>");
+    StaticProcessor processor;
+    processor.add_path(directory);
+
+    // content negotiation
+    for (const auto& [accept_encoding, expected_encoding] : std::vector<std::pair<std::string, std::string>>{
+        {"", ""},
+        {"gzip", "gzip"},
+        {"deflate, gzip", "gzip"},
+        {"br;q=1.0, gzip;q=0.8, *;q=0.1", "gzip"},
+        {"gzip;q=0", ""},
+        {"identity", ""},
+        {"*", "gzip"},
+        {"*;q=0.5, gzip;q=0", ""},
+    }) {
+        const auto connection = get(processor, "/text.txt", {{"Accept-Encoding", accept_encoding}});
+        const Response& response = connection->response;
+        const auto it = response.headers.find("Content-Encoding");
+        const std::string encoding = (it == response.headers.end()) ? "" : it->second;
+        if (response.code != 200 || encoding != expected_encoding || get_body(response) != text) {
+            except("Wrong response for `Accept-Encoding: ", accept_encoding, "`, with encoding", encoding);
+        }
+        if (response.headers.at("Content-Type") != "text/plain" || response.headers.at("Vary") != "Accept-Encoding") {
+            except("Wrong headers for `Accept-Encoding: ", accept_encoding, "`");
+        }
+    }
+    // compression is skipped when useless
+    {
+        const auto connection = get(processor, "/tiny.js", {{"Accept-Encoding", "gzip"}});
+        if (connection->response.headers.count("Content-Encoding") || get_body(connection->response) != "f()") {
+            except("Tiny files should not be compressed");
+        }
+    }
+    // folders are served with their index, unknown files are not served
+    if (get_body(get(processor, "/folder")->response) != "<html></html>" || get(processor, "/nothing.txt")->response.code != 404) {
+        except("Wrong response for folder or missing file");
+    }
+    if (get(processor, "/../linkrbrain-test-static/text.txt")->response.code != 404) {
+        except("Files outside of the folders should not be served");
+    }
+    // buffers are shared between responses
+    if (get(processor, "/text.txt")->response.buffer.get() != get(processor, "/text.txt")->response.buffer.get()) {
+        except("Cached files should not be copied");
+    }
+    logger.message("Content negotiation works");
+
+    // ETags
+    {
+        const std::string etag = get(processor, "/text.txt")->response.headers.at("ETag");
+        const std::string gzip_etag = get(processor, "/text.txt", {{"Accept-Encoding", "gzip"}})->response.headers.at("ETag");
+        if (etag == gzip_etag) {
+            except("Each encoding should have its own ETag");
+        }
+        for (const auto& [if_none_match, accept_encoding, expected_code] : std::vector<std::tuple<std::string, std::string, int>>{
+            {etag, "", 304},
+            {"W/" + etag, "", 304},
+            {"\"other\", " + etag, "", 304},
+            {"*", "", 304},
+            {gzip_etag, "gzip", 304},
+            {etag, "gzip", 200},
+            {"\"other\"", "", 200},
+        }) {
+            const auto connection = get(processor, "/text.txt", {{"If-None-Match", if_none_match}, {"Accept-Encoding", accept_encoding}});
+            if (connection->response.code != expected_code) {
+                except("Expected", expected_code, "for `If-None-Match: ", if_none_match, "`, got", connection->response.code);
+            }
+            if (expected_code == 304 && (connection->response.buffer || connection->response.raw.tellp() || connection->response.headers.at("ETag").empty())) {
+                except("304 should have no body, but an ETag");
+            }
+        }
+        processor.set_client_caching(false);
+        if (get(processor, "/text.txt", {{"If-None-Match", etag}})->response.code != 200) {
+            except("ETags should be ignored without client caching");
+        }
+        processor.set_client_caching(true);
+    }
+    logger.message("ETags give 304");
+
+    // invalidation when the file is modified
+    {
+        const std::string etag = get(processor, "/text.txt")->response.headers.at("ETag");
+        const auto last_write_time = std::filesystem::last_write_time(directory / "text.txt");
+        write(directory / "text.txt", "modified");
+        std::filesystem::last_write_time(directory / "text.txt", last_write_time + std::chrono::seconds(1));
+        const auto connection = get(processor, "/text.txt", {{"If-None-Match", etag}, {"Accept-Encoding", "gzip"}});
+        if (connection->response.code != 200 || get_body(connection->response) != "modified" || connection->response.headers.at("ETag") == etag) {
+            except("Modified file should be served again");
+        }
+        std::filesystem::remove(directory / "text.txt");
+        if (get(processor, "/text.txt")->response.code != 404) {
+            except("Removed file should not be served anymore");
+        }
+    }
+    logger.message("Modified files are invalidated");
+
+    // without server caching, contents are only read by responses needing them
+    {
+        write(directory / "text.txt", text);
+        StaticProcessor uncached_processor;
+        uncached_processor.add_path(directory);
+        uncached_processor.set_server_caching(false);
+        const std::string gzip_etag = get(uncached_processor, "/text.txt", {{"Accept-Encoding", "gzip"}})->response.headers.at("ETag");
+        const auto connection = get(uncached_processor, "/text.txt", {{"If-None-Match", gzip_etag}, {"Accept-Encoding", "gzip"}});
+        if (connection->response.code != 304 || connection->response.buffer) {
+            except("Uncached file should give 304 without being read");
+        }
+        const auto first = get(uncached_processor, "/text.txt", {{"Accept-Encoding", "gzip"}});
+        const auto second = get(uncached_processor, "/text.txt");
+        if (get_body(first->response) != text || get_body(second->response) != text || first->response.buffer == second->response.buffer) {
+            except("Uncached file should be read for each response");
+        }
+        // the asset itself reads the file when its contents are first requested
+        const auto asset = StaticAsset::load(directory / "tiny.js", "text/javascript", 1 << 20);
+        write(directory / "tiny.js", "g()");
+        if (*asset->get_identity() != "g()" || asset->get_gzip()) {
+            except("Asset contents should be read lazily");
+        }
+    }
+    logger.message("Uncached files are read when needed");
+
+    // large files are sent from their descriptor
+    {
+        processor.set_max_buffered_size(16);
+        write(directory / "large.txt", text);
+        const auto connection = get(processor, "/large.txt", {{"Accept-Encoding", "gzip"}});
+        const Response& response = connection->response;
+        if (response.code != 200 || response.buffer || response.file_descriptor < 0 || response.file_size != text.size()) {
+            except("Large file should be sent from its descriptor");
+        }
+        std::string contents(text.size(), '\0');
+        if (pread(response.file_descriptor, contents.data(), contents.size(), 0) != (ssize_t) text.size() || contents != text) {
+            except("Wrong descriptor for large file");
+        }
+    }
+    logger.message("Large files are sent from their descriptor");
+
+    // the end!
+    std::filesystem::remove_all(directory);
+    logger.message("All tests passed");
+    return 0;
+}
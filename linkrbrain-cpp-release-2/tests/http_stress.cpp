@@ -0,0 +1,208 @@
+#include "Conversion/JSON.hpp"
+#include "Network/Server/HTTP/Server.hpp"
+#include "LinkRbrain/Scoring/Correlator.hpp"
+#include "LinkRbrain/Controllers/TokensController.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+typedef double T;
+typedef std::vector<std::vector<Types::Point<T>>> Query;
+static const uint16_t port = 8089;
+static const size_t server_threads_count = 8;
+static const size_t client_threads_count = 16;
+static const size_t requests_count = 200;
+static const size_t groups_count = 300;
+static const size_t queries_count = 32;
+static const size_t users_count = 20;
+static const int seed = 1;
+
+
+// what is shared between the server threads
+
+struct Context {
+    const LinkRbrain::Scoring::Correlator<T>& correlator;
+    std::vector<Query> queries;
+    LinkRbrain::Controllers::TokensController tokens;
+};
+
+void serialize_correlations(Context& context, const size_t query_index, Types::Variant& destination) {
+    const auto correlations = context.correlator.correlate(context.queries[query_index % queries_count], true, 10);
+    destination["labels"].set_vector();
+    destination["scores"].set_vector();
+    for (const auto& correlation : correlations) {
+        destination["labels"].push_back(correlation.group.get_label());
+        destination["scores"].push_back(correlation.overall_score);
+    }
+}
+
+class Correlations : public Network::Server::HTTP::ParametrizedResource<Context> {
+    using ParametrizedResource::ParametrizedResource;
+    virtual void GET(const Network::Server::HTTP::Request& request, Network::Server::HTTP::Response& response, Context& context) {
+        serialize_correlations(context, std::stoul(request.url_parameters[1]), response.data);
+    }
+};
+
+class Tokens : public Network::Server::HTTP::ParametrizedResource<Context> {
+    using ParametrizedResource::ParametrizedResource;
+    virtual void GET(const Network::Server::HTTP::Request& request, Network::Server::HTTP::Response& response, Context& context) {
+        LinkRbrain::Models::User user;
+        user.id = std::stoul(request.url_parameters[1]);
+        user.username = "user #" + request.url_parameters[1];
+        const std::string token = context.tokens.get_token(user);
+        response.data = {
+            {"token", token},
+            {"username", context.tokens.get_user(token).username}
+        };
+    }
+};
+
+
+// minimal HTTP/1.0 client, returning response code & body
+
+const std::pair<int, std::string> http_get(const std::string& url) {
+    const int socket_handle = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(socket_handle, (sockaddr*) &address, sizeof(address))) {
+        close(socket_handle);
+        except("Could not connect to server:", strerror(errno));
+    }
+    const std::string request = "GET " + url + " HTTP/1.0\r\n\r\n";
+    send(socket_handle, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t size;
+    while ((size = recv(socket_handle, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, size);
+    }
+    close(socket_handle);
+    const size_t body_offset = response.find("\r\n\r\n");
+    if (response.size() < 12 || body_offset == std::string::npos) {
+        except("Malformed response for", url, ":", response);
+    }
+    return {std::stoi(response.substr(9, 3)), response.substr(body_offset + 4)};
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("http");
+
+    // stub dataset, with its correlator & queries
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    LinkRbrain::Models::Dataset<T> dataset;
+    for (size_t g=0; g<groups_count; ++g) {
+        auto& group = dataset.add_group("group #" + std::to_string(g));
+        for (size_t p=0; p<20; ++p) {
+            group.add_point(x(generator), y(generator), z(generator), weight(generator));
+        }
+    }
+    LinkRbrain::Scoring::Correlator<T> correlator(dataset, 6.0, LinkRbrain::Scoring::Scorer::Sphere, 10.0);
+    correlator.compute_points_cache(LinkRbrain::Scoring::Caching::Memory);
+    Context context = {correlator};
+    for (size_t q=0; q<queries_count; ++q) {
+        context.queries.emplace_back(1 + q % 3);
+        for (auto& query_group : context.queries.back()) {
+            for (size_t p=0; p<10; ++p) {
+                query_group.push_back({x(generator), y(generator), z(generator), weight(generator)});
+            }
+        }
+    }
+
+    // expected responses are computed beforehand, in a single thread
+    std::vector<std::string> expected;
+    for (size_t q=0; q<queries_count; ++q) {
+        Types::Variant data;
+        serialize_correlations(context, q, data);
+        expected.push_back(Conversion::JSON::serialize(data));
+    }
+    correlator.get_results_cache().invalidate();
+
+    // in-process server, with a thread pool
+    Network::Server::HTTP::Server server;
+    server.set_port(port);
+    server.set_threading(server_threads_count);
+    server.set_debug(false);
+    server.set_resource_parameter(context);
+    server.add_resource<Correlations>("/correlations/(\\d+)");
+    server.add_resource<Tokens>("/tokens/(\\d+)");
+    server.start();
+    logger.message("Started server with", server_threads_count, "threads");
+
+    // fire concurrent requests
+    std::mutex tokens_mutex;
+    std::map<std::string, std::string> tokens;
+    std::atomic<size_t> errors_count(0);
+    const double t0 = Logging::Logger::get_millitime();
+    std::vector<std::thread> threads;
+    for (size_t t=0; t<client_threads_count; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 thread_generator(seed + t);
+            for (size_t i=0; i<requests_count; ++i) {
+                try {
+                    const size_t index = thread_generator();
+                    if (i % 4 == 0) {
+                        const std::string username = "user #" + std::to_string(index % users_count);
+                        const auto [code, body] = http_get("/tokens/" + std::to_string(index % users_count));
+                        Types::Variant data;
+                        std::istringstream body_stream(body);
+                        Conversion::JSON::parse(body_stream, data);
+                        if (code != 200 || data["username"].get_string() != username) {
+                            except("Wrong token response:", code, body);
+                        }
+                        // a user always gets the same token
+                        std::lock_guard<std::mutex> lock(tokens_mutex);
+                        const auto [it, is_inserted] = tokens.insert({username, data["token"].get_string()});
+                        if (it->second != data["token"].get_string()) {
+                            except("Different tokens were generated for", username);
+                        }
+                    } else if (i % 50 == 1) {
+                        if (http_get("/nothing/here").first != 404) {
+                            except("Unknown URL should give 404");
+                        }
+                    } else {
+                        const auto [code, body] = http_get("/correlations/" + std::to_string(index % queries_count));
+                        if (code != 200 || body != expected[index % queries_count]) {
+                            except("Wrong correlations response:", code, body);
+                        }
+                    }
+                } catch (const std::exception& error) {
+                    logger.error(error.what());
+                    ++errors_count;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double dt = Logging::Logger::get_millitime() - t0;
+    server.stop();
+    if (errors_count) {
+        except(errors_count, "requests failed");
+    }
+    if (tokens.size() != users_count) {
+        except("Expected", users_count, "distinct users, got", tokens.size());
+    }
+    logger.message("Performed", client_threads_count * requests_count, "concurrent requests in", dt, "s");
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
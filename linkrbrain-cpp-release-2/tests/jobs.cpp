@@ -0,0 +1,222 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Controllers/JobsController.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+using LinkRbrain::Controllers::JobsController;
+
+
+// fake computation, blocking until released
+
+struct Gate {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool is_open = false;
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return is_open; });
+    }
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_open = true;
+        }
+        condition.notify_all();
+    }
+};
+
+void wait_for_status(JobsController& jobs, const size_t id, const JobsController::Status status) {
+    for (int i=0; i<1000 && jobs.get_status(id) != status; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (jobs.get_status(id) != status) {
+        except("Job", id, "should be", JobsController::get_status_name(status), "instead of", JobsController::get_status_name(jobs.get_status(id)));
+    }
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("jobs");
+
+    // ordering: by decreasing priority, then by submission order
+    {
+        JobsController jobs(1, 16);
+        Gate gate;
+        std::mutex order_mutex;
+        std::vector<int> order;
+        const size_t blocker = jobs.submit([&gate] (const JobsController::Job&) { gate.wait(); });
+        wait_for_status(jobs, blocker, JobsController::Running);
+        for (const auto& [label, priority] : std::vector<std::pair<int, int>>{{1, 0}, {2, 5}, {3, 0}, {4, 5}, {5, -1}}) {
+            jobs.submit([&, label] (const JobsController::Job&) {
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(label);
+            }, priority);
+        }
+        if (jobs.get_queued_count() != 5 || jobs.get_status(blocker) != JobsController::Running) {
+            except("Jobs should be waiting for the running one");
+        }
+        gate.open();
+        jobs.wait();
+        if (order != std::vector<int>{2, 4, 1, 3, 5}) {
+            except("Jobs were not run by priority, then submission order");
+        }
+        Types::Variant serialized;
+        jobs.serialize(serialized, blocker);
+        if (serialized["status"].get_string() != "done" || !serialized.has("finished_at")) {
+            except("Finished job is not serialized properly:", Conversion::JSON::serialize(serialized));
+        }
+    }
+    logger.message("Jobs are run by priority, then submission order");
+
+    // failures are reported
+    {
+        JobsController jobs(2, 16);
+        const size_t id = jobs.submit([] (const JobsController::Job&) { throw Exceptions::BadDataException("Fake failure"); });
+        jobs.wait();
+        Types::Variant serialized;
+        jobs.serialize(serialized, id);
+        if (jobs.get_status(id) != JobsController::Failed || serialized["error"].get_string() != "Fake failure") {
+            except("Failed job should report its error");
+        }
+        try {
+            jobs.get_status(id + 1000);
+            except("Unknown job should not be found");
+        } catch (const Exceptions::NotFoundException&) {}
+    }
+    logger.message("Failures are reported");
+
+    // cancellation, of queued & running jobs
+    {
+        JobsController jobs(1, 16);
+        Gate gate;
+        std::atomic<bool> has_saved(false), has_run(false);
+        const size_t running = jobs.submit([&] (const JobsController::Job& job) {
+            gate.wait();
+            if (!job.is_cancelled()) {
+                has_saved = true;
+            }
+        });
+        const size_t queued = jobs.submit([&] (const JobsController::Job&) { has_run = true; });
+        wait_for_status(jobs, running, JobsController::Running);
+        if (!jobs.cancel(queued) || !jobs.cancel(running) || jobs.get_queued_count() != 0) {
+            except("Queued & running jobs should be cancellable");
+        }
+        gate.open();
+        jobs.wait();
+        if (has_run || has_saved || jobs.get_status(queued) != JobsController::Cancelled || jobs.get_status(running) != JobsController::Cancelled) {
+            except("Cancelled jobs should not have any effect");
+        }
+        if (jobs.cancel(running)) {
+            except("Finished jobs should not be cancellable");
+        }
+    }
+    logger.message("Jobs can be cancelled");
+
+    // backpressure: 503 when queue is full
+    {
+        JobsController jobs(1, 3);
+        Gate gate;
+        const size_t blocker = jobs.submit([&gate] (const JobsController::Job&) { gate.wait(); });
+        wait_for_status(jobs, blocker, JobsController::Running);
+        std::vector<size_t> ids;
+        for (size_t i=0; i<3; ++i) {
+            ids.push_back(jobs.submit([] (const JobsController::Job&) {}));
+        }
+        try {
+            jobs.submit([] (const JobsController::Job&) {});
+            except("Full queue should refuse jobs");
+        } catch (const Exceptions::GenericException& error) {
+            if (error.get_http_code() != 503) {
+                except("Full queue should answer with 503 instead of", error.get_http_code());
+            }
+        }
+        // cancelling frees a slot
+        jobs.cancel(ids[0]);
+        jobs.submit([] (const JobsController::Job&) {});
+        gate.open();
+        jobs.wait();
+    }
+    logger.message("Full queue refuses new jobs with 503");
+
+    // results of a job are not saved once the resource has been revised
+    {
+        JobsController jobs(2, 16);
+        Gate first_gate, second_gate;
+        std::mutex saved_mutex;
+        std::vector<int> saved;
+        const auto submit = [&] (Gate& gate, const int result) {
+            const size_t revision = jobs.revise("queries", 42, [] (const size_t) {});
+            return jobs.submit([&, revision, result] (const JobsController::Job&) {
+                gate.wait();
+                jobs.save_revision("queries", 42, revision, [&] {
+                    std::lock_guard<std::mutex> lock(saved_mutex);
+                    saved.push_back(result);
+                });
+            });
+        };
+        const size_t first = submit(first_gate, 1);
+        submit(second_gate, 2);
+        // the newer job finishes first, the older one must not overwrite it
+        second_gate.open();
+        const auto has_saved = [&] {
+            std::lock_guard<std::mutex> lock(saved_mutex);
+            return !saved.empty();
+        };
+        for (int i=0; i<1000 && !has_saved(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        first_gate.open();
+        jobs.wait();
+        if (saved != std::vector<int>{2} || jobs.get_status(first) != JobsController::Done) {
+            except("Only the job submitted for the last revision should save its results");
+        }
+        if (jobs.get_revision("queries", 42) != 2 || jobs.get_revision("queries", 43) != 0 || !jobs.save_revision("queries", 43, 0, [] {})) {
+            except("Revisions should be counted for each resource");
+        }
+        try {
+            jobs.revise("queries", 42, [] (const size_t revision) {
+                if (revision != 3) {
+                    except("Updates should be given the new revision");
+                }
+                throw std::runtime_error("Job not queued");
+            });
+        } catch (const std::runtime_error&) {}
+        if (jobs.get_revision("queries", 42) != 2) {
+            except("Failed updates should not revise the resource");
+        }
+    }
+    logger.message("Stale results are not saved");
+
+    // many concurrent submitters
+    {
+        JobsController jobs(4, 1000);
+        std::atomic<size_t> count(0);
+        std::vector<std::thread> threads;
+        for (size_t t=0; t<8; ++t) {
+            threads.emplace_back([&] {
+                for (size_t i=0; i<100; ++i) {
+                    jobs.submit([&count] (const JobsController::Job&) { ++count; }, i % 3);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        jobs.wait();
+        if (count != 800) {
+            except("Every job should have been run once, got", (size_t) count);
+        }
+    }
+    logger.message("Concurrent submissions are all processed");
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
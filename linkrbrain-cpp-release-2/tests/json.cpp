@@ -0,0 +1,238 @@
+#include "Conversion/JSON.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+
+static const size_t correlations_count = 20000;
+static const size_t benchmark_iterations_count = 10;
+
+
+// what the serializer used to do, kept as a reference for the benchmark
+
+void iostream_serialize(std::ostream& buffer, const Types::Variant& source) {
+    switch (source.get_type()) {
+        case Types::Variant::Floating:
+            buffer << source.get<Types::Variant::Floating>();
+            break;
+        case Types::Variant::Integer:
+            buffer << source.get<Types::Variant::Integer>();
+            break;
+        case Types::Variant::String:
+            buffer << '"';
+            for (const char c : source.get<Types::Variant::String>()) {
+                switch (c) {
+                    case '\n':
+                        buffer << "\\n";
+                        break;
+                    case '\\':
+                        buffer << "\\\\";
+                        break;
+                    case '"':
+                        buffer << "\\\"";
+                        break;
+                    default:
+                        buffer << c;
+                }
+            }
+            buffer << '"';
+            break;
+        case Types::Variant::Vector: {
+            buffer << '[';
+            bool is_first = true;
+            for (const auto& item : source.get<Types::Variant::Vector>()) {
+                if (is_first) is_first = false;
+                else buffer << ',';
+                iostream_serialize(buffer, item);
+            }
+            buffer << ']';
+            break;
+        }
+        case Types::Variant::Map: {
+            buffer << '{';
+            bool is_first = true;
+            for (const auto& [key, value] : source.get<Types::Variant::Map>()) {
+                if (is_first) is_first = false;
+                else buffer << ',';
+                buffer << '"' << key << "\":";
+                iostream_serialize(buffer, value);
+            }
+            buffer << '}';
+            break;
+        }
+        default:
+            buffer << "null";
+    }
+}
+
+const Types::Variant parse(const std::string& json) {
+    Types::Variant result;
+    Conversion::JSON::parse(json, result);
+    return result;
+}
+
+// looks like what is sent by `Views::Queries`
+
+const Types::Variant make_correlations(const size_t count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> score(0, 1);
+    Types::Variant correlations;
+    correlations.set_vector();
+    for (size_t i=0; i<count; ++i) {
+        correlations.push_back({
+            {"group", {
+                {"id", (int64_t) i},
+                {"label", "Group \"#" + std::to_string(i) + "\" of the dataset"},
+            }},
+            {"scores", {score(generator), score(generator), score(generator)}},
+            {"overall_score", score(generator)},
+        });
+    }
+    return {{"correlations", correlations}, {"is_computed", true}};
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("json");
+
+    // every single byte is escaped as required
+    for (int c=0; c<256; ++c) {
+        std::string expected;
+        switch (c) {
+            case '\b': expected = "\\b"; break;
+            case '\t': expected = "\\t"; break;
+            case '\n': expected = "\\n"; break;
+            case '\f': expected = "\\f"; break;
+            case '\r': expected = "\\r"; break;
+            case '"': expected = "\\\""; break;
+            case '\\': expected = "\\\\"; break;
+            default:
+                if (c < 0x20) {
+                    char sequence[8];
+                    snprintf(sequence, sizeof(sequence), "\\u%04x", c);
+                    expected = sequence;
+                } else {
+                    expected = std::string(1, (char) c);
+                }
+        }
+        const std::string source = "a" + std::string(1, (char) c) + "b";
+        const std::string json = Conversion::JSON::serialize(Types::Variant(source));
+        if (json != "\"a" + expected + "b\"") {
+            except("Byte", c, "is escaped as", json);
+        }
+        if (c < 0x80 && parse("[" + json + "]")[0].get_string() != source) {
+            except("Byte", c, "does not survive a round-trip");
+        }
+    }
+    for (const std::string source : {"", "plain", "été ☃ 𝄞", "\"\"\"", "\\\\", "\x01\x1f end", "unescaped run, then \n, then run again"}) {
+        if (parse("[" + Conversion::JSON::serialize(Types::Variant(source)) + "]")[0].get_string() != source) {
+            except("String", source, "does not survive a round-trip");
+        }
+    }
+    {
+        Types::Variant character;
+        character.emplace<Types::Variant::Character>('"');
+        if (Conversion::JSON::serialize(character) != "\"\\\"\"") {
+            except("Characters should be serialized as strings");
+        }
+    }
+    logger.message("Strings are escaped");
+
+    // numbers are written in their shortest form, which parses back to the same value
+    {
+        std::mt19937_64 generator(1);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::uniform_int_distribution<int> exponent(-300, 300);
+        std::vector<double> values = {0.1, 0.5, 1.0 / 3.0, -2.5, 1e-300, 1e300, 123456789.125, std::numeric_limits<double>::min(), std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min()};
+        for (size_t i=0; i<10000; ++i) {
+            values.push_back(uniform(generator) * std::pow(10.0, exponent(generator)));
+        }
+        for (const double value : values) {
+            const std::string json = Conversion::JSON::serialize(Types::Variant(value));
+            const Types::Variant parsed = parse("[" + json + "]")[0];
+            const double parsed_value = (parsed.get_type() == Types::Variant::Integer) ? (double) parsed.get<Types::Variant::Integer>() : parsed.get<Types::Variant::Floating>();
+            if (std::memcmp(&parsed_value, &value, sizeof(double))) {
+                except("Number", json, "does not survive a round-trip");
+            }
+        }
+        if (Conversion::JSON::serialize(Types::Variant(0.1)) != "0.1" || Conversion::JSON::serialize(Types::Variant(2.0)) != "2" || Conversion::JSON::serialize(Types::Variant(std::nan(""))) != "NaN") {
+            except("Numbers should be written in their shortest form");
+        }
+        for (const int64_t value : {(int64_t) 0, (int64_t) -1, (int64_t) 42, (int64_t) std::numeric_limits<int32_t>::min(), (int64_t) std::numeric_limits<int32_t>::max()}) {
+            if (parse(Conversion::JSON::serialize(Types::Variant({value})))[0].get<Types::Variant::Integer>() != value) {
+                except("Integer", value, "does not survive a round-trip");
+            }
+        }
+        if (Conversion::JSON::serialize(Types::Variant(std::numeric_limits<int64_t>::min())) != "-9223372036854775808") {
+            except("Wrong serialization for smallest integer");
+        }
+        // non-finite values are not JSON numbers, but must be read back by the parser
+        Types::Variant non_finite;
+        non_finite["a"] = std::numeric_limits<double>::infinity();
+        non_finite["b"] = -std::numeric_limits<double>::infinity();
+        non_finite["c"] = std::numeric_limits<double>::quiet_NaN();
+        const std::string non_finite_json = Conversion::JSON::serialize(non_finite);
+        if (non_finite_json != R"({"a":Infinity,"b":-Infinity,"c":NaN})") {
+            except("Wrong serialization for non-finite numbers:", non_finite_json);
+        }
+        const Types::Variant parsed_non_finite = parse(non_finite_json);
+        if (parsed_non_finite["a"].get<Types::Variant::Floating>() != std::numeric_limits<double>::infinity()
+            || parsed_non_finite["b"].get<Types::Variant::Floating>() != -std::numeric_limits<double>::infinity()
+            || !std::isnan(parsed_non_finite["c"].get<Types::Variant::Floating>())) {
+            except("Non-finite numbers do not survive a round-trip");
+        }
+    }
+    logger.message("Numbers survive a round-trip");
+
+    // whole documents, through strings and streams
+    {
+        const Types::Variant correlations = make_correlations(1000);
+        const std::string json = Conversion::JSON::serialize(correlations);
+        std::stringstream stream;
+        Conversion::JSON::serialize(stream, correlations);
+        if (stream.str() != json) {
+            except("Serializing to a string or a stream should be equivalent");
+        }
+        if (Conversion::JSON::serialize(parse(json)) != json) {
+            except("Document does not survive a round-trip");
+        }
+        Types::Variant date;
+        date = Types::DateTime("2019-03-04T05:06:07.000089");
+        std::stringstream date_stream;
+        date_stream << '"' << date.get<Types::Variant::DateTime>() << '"';
+        if (Conversion::JSON::serialize(date) != date_stream.str()) {
+            except("Dates should be serialized as before:", Conversion::JSON::serialize(date), "instead of", date_stream.str());
+        }
+    }
+    logger.message("Documents survive a round-trip");
+
+    // benchmark on a large correlation result
+    {
+        const Types::Variant correlations = make_correlations(correlations_count);
+        size_t iostream_size = 0, writer_size = 0;
+        double t0 = Logging::Logger::get_millitime();
+        for (size_t i=0; i<benchmark_iterations_count; ++i) {
+            std::stringstream buffer;
+            buffer.precision(17);
+            iostream_serialize(buffer, correlations);
+            iostream_size = buffer.str().size();
+        }
+        const double iostream_dt = (Logging::Logger::get_millitime() - t0) / benchmark_iterations_count;
+        t0 = Logging::Logger::get_millitime();
+        for (size_t i=0; i<benchmark_iterations_count; ++i) {
+            writer_size = Conversion::JSON::serialize(correlations).size();
+        }
+        const double writer_dt = (Logging::Logger::get_millitime() - t0) / benchmark_iterations_count;
+        logger.message(correlations_count, "correlations, iostream:", iostream_dt, "s (", iostream_size / iostream_dt / 1e6, "MB/s), writer:", writer_dt, "s (", writer_size / writer_dt / 1e6, "MB/s)");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
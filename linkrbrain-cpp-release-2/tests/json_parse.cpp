@@ -0,0 +1,198 @@
+#include "Conversion/JSON.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+
+static const std::filesystem::path suite_path = "tests/json";
+static const size_t points_count = 100000;
+static const size_t benchmark_iterations_count = 10;
+
+
+const std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+const bool is_accepted(const std::string& source, Types::Variant& destination, Conversion::JSON::Parser parser=Conversion::JSON::Parser()) {
+    try {
+        parser.parse(source, destination);
+        return true;
+    } catch (const Exceptions::BadDataException&) {
+        return false;
+    }
+}
+
+const Types::Variant parse(const std::string& source) {
+    Types::Variant result;
+    Conversion::JSON::parse(source, result);
+    return result;
+}
+
+// looks like what is received by `Views::Queries`
+
+const std::string make_query_body(const size_t count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> coordinate(-80, 80);
+    std::uniform_real_distribution<double> weight(0, 1);
+    std::ostringstream body;
+    body << "{\"groups\": [{\"label\": \"Query\", \"points\": [";
+    for (size_t i=0; i<count; ++i) {
+        body << (i ? ", " : "") << '[';
+        Conversion::JSON::serialize(body, coordinate(generator));
+        body << ", ";
+        Conversion::JSON::serialize(body, coordinate(generator));
+        body << ", ";
+        Conversion::JSON::serialize(body, coordinate(generator));
+        body << ", ";
+        Conversion::JSON::serialize(body, weight(generator));
+        body << ']';
+    }
+    body << "]}], \"settings\": {\"correlations\": {\"dataset\": {\"id\": 1}, \"limit\": 10}}}";
+    return body.str();
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("json");
+
+    // JSONTestSuite
+    size_t cases_count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(suite_path)) {
+        const std::string name = entry.path().filename();
+        if (entry.path().extension() != ".json") {
+            continue;
+        }
+        Types::Variant result;
+        const bool accepted = is_accepted(read_file(entry.path()), result);
+        if (name[0] == 'y' && !accepted) {
+            except("Valid case was rejected:", name);
+        }
+        if (name[0] == 'n' && accepted) {
+            except("Invalid case was accepted:", name, "as", Conversion::JSON::serialize(result));
+        }
+        ++cases_count;
+    }
+    if (cases_count == 0) {
+        except("No test case found in", suite_path);
+    }
+    logger.message("Passed", cases_count, "cases from JSONTestSuite");
+
+    // parsed values
+    {
+        const Types::Variant values = parse(R"([0, -0, 42, -9223372036854775808, 9223372036854775808, 1.5, -2.5e-3, 1E2, true, false, null, NaN, -Infinity])");
+        if (values[0].get<Types::Variant::Integer>() != 0 || values[2].get<Types::Variant::Integer>() != 42 || values[3].get<Types::Variant::Integer>() != std::numeric_limits<int64_t>::min()) {
+            except("Wrong integers");
+        }
+        if (values[4].get<Types::Variant::Floating>() != 9223372036854775808.0) {
+            except("Integers that do not fit should be read as floating point numbers");
+        }
+        if (values[5].get<Types::Variant::Floating>() != 1.5 || values[6].get<Types::Variant::Floating>() != -2.5e-3 || values[7].get<Types::Variant::Floating>() != 100.0) {
+            except("Wrong floating point numbers");
+        }
+        if (values[8].get<Types::Variant::Boolean>() != true || values[9].get<Types::Variant::Boolean>() != false || values[10].get_type() != Types::Variant::Null) {
+            except("Wrong literals");
+        }
+        if (!std::isnan(values[11].get<Types::Variant::Floating>()) || values[12].get<Types::Variant::Floating>() != -std::numeric_limits<double>::infinity()) {
+            except("Wrong non-finite numbers");
+        }
+        const Types::Variant strings = parse(R"(["a\"b\\c\/d\b\f\n\r\t", "é☃𝄞", "\ud800", "raw été", ""])");
+        if (strings[0].get_string() != "a\"b\\c/d\b\f\n\r\t") {
+            except("Wrong escapes:", strings[0]);
+        }
+        if (strings[1].get_string() != "é☃𝄞") {
+            except("Wrong unicode escapes:", strings[1]);
+        }
+        if (strings[2].get_string() != "\xed\xa0\x80" || strings[3].get_string() != "raw été" || strings[4].get_string() != "") {
+            except("Wrong strings");
+        }
+        const Types::Variant object = parse(R"({"a": {"b": [1, [2, [3, {}]], []]}, "a": 2, "c": {"": "empty"}})");
+        if (object.get<Types::Variant::Map>().size() != 2 || object["a"].get<Types::Variant::Integer>() != 2 || object["c"][""].get_string() != "empty") {
+            except("Wrong object:", object);
+        }
+    }
+    logger.message("Values are parsed as expected");
+
+    // written documents are read back identically
+    {
+        Types::Variant document;
+        document["label"] = "Group \"1\"\n\x01";
+        document["scores"].push_back(0.1);
+        document["scores"].push_back(1e300);
+        document["scores"].push_back((int64_t) -7);
+        document["scores"].push_back(std::numeric_limits<double>::infinity());
+        document["scores"].push_back(-std::numeric_limits<double>::infinity());
+        document["nested"]["empty"].set_vector();
+        document["nested"]["map"].set_map();
+        document["nested"]["null"] = Types::Variant();
+        const std::string json = Conversion::JSON::serialize(document);
+        if (Conversion::JSON::serialize(parse(json)) != json) {
+            except("Document does not survive a round-trip:", json);
+        }
+        const Types::Variant parsed = parse(json);
+        if (parsed["scores"][3].get<Types::Variant::Floating>() != std::numeric_limits<double>::infinity() || parsed["scores"][4].get<Types::Variant::Floating>() != -std::numeric_limits<double>::infinity()) {
+            except("Infinities do not survive a round-trip:", json);
+        }
+        Types::Variant nan;
+        nan = std::numeric_limits<double>::quiet_NaN();
+        if (!std::isnan(parse("[" + Conversion::JSON::serialize(nan) + "]")[0].get<Types::Variant::Floating>())) {
+            except("NaN does not survive a round-trip");
+        }
+        std::istringstream stream(json);
+        if (Conversion::JSON::serialize(Conversion::JSON::parse<Types::Variant>(stream)) != json) {
+            except("Parsing from a stream should be equivalent");
+        }
+    }
+    logger.message("Documents survive a round-trip");
+
+    // limits
+    {
+        Types::Variant result;
+        const std::string deep = std::string(1000, '[') + std::string(1000, ']');
+        if (is_accepted(deep, result)) {
+            except("Default depth limit was not enforced");
+        }
+        if (!is_accepted("[[[[]]]]", result, Conversion::JSON::Parser(4)) || is_accepted("[[[[[]]]]]", result, Conversion::JSON::Parser(4)) || is_accepted(R"([{"a": [{}]}])", result, Conversion::JSON::Parser(3))) {
+            except("Custom depth limit was not enforced");
+        }
+        if (!is_accepted("[1, 2, 3]", result, Conversion::JSON::Parser(4, 9)) || is_accepted("[1, 2, 3] ", result, Conversion::JSON::Parser(4, 9))) {
+            except("Size limit was not enforced");
+        }
+        try {
+            parse("[1, 2,, 3]");
+            except("Invalid document was accepted");
+        } catch (const Exceptions::BadDataException& error) {
+            if (error.get_http_code() != 400 || error.get_details()["offset"].get<Types::Variant::Integer>() != 6) {
+                except("Error should point at the offending character");
+            }
+        }
+    }
+    logger.message("Limits are enforced");
+
+    // benchmark on a large query
+    {
+        const std::string body = make_query_body(points_count);
+        Types::Variant query;
+        const double t0 = Logging::Logger::get_millitime();
+        for (size_t i=0; i<benchmark_iterations_count; ++i) {
+            Conversion::JSON::parse(body, query);
+        }
+        const double dt = (Logging::Logger::get_millitime() - t0) / benchmark_iterations_count;
+        if (query["groups"][0]["points"].get_vector().size() != points_count || query["groups"][0]["points"][points_count - 1].get_vector().size() != 4) {
+            except("Wrong parsed query");
+        }
+        logger.message(points_count, "points (", body.size(), "bytes) parsed in", dt, "s (", body.size() / dt / 1e6, "MB/s)");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,274 @@
+#include "LinkRbrain/Controllers/PdfController.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+
+using LinkRbrain::Controllers::PdfController;
+
+
+// fake computation, blocking until released
+
+struct Gate {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool is_open = false;
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return is_open; });
+    }
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_open = true;
+        }
+        condition.notify_all();
+    }
+};
+
+// looks like what `Views::QueriesPdf` describes
+
+const Types::Variant make_description(const int64_t query_id, const std::string& digest) {
+    Types::Variant description;
+    description["query"] = {{"id", query_id}, {"digest", digest}};
+    description["options"] = {{"correlations", true}, {"groups", true}, {"graph", false}};
+    return description;
+}
+
+// writes a tiny, valid document instead of the real report
+
+void render_synthetic(const std::filesystem::path& path, const Types::Variant& description) {
+    const std::string text = "Query " + std::to_string(description["query"]["id"].get<Types::Variant::Integer>());
+    const std::string stream = "BT /F1 12 Tf 72 720 Td (" + text + ") Tj ET";
+    std::ofstream file(path, std::ios::binary);
+    file << "%PDF-1.4\n"
+         << "1 0 obj << /Type /Catalog /Pages 2 0 R >> endobj\n"
+         << "2 0 obj << /Type /Pages /Kids [3 0 R] /Count 1 >> endobj\n"
+         << "3 0 obj << /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Contents 4 0 R >> endobj\n"
+         << "4 0 obj << /Length " << stream.size() << " >> stream\n" << stream << "\nendstream endobj\n"
+         << "trailer << /Root 1 0 R >>\n%%EOF\n";
+}
+
+const std::string get_status(PdfController& pdf, const std::string& id) {
+    Types::Variant status;
+    pdf.serialize(status, id);
+    return status["status"].get_string();
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("pdf");
+    const std::filesystem::path base_path = std::filesystem::temp_directory_path() / "linkrbrain_tests_pdf_render";
+    std::filesystem::remove_all(base_path);
+
+    // identifiers are stable and depend on the whole description
+    {
+        const std::string id = PdfController::compute_id(make_description(1, "0123456789abcdef"));
+        if (id.size() != 16 || id.find_first_not_of("0123456789abcdef") != std::string::npos) {
+            except("Identifiers should be 16 hexadecimal digits:", id);
+        }
+        if (id != PdfController::compute_id(make_description(1, "0123456789abcdef"))) {
+            except("Identifiers should not change");
+        }
+        if (id == PdfController::compute_id(make_description(1, "0123456789abcdee")) || id == PdfController::compute_id(make_description(2, "0123456789abcdef"))) {
+            except("Updated or different queries should have different identifiers");
+        }
+    }
+    logger.message("Identifiers address the description");
+
+    // a synthetic query rendered twice is only rendered once
+    {
+        PdfController pdf(base_path, 2, 4);
+        std::atomic<size_t> renders_count(0);
+        const Types::Variant description = make_description(42, "0123456789abcdef");
+        auto renderer = [&] (const std::filesystem::path& path) {
+            ++renders_count;
+            render_synthetic(path, description);
+        };
+        const std::string id = pdf.submit(description, renderer);
+        pdf.wait();
+        Types::Variant status;
+        pdf.serialize(status, id);
+        if (status["status"].get_string() != "done" || status["url"].get_string() != "/renders/" + id + ".pdf") {
+            except("Rendered document should be available:", Conversion::JSON::serialize(status));
+        }
+        const std::filesystem::path path = base_path / "renders" / (id + ".pdf");
+        if (!std::filesystem::is_regular_file(path) || std::filesystem::exists(path.string() + ".tmp")) {
+            except("Rendered document should be at its final path:", path);
+        }
+        if (pdf.submit(description, renderer) != id || get_status(pdf, id) != "done") {
+            except("Second render should be immediately available");
+        }
+        pdf.wait();
+        if (renders_count != 1 || pdf.get_renders_count() != 1 || pdf.get_cache_hits_count() != 1) {
+            except("Second render should be served from cache");
+        }
+        // still cached for another controller, e.g. after a restart
+        PdfController restarted_pdf(base_path);
+        restarted_pdf.submit(description, renderer);
+        if (renders_count != 1 || restarted_pdf.get_cache_hits_count() != 1) {
+            except("Cache should persist on disk");
+        }
+    }
+    logger.message("Rendered documents are served from cache");
+
+    // concurrent requests for the same document share a render
+    {
+        PdfController pdf(base_path, 2, 4);
+        Gate gate;
+        std::atomic<size_t> renders_count(0);
+        const Types::Variant description = make_description(43, "0123456789abcdef");
+        auto renderer = [&] (const std::filesystem::path& path) {
+            ++renders_count;
+            gate.wait();
+            render_synthetic(path, description);
+        };
+        const std::string id = pdf.submit(description, renderer);
+        for (int i=0; i<1000 && get_status(pdf, id) != "running"; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (get_status(pdf, id) != "running") {
+            except("Render should be running");
+        }
+        std::vector<std::thread> threads;
+        for (int t=0; t<8; ++t) {
+            threads.emplace_back([&] {
+                if (pdf.submit(description, renderer) != id) {
+                    except("Same description should give the same identifier");
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        gate.open();
+        pdf.wait();
+        if (renders_count != 1 || pdf.get_renders_count() != 1 || get_status(pdf, id) != "done") {
+            except("Concurrent requests should share a render");
+        }
+    }
+    logger.message("Concurrent requests are deduplicated");
+
+    // failures are reported, and can be retried
+    {
+        PdfController pdf(base_path, 1, 4);
+        const Types::Variant description = make_description(44, "0123456789abcdef");
+        const std::string id = pdf.submit(description, [] (const std::filesystem::path& path) {
+            std::ofstream(path) << "%PDF-";
+            throw Exceptions::Exception("Fake failure");
+        });
+        pdf.wait();
+        Types::Variant status;
+        pdf.serialize(status, id);
+        if (status["status"].get_string() != "failed" || status["error"].get_string() != "Fake failure") {
+            except("Failed render should report its error:", Conversion::JSON::serialize(status));
+        }
+        if (std::filesystem::exists(base_path / "renders" / (id + ".pdf")) || std::filesystem::exists(base_path / "renders" / (id + ".pdf.tmp"))) {
+            except("Failed render should not leave any file");
+        }
+        pdf.submit(description, [&] (const std::filesystem::path& path) { render_synthetic(path, description); });
+        pdf.wait();
+        if (get_status(pdf, id) != "done") {
+            except("Failed render should be retried");
+        }
+        try {
+            get_status(pdf, "0123456789abcdef");
+            except("Unknown render should not be found");
+        } catch (const Exceptions::NotFoundException&) {}
+    }
+    logger.message("Failures are reported");
+
+    // documents beyond the maximum age, then the least recently used ones, are removed
+    {
+        std::filesystem::remove_all(base_path);
+        const auto render = [] (PdfController& pdf, const int64_t query_id) {
+            const Types::Variant description = make_description(query_id, "0123456789abcdef");
+            const std::string id = pdf.submit(description, [&] (const std::filesystem::path& path) {
+                render_synthetic(path, description);
+            });
+            pdf.wait();
+            // file times are not precise enough to order renders done in a row
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return std::filesystem::exists(pdf.get_path(id));
+        };
+        const auto is_cached = [] (PdfController& pdf, const int64_t query_id) {
+            return std::filesystem::exists(pdf.get_path(PdfController::compute_id(make_description(query_id, "0123456789abcdef"))));
+        };
+        // room for two synthetic documents, of about 320 bytes each
+        const uintmax_t max_cache_size = 2 * 400;
+        PdfController pdf(base_path, 1, 4, max_cache_size);
+        render(pdf, 200);
+        render(pdf, 201);
+        // a cache hit makes 200 the most recently used, so 201 goes first
+        render(pdf, 200);
+        if (!render(pdf, 202) || !is_cached(pdf, 200) || is_cached(pdf, 201) || pdf.get_evictions_count() != 1) {
+            except("Least recently used document should be evicted");
+        }
+        // finished renders are not tracked anymore, so evicted ones are unknown
+        if (pdf.get_tracked_count() != 0) {
+            except("Finished renders should be forgotten, got", pdf.get_tracked_count());
+        }
+        try {
+            get_status(pdf, PdfController::compute_id(make_description(201, "0123456789abcdef")));
+            except("Evicted render should not be found");
+        } catch (const Exceptions::NotFoundException&) {}
+        // a single document larger than the cache is still served
+        PdfController tiny_pdf(base_path, 1, 4, 1);
+        if (!render(tiny_pdf, 203) || is_cached(tiny_pdf, 200) || is_cached(tiny_pdf, 202)) {
+            except("Last render should be kept, and only it");
+        }
+        // on start, older documents are removed
+        const std::filesystem::path path = tiny_pdf.get_path(PdfController::compute_id(make_description(203, "0123456789abcdef")));
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(2));
+        PdfController restarted_pdf(base_path, 1, 4, max_cache_size, std::chrono::hours(1));
+        if (std::filesystem::exists(path) || restarted_pdf.get_evictions_count() != 1) {
+            except("Expired document should be evicted on start");
+        }
+    }
+    logger.message("Cache is bounded in size & age");
+
+    // bounded queue
+    {
+        PdfController pdf(base_path, 1, 2);
+        Gate gate;
+        auto renderer = [&gate] (const std::filesystem::path& path) {
+            gate.wait();
+            std::ofstream(path) << "%PDF-";
+        };
+        // the first render must have left the queue before the others are submitted
+        const std::string id = pdf.submit(make_description(100, "0123456789abcdef"), renderer);
+        for (int i=0; i<1000 && get_status(pdf, id) != "running"; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (get_status(pdf, id) != "running") {
+            except("Render should be running");
+        }
+        size_t refused_count = 0;
+        for (int64_t i=1; i<6; ++i) {
+            try {
+                pdf.submit(make_description(100 + i, "0123456789abcdef"), renderer);
+            } catch (const Exceptions::UnavailableException&) {
+                ++refused_count;
+            }
+        }
+        gate.open();
+        pdf.wait();
+        if (refused_count != 3) {
+            except("Renders beyond the queue size should be refused, got", refused_count);
+        }
+    }
+    logger.message("Queue is bounded");
+
+    // the end!
+    std::filesystem::remove_all(base_path);
+    logger.message("All tests passed");
+    return 0;
+}
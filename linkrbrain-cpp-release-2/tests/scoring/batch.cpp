@@ -0,0 +1,140 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Correlator.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <random>
+#include <vector>
+
+
+typedef double T;
+typedef std::vector<std::vector<Types::Point<T>>> Query;
+static const size_t groups_count = 2000;
+static const size_t group_points_count = 20;
+static const size_t queries_count = 64;
+static const size_t shared_points_count = 300;
+static const T resolution = 4.0;
+static const T diameter = 10.0;
+static const int seed = 1;
+// batched correlation sums the same terms, in another order
+static const T tolerance = 1e-9;
+
+
+// queries pick their points in a common pool, so that they overlap
+
+const std::vector<Query> make_queries(std::mt19937& generator) {
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    std::vector<Types::Point<T>> pool;
+    for (size_t p=0; p<shared_points_count; ++p) {
+        pool.push_back({x(generator), y(generator), z(generator), weight(generator)});
+    }
+    std::uniform_int_distribution<size_t> pick(0, pool.size() - 1);
+    std::vector<Query> queries(queries_count);
+    for (size_t q=0; q<queries_count; ++q) {
+        queries[q].resize(1 + q % 3);
+        for (auto& query_group : queries[q]) {
+            for (size_t p=0; p<50; ++p) {
+                query_group.push_back(pool[pick(generator)]);
+            }
+        }
+    }
+    return queries;
+}
+
+void compare(const LinkRbrain::Scoring::ScoredGroupList<T>& result, const LinkRbrain::Scoring::ScoredGroupList<T>& expected, const size_t q) {
+    if (result.size() != expected.size() || result.get_count() != expected.get_count()) {
+        except("Result size differs for query", q);
+    }
+    for (size_t i=0; i<expected.size(); ++i) {
+        if (&result[i].group != &expected[i].group) {
+            except("Groups differ for query", q, "at rank", i);
+        }
+        for (size_t j=0; j<expected.get_count(); ++j) {
+            if (std::abs(result[i].scores[j] - expected[i].scores[j]) > tolerance * std::max<T>(1, std::abs(expected[i].scores[j]))) {
+                except("Scores differ for query", q, "at rank", i, ":", result[i].scores[j], "instead of", expected[i].scores[j]);
+            }
+        }
+    }
+}
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "linkrbrain-test-batch";
+    std::filesystem::create_directories(directory);
+
+    // generate dataset & cache
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    LinkRbrain::Models::Dataset<T> dataset;
+    for (size_t g=0; g<groups_count; ++g) {
+        auto& group = dataset.add_group("group #" + std::to_string(g));
+        for (size_t p=0; p<group_points_count; ++p) {
+            group.add_point(x(generator), y(generator), z(generator), weight(generator));
+        }
+    }
+    Correlator<T> correlator(dataset, resolution, Scorer::Sphere, diameter);
+    const std::vector<Query> queries = make_queries(generator);
+
+    // without cache, batches are correlated one query after another
+    const auto uncached = correlator.correlate_batch({queries[0], queries[1]}, false);
+    compare(uncached[1], correlator.correlate(queries[1], false), 1);
+
+    // batched correlations are equivalent to sequential ones, for every backend & setting
+    correlator.compute_points_cache(Caching::File, directory / "points_cache", Correlator<T>::Multithreading);
+    Caching::SparseFileScorerCache<T>::write(*correlator.get_points_cache(), correlator.get_density_map().get_size(), directory / "points_cache.sparse");
+    for (const auto caching_type : {Caching::File, Caching::Mmap, Caching::SparseFile}) {
+        correlator.load_points_cache(caching_type, directory / ((caching_type == Caching::SparseFile) ? "points_cache.sparse" : "points_cache"));
+        for (const bool use_interpolation : {false, true}) {
+            for (const size_t limit : {(size_t) -1, (size_t) 20}) {
+                std::vector<ScoredGroupList<T>> expected;
+                for (const auto& query : queries) {
+                    expected.push_back(correlator.correlate(query, limit != (size_t) -1, limit, false, use_interpolation));
+                }
+                correlator.get_results_cache().invalidate();
+                const std::vector<ScoredGroupList<T>> results = correlator.correlate_batch(queries, limit != (size_t) -1, limit, use_interpolation);
+                if (results.size() != queries_count) {
+                    except("Batch should return one result per query");
+                }
+                for (size_t q=0; q<queries_count; ++q) {
+                    compare(results[q], expected[q], q);
+                }
+            }
+        }
+        logger.message("Batched correlations are equivalent to sequential ones with", correlator.get_points_cache()->get_type_name());
+    }
+
+    // batched queries use, and fill, the results cache
+    correlator.load_points_cache(Caching::Mmap, directory / "points_cache");
+    correlator.correlate(queries[3], true, 20);
+    const size_t hits = correlator.get_results_cache().get_hits();
+    correlator.correlate_batch(queries, true, 20);
+    correlator.correlate(queries[5], true, 20);
+    if (correlator.get_results_cache().get_hits() != hits + 2) {
+        except("Batched correlations should share the results cache with single ones");
+    }
+
+    // benchmark
+    for (const auto caching_type : {Caching::File, Caching::Mmap}) {
+        correlator.load_points_cache(caching_type, directory / "points_cache");
+        double t0 = Logging::Logger::get_millitime();
+        for (const auto& query : queries) {
+            correlator.correlate(query, true, 20);
+        }
+        const double sequential_dt = Logging::Logger::get_millitime() - t0;
+        correlator.get_results_cache().invalidate();
+        t0 = Logging::Logger::get_millitime();
+        correlator.correlate_batch(queries, true, 20);
+        const double batch_dt = Logging::Logger::get_millitime() - t0;
+        correlator.get_results_cache().invalidate();
+        logger.message(queries_count, "overlapping queries with", correlator.get_points_cache()->get_type_name(), ", sequential:", sequential_dt, "s, batch:", batch_dt, "s");
+    }
+
+    // the end!
+    std::filesystem::remove_all(directory);
+    logger.message("All tests passed");
+    return 0;
+}
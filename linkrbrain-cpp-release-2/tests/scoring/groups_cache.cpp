@@ -0,0 +1,107 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Correlator.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <random>
+#include <vector>
+
+
+static const size_t groups_count = 300;
+static const size_t group_points_count = 30;
+static const size_t benchmark_groups_count = 20000;
+static const size_t benchmark_group_points_count = 40;
+static const double diameter = 10.0;
+static const int seed = 1;
+
+
+template <typename T>
+LinkRbrain::Models::Dataset<T> make_dataset(std::mt19937& generator, const size_t groups_count, const size_t group_points_count) {
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    LinkRbrain::Models::Dataset<T> dataset;
+    for (size_t g=0; g<groups_count; ++g) {
+        auto& group = dataset.add_group("group #" + std::to_string(g));
+        for (size_t p=0; p<group_points_count; ++p) {
+            group.add_point(x(generator), y(generator), z(generator), weight(generator));
+        }
+    }
+    return dataset;
+}
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    std::mt19937 generator(seed);
+
+    // compare matrix product with one cached correlation per group
+    {
+        const auto dataset = make_dataset<double>(generator, groups_count, group_points_count);
+        Correlator<double> correlator(dataset, 4.0, Scorer::Sphere, diameter);
+        correlator.compute_points_cache(Caching::Memory);
+        std::vector<std::vector<double>> expected;
+        for (const auto& group : correlator.get_dataset().get_groups()) {
+            const auto correlations = correlator.correlate({group.get_points()}, false);
+            expected.push_back({});
+            for (const auto& correlation : correlations) {
+                expected.back().push_back(correlation.scores[0]);
+            }
+        }
+        for (const size_t block_size : {1, 7, 64, 1000}) {
+            correlator.compute_groups_cache(Caching::Memory, "", 3, block_size);
+            for (size_t g=0; g<groups_count; ++g) {
+                const std::vector<double> result = correlator.get_groups_cache()->get_score_map(g);
+                for (size_t h=0; h<groups_count; ++h) {
+                    if (std::abs(result[h] - expected[g][h]) > 1e-9 * std::max(std::abs(expected[g][h]), 1.0)) {
+                        except("Groups cache differs at", g, h, "with blocks of", block_size, ":", result[h], "instead of", expected[g][h]);
+                    }
+                }
+            }
+        }
+        logger.message("Groups cache matches cached correlations");
+    }
+
+    // benchmark on a genes-sized dataset, with a synthetic points cache
+    {
+        const auto dataset = make_dataset<float>(generator, benchmark_groups_count, benchmark_group_points_count);
+        Correlator<float> correlator(dataset, 10.0, Scorer::Sphere, diameter);
+        correlator.load_points_cache(Caching::Memory, "");
+        std::uniform_real_distribution<float> score(0, 1);
+        std::vector<float> scores(benchmark_groups_count);
+        size_t points_count = 0;
+        for (auto& item : correlator.get_density_map()) {
+            if (* item.value) {
+                for (float& value : scores) {
+                    value = score(generator);
+                }
+                correlator.get_points_cache()->integrate(item.index, scores);
+                ++points_count;
+            }
+        }
+        logger.notice("Generated points cache with", points_count, "points and", benchmark_groups_count, "groups");
+        double t0 = Logging::Logger::get_millitime();
+        correlator.compute_groups_cache(Caching::Memory);
+        const double dt = Logging::Logger::get_millitime() - t0;
+        logger.message("Computed groups cache in", dt, "s");
+        // compare a few rows, and extrapolate duration of one correlation per group
+        const size_t sample_size = 100;
+        t0 = Logging::Logger::get_millitime();
+        for (size_t g=0; g<sample_size; ++g) {
+            const auto correlations = correlator.correlate({correlator.get_dataset().get_groups()[g].get_points()}, false);
+            const std::vector<float> result = correlator.get_groups_cache()->get_score_map(g);
+            for (size_t h=0; h<benchmark_groups_count; ++h) {
+                if (std::abs(result[h] - correlations[h].scores[0]) > 1e-3 * std::max(std::abs(correlations[h].scores[0]), 1.0f)) {
+                    except("Benchmark groups cache differs at", g, h);
+                }
+            }
+        }
+        const double legacy_dt = (Logging::Logger::get_millitime() - t0) * benchmark_groups_count / sample_size;
+        logger.message("One correlation per group would take about", legacy_dt, "s");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Scorer.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <random>
+#include <vector>
+
+
+typedef double T;
+static const size_t n = 10000;
+static const double diameter = 10.0;
+static const int seed = 1;
+
+
+// scoring as it was before kernels were introduced, with the mode switch inside the inner loop
+
+struct LegacyScorer {
+
+    LegacyScorer(const LinkRbrain::Scoring::Scorer::Mode mode, const double diameter) :
+        _mode(mode),
+        _diameter(diameter),
+        _diameter2(diameter * diameter) {}
+
+    inline const T score(const Types::Point<T>& p1, const Types::Point<T>& p2) {
+        if (_mode & 0x10) {
+            const T dx = p1.x - p2.x;
+            const T dy = p1.y - p2.y;
+            const T dz = p1.z - p2.z;
+            const T distance2 = dx*dx + dy*dy + dz*dz;
+            if (distance2 > _diameter2) return static_cast<T>(0.);
+            const T x = std::sqrt(distance2) / this->_diameter;
+            const T w = p1.weight * p2.weight;
+            const T w2 = std::sqrt(std::abs(w));
+            switch (_mode) {
+                case LinkRbrain::Scoring::Scorer::Distance:
+                    return (w<0 ? -w2 : w2) * (static_cast<T>(1.) - x);
+                case LinkRbrain::Scoring::Scorer::Sphere:
+                    return (w<0 ? -w2 : w2) * (static_cast<T>(0.5)*x * (x*x - static_cast<T>(3.0)) + static_cast<T>(1.0));
+            }
+        }
+        return static_cast<T>(NAN);
+    }
+    inline const T score(const std::vector<Types::Point<T>>& points1, const std::vector<Types::Point<T>>& points2) {
+        T result = static_cast<T>(0);
+        for (const Types::Point<T>& p1 : points1) {
+            for (const Types::Point<T>& p2 : points2) {
+                result += score(p1, p2);
+            }
+        }
+        return result;
+    }
+    inline const T autoscore(const std::vector<Types::Point<T>>& points) {
+        T result = static_cast<T>(0);
+        for (size_t i=0, n=points.size(); i<n; ++i) {
+            const T increment = score(points[i], points[i]);
+            if (!std::isnan(increment)) {
+                result += increment;
+            }
+            for (size_t j=i+1; j<n; ++j) {
+                const T increment = static_cast<T>(2.0) * score(points[i], points[j]);
+                if (!std::isnan(increment)) {
+                    result += increment;
+                }
+            }
+        }
+        return result;
+    }
+
+    LinkRbrain::Scoring::Scorer::Mode _mode;
+    double _diameter;
+    double _diameter2;
+};
+
+
+const std::vector<Types::Point<T>> make_points(std::mt19937& generator, const size_t count) {
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(-1, 1);
+    std::vector<Types::Point<T>> points;
+    for (size_t i=0; i<count; ++i) {
+        points.push_back({x(generator), y(generator), z(generator), weight(generator)});
+    }
+    return points;
+}
+
+
+int main(int argc, char const *argv[]) {
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+
+    // generate data
+    std::mt19937 generator(seed);
+    const auto points1 = make_points(generator, n);
+    const auto points2 = make_points(generator, n);
+    logger.notice("Generated two sets of", n, "points");
+
+    for (const auto mode : {LinkRbrain::Scoring::Scorer::Distance, LinkRbrain::Scoring::Scorer::Sphere}) {
+        LinkRbrain::Scoring::Scorer scorer(mode, diameter);
+        LegacyScorer legacy_scorer(mode, diameter);
+        const std::string mode_name = (mode == LinkRbrain::Scoring::Scorer::Distance) ? "Distance" : "Sphere";
+
+        // bit-exactness on single pairs
+        for (size_t i=0; i<n; ++i) {
+            const T a = legacy_scorer.score(points1[i], points2[i]);
+            const T b = scorer.score(points1[i], points2[i]);
+            const T c = scorer.score(points1[i], points1[(i + 1) % n]);
+            const T d = legacy_scorer.score(points1[i], points1[(i + 1) % n]);
+            if (memcmp(&a, &b, sizeof(T)) || memcmp(&c, &d, sizeof(T))) {
+                except("Scores differ at index", i, "in", mode_name, "mode:", a, "vs.", b);
+            }
+        }
+        logger.debug("Single pair scores are identical in", mode_name, "mode");
+
+        // bit-exactness on autoscore
+        const std::vector<Types::Point<T>> subset(points1.begin(), points1.begin() + 1000);
+        const T legacy_autoscore = legacy_scorer.autoscore(subset);
+        const T kernel_autoscore = scorer.autoscore(subset);
+        if (memcmp(&legacy_autoscore, &kernel_autoscore, sizeof(T))) {
+            except("Autoscores differ in", mode_name, "mode:", legacy_autoscore, "vs.", kernel_autoscore);
+        }
+        logger.debug("Autoscores are identical in", mode_name, "mode");
+
+        // throughput & bit-exactness on group versus group
+        double t0 = Logging::Logger::get_millitime();
+        const T legacy_score = legacy_scorer.score(points1, points2);
+        const double legacy_dt = Logging::Logger::get_millitime() - t0;
+        t0 = Logging::Logger::get_millitime();
+        const T kernel_score = scorer.score(points1, points2);
+        const double kernel_dt = Logging::Logger::get_millitime() - t0;
+        if (memcmp(&legacy_score, &kernel_score, sizeof(T))) {
+            except("Group scores differ in", mode_name, "mode:", legacy_score, "vs.", kernel_score);
+        }
+        const double pairs = (double) n * (double) n;
+        logger.message(mode_name, "mode, legacy scorer:", (size_t) (pairs / legacy_dt), "pairs/second");
+        logger.message(mode_name, "mode, kernel scorer:", (size_t) (pairs / kernel_dt), "pairs/second");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Caching/Manager.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <random>
+#include <thread>
+#include <vector>
+
+
+typedef double T;
+static const size_t groups_count = 1000;
+static const size_t points_count = 500;
+static const size_t threads_count = 4;
+static const int seed = 1;
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "linkrbrain-test-mmap-cache";
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path path = directory / "points_cache";
+
+    // write a cache with FileScorerCache, leaving some rows & the last ones empty
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<T> score(-1, 1);
+    const std::vector<LinkRbrain::Models::Group<T>> groups(groups_count);
+    {
+        std::shared_ptr<Caching::ScorerCache<T>> file_cache(Caching::Manager::make<T>(Caching::File, groups, path));
+        file_cache->clear();
+        std::vector<T> values(groups_count);
+        for (uint32_t point_hash=0; point_hash<points_count; ++point_hash) {
+            if (point_hash % 7 == 3) {
+                continue;
+            }
+            for (T& value : values) {
+                value = score(generator);
+            }
+            file_cache->integrate(point_hash, values);
+        }
+    }
+    logger.notice("Wrote", points_count, "points with FileScorerCache to", path.native());
+
+    // compare rows read by both backends
+    std::shared_ptr<Caching::ScorerCache<T>> file_cache(Caching::Manager::make<T>(Caching::File, groups, path));
+    std::shared_ptr<Caching::ScorerCache<T>> mmap_cache(Caching::Manager::make<T>(Caching::Mmap, groups, path));
+    std::vector<std::vector<T>> expected;
+    for (uint32_t point_hash=0; point_hash<points_count+10; ++point_hash) {
+        expected.push_back(file_cache->get_score_map(point_hash));
+        const std::vector<T> copy = mmap_cache->get_score_map(point_hash);
+        const std::span<const T> view = mmap_cache->view_score_map(point_hash);
+        if (copy != expected.back() || !std::equal(view.begin(), view.end(), expected.back().begin(), expected.back().end())) {
+            except("Rows differ for point", point_hash);
+        }
+    }
+    logger.message("MmapScorerCache returns the same rows as FileScorerCache");
+
+    // writing is forbidden
+    bool has_thrown = false;
+    try {
+        mmap_cache->integrate(0, expected[0]);
+    } catch (const Exceptions::Exception&) {
+        has_thrown = true;
+    }
+    if (!has_thrown) {
+        except("MmapScorerCache should be read-only");
+    }
+
+    // locking is optional, and may fail because of limits
+    dynamic_cast<Caching::MmapScorerCache<T>*>(mmap_cache.get())->lock(0, 16);
+
+    // concurrent readers
+    std::vector<std::thread> threads;
+    std::atomic<size_t> errors_count = 0;
+    for (size_t t=0; t<threads_count; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t r=0; r<20; ++r) {
+                for (uint32_t point_hash=t; point_hash<expected.size(); point_hash+=threads_count) {
+                    const std::span<const T> view = mmap_cache->view_score_map(point_hash);
+                    if (!std::equal(view.begin(), view.end(), expected[point_hash].begin(), expected[point_hash].end())) {
+                        ++errors_count;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (errors_count) {
+        except("Concurrent readers got", (size_t) errors_count, "wrong rows");
+    }
+    logger.message("Concurrent readers got identical rows");
+
+    // the end!
+    mmap_cache.reset();
+    file_cache.reset();
+    std::filesystem::remove_all(directory);
+    logger.message("All tests passed");
+    return 0;
+}
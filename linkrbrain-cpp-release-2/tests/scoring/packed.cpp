@@ -0,0 +1,116 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Models/Group.hpp"
+#include "LinkRbrain/Scoring/Scorer.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+
+static const size_t groups_count = 511;
+static const size_t group_points_count = 40;
+static const size_t repetitions = 20;
+static const double diameter = 10.0;
+static const int seed = 1;
+
+
+template <typename T>
+const std::vector<Types::Point<T>> make_points(std::mt19937& generator, const size_t count) {
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(-1, 1);
+    std::vector<Types::Point<T>> points;
+    for (size_t i=0; i<count; ++i) {
+        points.push_back({x(generator), y(generator), z(generator), weight(generator)});
+    }
+    return points;
+}
+
+template <typename T>
+void test_precision(Logging::Logger& logger, std::mt19937& generator, const T tolerance) {
+    using namespace LinkRbrain::Scoring;
+    const Kernels::InstructionSet best_instruction_set = Kernels::get_instruction_set();
+    for (const auto mode : {Scorer::Distance, Scorer::Sphere}) {
+        Scorer scorer(mode, diameter);
+        for (const size_t size : {0, 1, 7, 8, 9, 100, 1000}) {
+            // points are drawn in a small box, so that most pairs actually contribute
+            std::vector<Types::Point<T>> points1 = make_points<T>(generator, size);
+            std::vector<Types::Point<T>> points2 = make_points<T>(generator, size + 3);
+            for (auto& point : points1) { point.x /= 8; point.y /= 8; point.z /= 8; }
+            for (auto& point : points2) { point.x /= 8; point.y /= 8; point.z /= 8; }
+            const Types::PackedPoints<T> packed1(points1);
+            const Types::PackedPoints<T> packed2(points2);
+            const T expected = scorer.score(points1, points2);
+            for (int i=Kernels::Scalar; i<=best_instruction_set; ++i) {
+                const Kernels::InstructionSet instruction_set = (Kernels::InstructionSet) i;
+                const T result = scorer.score(packed1, packed2, instruction_set);
+                const T error = std::abs(result - expected) / std::max(std::abs(expected), static_cast<T>(1.));
+                if (error > tolerance) {
+                    except("Packed score differs with", Kernels::get_instruction_set_name(instruction_set), "for size", size, ":", result, "instead of", expected);
+                }
+            }
+        }
+    }
+    logger.message("Packed scores match scalar scores with", sizeof(T), "bytes floating point numbers");
+}
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    logger.notice("Detected instruction set:", Kernels::get_instruction_set_name(Kernels::get_instruction_set()));
+
+    // compare packed scoring with original scoring
+    std::mt19937 generator(seed);
+    test_precision<double>(logger, generator, 1e-9);
+    test_precision<float>(logger, generator, 1e-4);
+
+    // generate a functions-sized dataset
+    std::vector<LinkRbrain::Models::Group<double>> groups(groups_count);
+    for (auto& group : groups) {
+        for (const auto& point : make_points<double>(generator, group_points_count)) {
+            group.add_point(point);
+        }
+    }
+    std::deque<Types::PackedPoints<double>> packed_groups;
+    for (const auto& group : groups) {
+        packed_groups.emplace_back(group.get_points());
+    }
+    const std::vector<Types::Point<double>> query = make_points<double>(generator, group_points_count);
+    const Types::PackedPoints<double> packed_query(query);
+    const double pairs = (double) (repetitions * groups_count * group_points_count * group_points_count);
+    logger.notice("Generated", groups_count, "groups with", group_points_count, "points each");
+
+    // benchmark
+    Scorer scorer(Scorer::Sphere, diameter);
+    double t0 = Logging::Logger::get_millitime();
+    double expected = 0.0;
+    for (size_t r=0; r<repetitions; ++r) {
+        for (const auto& group : groups) {
+            expected += scorer.score(group.get_points(), query);
+        }
+    }
+    double dt = Logging::Logger::get_millitime() - t0;
+    logger.message("Array of structures:", (size_t) (pairs / dt), "pairs/second");
+    for (int i=Kernels::Scalar; i<=Kernels::get_instruction_set(); ++i) {
+        const Kernels::InstructionSet instruction_set = (Kernels::InstructionSet) i;
+        t0 = Logging::Logger::get_millitime();
+        double result = 0.0;
+        for (size_t r=0; r<repetitions; ++r) {
+            for (const auto& packed_group : packed_groups) {
+                result += scorer.score(packed_group, packed_query, instruction_set);
+            }
+        }
+        dt = Logging::Logger::get_millitime() - t0;
+        if (std::abs(result - expected) > 1e-9 * std::max(std::abs(expected), 1.0)) {
+            except("Benchmark results differ with", Kernels::get_instruction_set_name(instruction_set), ":", result, "instead of", expected);
+        }
+        logger.message("Packed,", Kernels::get_instruction_set_name(instruction_set) + ":", (size_t) (pairs / dt), "pairs/second");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
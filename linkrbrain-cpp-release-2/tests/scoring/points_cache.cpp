@@ -0,0 +1,67 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Correlator.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <random>
+#include <vector>
+
+
+typedef double T;
+static const size_t groups_count = 200;
+static const size_t group_points_count = 20;
+static const T resolution = 6.0;
+static const T diameter = 10.0;
+static const int seed = 1;
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+
+    // generate dataset
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    LinkRbrain::Models::Dataset<T> dataset;
+    for (size_t g=0; g<groups_count; ++g) {
+        auto& group = dataset.add_group("group #" + std::to_string(g));
+        for (size_t p=0; p<group_points_count; ++p) {
+            group.add_point(x(generator), y(generator), z(generator), weight(generator));
+        }
+    }
+    Correlator<T> correlator(dataset, resolution, Scorer::Sphere, diameter);
+    logger.notice("Generated dataset with", groups_count, "groups of", group_points_count, "points");
+
+    // compute reference cache
+    double t0 = Logging::Logger::get_millitime();
+    correlator.compute_points_cache(Caching::Memory, ".", Correlator<T>::Basic);
+    logger.message("Computed cache in basic mode in", Logging::Logger::get_millitime() - t0, "s");
+    std::vector<std::pair<size_t, std::vector<T>>> expected;
+    for (auto& item : correlator.get_density_map()) {
+        if (* item.value) {
+            expected.push_back({item.index, correlator.get_points_cache()->get_score_map(item.index)});
+        }
+    }
+
+    // compare with multithreaded cache, for various thread counts & block sizes
+    for (const size_t n_threads : {1, 3, 8}) {
+        for (const size_t block_size : {1, 7, 256}) {
+            t0 = Logging::Logger::get_millitime();
+            correlator.compute_points_cache(Caching::Memory, ".", Correlator<T>::Multithreading, n_threads, block_size);
+            const double dt = Logging::Logger::get_millitime() - t0;
+            for (const auto& [index, scores] : expected) {
+                const std::vector<T> result = correlator.get_points_cache()->get_score_map(index);
+                if (result.size() != scores.size() || memcmp(result.data(), scores.data(), scores.size() * sizeof(T))) {
+                    except("Cache contents differ at point index", index, "with", n_threads, "threads and blocks of", block_size);
+                }
+            }
+            logger.message("Computed identical cache with", n_threads, "threads and blocks of", block_size, "in", dt, "s");
+        }
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Correlator.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <random>
+#include <thread>
+#include <vector>
+
+
+typedef double T;
+static const size_t groups_count = 200;
+static const size_t group_points_count = 20;
+static const T resolution = 6.0;
+static const T diameter = 10.0;
+static const size_t threads_count = 8;
+static const size_t queries_count = 16;
+static const int seed = 1;
+
+
+typedef std::vector<std::vector<Types::Point<T>>> Query;
+
+const Query make_query(std::mt19937& generator, const size_t groups, const size_t points) {
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0.1, 1);
+    Query query(groups);
+    for (auto& query_group : query) {
+        for (size_t p=0; p<points; ++p) {
+            query_group.push_back({x(generator), y(generator), z(generator), weight(generator)});
+        }
+    }
+    return query;
+}
+
+void compare(const LinkRbrain::Scoring::ScoredGroupList<T>& result, const LinkRbrain::Scoring::ScoredGroupList<T>& expected) {
+    if (result.size() != expected.size()) {
+        except("Result size differs:", result.size(), "instead of", expected.size());
+    }
+    for (size_t i=0; i<expected.size(); ++i) {
+        if (&result[i].group != &expected[i].group || result[i].overall_score != expected[i].overall_score || result[i].scores != expected[i].scores) {
+            except("Results differ at rank", i);
+        }
+    }
+}
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    std::mt19937 generator(seed);
+
+    // keys ignore points order & null weights, but not settings, dataset or query groups order
+    Query query = make_query(generator, 2, 10);
+    const auto key = CorrelationResultCache<T>::compute_key(query, 1234, {10, 0});
+    Query shuffled = query;
+    std::shuffle(shuffled[0].begin(), shuffled[0].end(), generator);
+    shuffled[1].push_back({1, 2, 3, -0.0});
+    if (CorrelationResultCache<T>::compute_key(shuffled, 1234, {10, 0}) != key) {
+        except("Keys should not depend on points order or null weights");
+    }
+    if (CorrelationResultCache<T>::compute_key(query, 1234, {20, 0}) == key
+        || CorrelationResultCache<T>::compute_key(query, 1234, {10, 1}) == key
+        || CorrelationResultCache<T>::compute_key(query, 4321, {10, 0}) == key
+        || CorrelationResultCache<T>::compute_key({query[1], query[0]}, 1234, {10, 0}) == key) {
+        except("Keys should depend on settings, dataset and query groups order");
+    }
+    logger.message("Keys are canonical");
+
+    // colliding hashes do not share results
+    {
+        CorrelationResultCache<T> cache;
+        std::vector<Group<T>> groups(10);
+        cache.put(key, std::make_shared<const ScoredGroupList<T>>(groups, 1));
+        auto colliding_key = key;
+        colliding_key.query.back() ^= 1;
+        if (colliding_key.hash != key.hash || cache.get(colliding_key) || !cache.get(key)) {
+            except("Keys with the same hash but another query should not match");
+        }
+    }
+    logger.message("Keys with colliding hashes are told apart");
+
+    // eviction, in least recently used order; keys of the same size, for other datasets
+    std::vector<Group<T>> groups(100);
+    const auto make_result = [&groups] (const size_t count) {
+        return std::make_shared<const ScoredGroupList<T>>(groups, count);
+    };
+    const auto make_key = [&query] (const size_t k) {
+        return CorrelationResultCache<T>::compute_key(query, k, {10, 0});
+    };
+    const size_t entry_size = CorrelationResultCache<T>::compute_size(make_key(1), *make_result(1));
+    CorrelationResultCache<T> cache(3 * entry_size);
+    for (const uint64_t k : {1, 2, 3}) {
+        cache.put(make_key(k), make_result(1));
+    }
+    cache.get(make_key(1));
+    cache.put(make_key(4), make_result(1));
+    if (cache.get(make_key(2)) || !cache.get(make_key(1)) || !cache.get(make_key(3)) || !cache.get(make_key(4)) || cache.get_count() != 3 || cache.get_size() != 3 * entry_size) {
+        except("Least recently used entry should have been evicted");
+    }
+    cache.put(make_key(5), make_result(100));
+    if (cache.get(make_key(5)) || cache.get_count() != 3) {
+        except("Entries larger than the cache should not be stored");
+    }
+    cache.set_max_size(entry_size);
+    if (cache.get_count() != 1 || !cache.get(make_key(4))) {
+        except("Shrinking should only keep the most recently used entry");
+    }
+    if (cache.get_hits() != 5 || cache.get_misses() != 2) {
+        except("Unexpected counters:", cache.get_hits(), "hits and", cache.get_misses(), "misses");
+    }
+    cache.invalidate();
+    if (cache.get_count() || cache.get_size() || cache.get(make_key(4))) {
+        except("Invalidated cache should be empty");
+    }
+    logger.message("Eviction & invalidation work");
+
+    // generate dataset
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    LinkRbrain::Models::Dataset<T> dataset;
+    for (size_t g=0; g<groups_count; ++g) {
+        auto& group = dataset.add_group("group #" + std::to_string(g));
+        for (size_t p=0; p<group_points_count; ++p) {
+            group.add_point(x(generator), y(generator), z(generator), weight(generator));
+        }
+    }
+    Correlator<T> correlator(dataset, resolution, Scorer::Sphere, diameter);
+    auto& results_cache = correlator.get_results_cache();
+
+    // cached results are identical, and found through the correlator
+    double t0 = Logging::Logger::get_millitime();
+    const ScoredGroupList<T> expected = correlator.correlate(query, true, 20);
+    const double miss_dt = Logging::Logger::get_millitime() - t0;
+    t0 = Logging::Logger::get_millitime();
+    compare(correlator.correlate(shuffled, true, 20), expected);
+    const double hit_dt = Logging::Logger::get_millitime() - t0;
+    if (results_cache.get_hits() != 1 || results_cache.get_misses() != 1) {
+        except("Second correlation should have been a cache hit");
+    }
+    correlator.correlate(query, true, 10);
+    correlator.correlate(query, false);
+    if (results_cache.get_hits() != 1 || results_cache.get_misses() != 2) {
+        except("Other settings should not be cache hits, and unsorted results should not be cached");
+    }
+    logger.message("Correlation took", miss_dt, "s, and", hit_dt, "s from cache");
+
+    // computing caches changes results, so they are invalidated
+    correlator.compute_points_cache(Caching::Memory);
+    if (results_cache.get_count()) {
+        except("Results should be invalidated when computing points cache");
+    }
+    const ScoredGroupList<T> cached_expected = correlator.correlate(query, true, 20);
+    compare(correlator.correlate(query, true, 20), cached_expected);
+    logger.message("Results are invalidated along with correlator caches");
+
+    // concurrency
+    std::vector<Query> queries;
+    std::vector<std::shared_ptr<const ScoredGroupList<T>>> queries_results;
+    for (size_t q=0; q<queries_count; ++q) {
+        queries.push_back(make_query(generator, 1 + q % 3, 5));
+        queries_results.push_back(std::make_shared<const ScoredGroupList<T>>(correlator.correlate(queries.back(), true, 20)));
+    }
+    size_t result_size = 0;
+    for (size_t q=0; q<queries_count; ++q) {
+        result_size = std::max(result_size, CorrelationResultCache<T>::compute_size(CorrelationResultCache<T>::compute_key(queries[q], 0, {20}), *queries_results[q]));
+    }
+    CorrelationResultCache<T> shared_cache(queries_count / 2 * result_size);
+    std::vector<std::thread> threads;
+    for (size_t t=0; t<threads_count; ++t) {
+        threads.emplace_back([&, t] {
+            // skewed access, so that frequent queries stay in cache
+            std::mt19937 thread_generator(seed + t);
+            std::uniform_int_distribution<size_t> index(0, queries_count - 1);
+            for (size_t i=0; i<10000; ++i) {
+                const size_t q = std::min(index(thread_generator), index(thread_generator));
+                const auto key = CorrelationResultCache<T>::compute_key(queries[q], 0, {20});
+                const auto result = shared_cache.get(key);
+                if (!result) {
+                    shared_cache.put(key, queries_results[q]);
+                } else if (result != queries_results[q]) {
+                    except("Concurrent access returned a wrong result");
+                }
+                if (i % 2500 == 0) {
+                    shared_cache.invalidate();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (shared_cache.get_hits() + shared_cache.get_misses() != threads_count * 10000 || shared_cache.get_size() > shared_cache.get_max_size()) {
+        except("Inconsistent counters or size after concurrent access");
+    }
+    logger.message("Concurrent access:", shared_cache.get_hits(), "hits,", shared_cache.get_misses(), "misses");
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
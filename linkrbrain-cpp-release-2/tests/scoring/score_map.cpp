@@ -0,0 +1,149 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Correlator.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <atomic>
+#include <random>
+#include <vector>
+
+
+typedef float T;
+static const size_t groups_count = 20000;
+static const size_t points_count = 64;
+static const size_t queries_count = 100;
+static const size_t query_points_count = 10;
+static const int seed = 1;
+
+
+// count every allocation, to compare copying & viewing score maps
+
+static std::atomic<size_t> allocations_count = 0;
+
+void* operator new(size_t size) {
+    ++allocations_count;
+    void* pointer = malloc(size);
+    if (pointer == NULL) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+// not inlined, otherwise GCC sees `free` called on what `operator new` returned
+[[gnu::noinline]] void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+[[gnu::noinline]] void operator delete(void* pointer, size_t size) noexcept {
+    free(pointer);
+}
+
+
+void test_backend(Logging::Logger& logger, const LinkRbrain::Scoring::Caching::Type type, const std::filesystem::path& path, const bool integrate_values) {
+    using namespace LinkRbrain::Scoring;
+    const size_t small_groups_count = 5;
+    const std::vector<LinkRbrain::Models::Group<T>> groups(small_groups_count);
+    std::shared_ptr<Caching::ScorerCache<T>> cache(Caching::Manager::make<T>(type, groups, path));
+    cache->clear();
+    // fill every other point
+    for (uint32_t point_hash=0; point_hash<10; point_hash+=2) {
+        std::vector<T> values;
+        for (size_t g=0; g<small_groups_count; ++g) {
+            values.push_back(point_hash + 0.25 * g + 1);
+        }
+        if (integrate_values) {
+            for (size_t g=0; g<small_groups_count; ++g) {
+                cache->integrate(g, point_hash, values[g]);
+            }
+        } else {
+            cache->integrate(point_hash, values);
+        }
+    }
+    cache->flush();
+    // views must match copies, including for missing points
+    for (uint32_t point_hash=0; point_hash<12; ++point_hash) {
+        const std::vector<T> copy = cache->get_score_map(point_hash);
+        const std::span<const T> view = cache->view_score_map(point_hash);
+        if (view.size() != small_groups_count || copy.size() != small_groups_count) {
+            except("Wrong score map size with", cache->get_type_name(), "for point", point_hash);
+        }
+        for (size_t g=0; g<small_groups_count; ++g) {
+            const T expected = (point_hash % 2 || point_hash >= 10) ? 0 : (point_hash + 0.25 * g + 1);
+            if (view[g] != expected || copy[g] != expected) {
+                except("Wrong score with", cache->get_type_name(), "for point", point_hash, "and group", g, ":", view[g], "instead of", expected);
+            }
+        }
+    }
+    logger.message("Score map views match copies with", cache->get_type_name());
+}
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+
+    // every backend
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "linkrbrain-test-score-map";
+    std::filesystem::create_directories(directory);
+    test_backend(logger, Caching::Memory, "", false);
+    test_backend(logger, Caching::File, directory / "file_cache", false);
+    test_backend(logger, Caching::MappedFile, directory / "mapped_file_cache", true);
+    std::filesystem::remove_all(directory);
+
+    // genes-sized cache in memory
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<T> score(0, 1);
+    const std::vector<LinkRbrain::Models::Group<T>> groups(groups_count);
+    std::shared_ptr<Caching::ScorerCache<T>> cache(Caching::Manager::make<T>(Caching::Memory, groups));
+    std::vector<T> values(groups_count);
+    for (uint32_t point_hash=0; point_hash<points_count; ++point_hash) {
+        for (T& value : values) {
+            value = score(generator);
+        }
+        cache->integrate(point_hash, values);
+    }
+    std::vector<std::vector<uint32_t>> queries(queries_count);
+    std::uniform_int_distribution<uint32_t> point(0, points_count - 1);
+    for (auto& query : queries) {
+        for (size_t p=0; p<query_points_count * 8; ++p) {
+            query.push_back(point(generator));
+        }
+    }
+    logger.notice("Generated", queries_count, "queries of", query_points_count, "interpolated points on", groups_count, "groups");
+
+    // benchmark copies against views
+    ScoredGroupList<T> copy_result(groups, 1);
+    ScoredGroupList<T> view_result(groups, 1);
+    size_t a0 = allocations_count;
+    double t0 = Logging::Logger::get_millitime();
+    for (const auto& query : queries) {
+        for (const uint32_t point_hash : query) {
+            copy_result.increment_scores(0, cache->get_score_map(point_hash), 0.125);
+        }
+    }
+    const double copy_dt = Logging::Logger::get_millitime() - t0;
+    const size_t copy_allocations = allocations_count - a0;
+    a0 = allocations_count;
+    t0 = Logging::Logger::get_millitime();
+    for (const auto& query : queries) {
+        for (const uint32_t point_hash : query) {
+            view_result.increment_scores(0, cache->view_score_map(point_hash), 0.125);
+        }
+    }
+    const double view_dt = Logging::Logger::get_millitime() - t0;
+    const size_t view_allocations = allocations_count - a0;
+    for (size_t g=0; g<groups_count; ++g) {
+        if (copy_result[g].scores[0] != view_result[g].scores[0]) {
+            except("Scores differ for group", g);
+        }
+    }
+    logger.message("Copies:", (double) copy_allocations / queries_count, "allocations per query,", copy_dt / queries_count, "s per query");
+    logger.message("Views:", (double) view_allocations / queries_count, "allocations per query,", view_dt / queries_count, "s per query");
+    if (view_allocations) {
+        except("Viewing score maps should not allocate");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
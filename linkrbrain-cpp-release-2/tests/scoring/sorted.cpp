@@ -0,0 +1,128 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/ScoredGroupList.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <map>
+#include <random>
+#include <vector>
+
+
+typedef double T;
+static const size_t groups_count = 20000;
+static const size_t repetitions = 20;
+static const int seed = 1;
+
+
+// sorting as it was done before, with a multimap
+
+template <typename T>
+std::vector<const LinkRbrain::Scoring::ScoredGroup<T>*> legacy_sorted(const LinkRbrain::Scoring::ScoredGroupList<T>& list, const size_t limit=-1) {
+    std::multimap<T, const LinkRbrain::Scoring::ScoredGroup<T>*> sorted;
+    for (const auto& scored_group : list) {
+        if (scored_group.overall_score) {
+            sorted.insert({scored_group.overall_score, &scored_group});
+        }
+    }
+    size_t n = 0;
+    std::vector<const LinkRbrain::Scoring::ScoredGroup<T>*> result;
+    for (auto it=sorted.rbegin(); it!=sorted.rend(); ++it) {
+        if (++n > limit) {
+            break;
+        }
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+void compare(const LinkRbrain::Scoring::ScoredGroupList<T>& list, const size_t limit) {
+    const auto expected = legacy_sorted(list, limit);
+    const auto result = list.sorted(limit);
+    if (result.size() != expected.size()) {
+        except("Sorted lists sizes differ for limit", limit, ":", result.size(), "instead of", expected.size());
+    }
+    for (size_t i=0; i<result.size(); ++i) {
+        if (&result[i].group != &expected[i]->group || result[i].overall_score != expected[i]->overall_score || result[i].scores != expected[i]->scores) {
+            except("Sorted lists differ at position", i, "for limit", limit);
+        }
+    }
+}
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    std::mt19937 generator(seed);
+
+    // small lists, with many ties & zeros
+    std::vector<LinkRbrain::Models::Group<T>> groups(100);
+    std::uniform_int_distribution<int> few_values(-2, 5);
+    for (size_t r=0; r<50; ++r) {
+        ScoredGroupList<T> list(groups, 2);
+        for (auto& scored_group : list) {
+            scored_group.overall_score = few_values(generator);
+            scored_group.scores = {scored_group.overall_score, -scored_group.overall_score};
+        }
+        for (const size_t limit : {0, 1, 5, 17, 99, 100, 101, 1000, -1}) {
+            compare(list, limit);
+        }
+    }
+    // empty list
+    const std::vector<LinkRbrain::Models::Group<T>> no_groups;
+    compare(ScoredGroupList<T>(no_groups, 1), 0);
+    compare(ScoredGroupList<T>(no_groups, 1), 10);
+    logger.message("Sorted lists match multimap ordering, including ties and limits");
+
+    // undefined scores are kept, after all others
+    {
+        ScoredGroupList<T> list(groups, 1);
+        for (size_t i=0; i<list.size(); ++i) {
+            list[i].overall_score = (i % 3 == 0) ? NAN : few_values(generator);
+        }
+        for (const size_t limit : {0, 10, 100, -1}) {
+            const auto result = list.sorted(limit);
+            size_t expected_size = 0;
+            for (const auto& scored_group : list) {
+                expected_size += (scored_group.overall_score != 0);
+            }
+            if (result.size() != std::min(limit, expected_size)) {
+                except("Sorted list should keep undefined scores, got", result.size(), "groups instead of", std::min(limit, expected_size));
+            }
+            for (size_t i=1; i<result.size(); ++i) {
+                if (std::isnan(result[i-1].overall_score) ? !std::isnan(result[i].overall_score) : (result[i].overall_score > result[i-1].overall_score)) {
+                    except("Undefined scores should come last, at position", i, "for limit", limit);
+                }
+            }
+        }
+    }
+    logger.message("Undefined scores are sorted last");
+
+    // benchmark on a genes-sized list
+    std::vector<LinkRbrain::Models::Group<T>> many_groups(groups_count);
+    ScoredGroupList<T> list(many_groups, 1);
+    std::uniform_real_distribution<T> score(0, 1);
+    for (auto& scored_group : list) {
+        scored_group.overall_score = score(generator);
+        scored_group.scores[0] = scored_group.overall_score;
+    }
+    for (const size_t limit : {20, 1000, -1}) {
+        compare(list, limit);
+        double t0 = Logging::Logger::get_millitime();
+        for (size_t r=0; r<repetitions; ++r) {
+            legacy_sorted(list, limit);
+        }
+        const double legacy_dt = (Logging::Logger::get_millitime() - t0) / repetitions;
+        t0 = Logging::Logger::get_millitime();
+        for (size_t r=0; r<repetitions; ++r) {
+            list.sorted(limit);
+        }
+        const double dt = (Logging::Logger::get_millitime() - t0) / repetitions;
+        logger.message("Sorting", groups_count, "groups with limit", (limit == (size_t) -1) ? std::string("none") : std::to_string(limit), "took", 1e3 * dt, "ms instead of", 1e3 * legacy_dt, "ms");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
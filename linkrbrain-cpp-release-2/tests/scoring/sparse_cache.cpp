@@ -0,0 +1,169 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Scoring/Correlator.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <fstream>
+#include <random>
+#include <vector>
+
+
+typedef double T;
+static const size_t groups_count = 300;
+static const size_t group_points_count = 20;
+static const size_t queries_count = 20;
+static const T resolution = 4.0;
+static const T diameter = 10.0;
+static const int seed = 1;
+// scores are quantized on 16 bits, relatively to the largest score of each point; as a query sums
+// scores over at most a few dozen points, correlations should stay within this relative tolerance
+static const T tolerance = 1e-3;
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "linkrbrain-test-sparse-cache";
+    std::filesystem::create_directories(directory);
+
+    // generate dataset & dense cache
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<T> x(-68, 70), y(-108, 68), z(-70, 78), weight(0, 1);
+    LinkRbrain::Models::Dataset<T> dataset;
+    for (size_t g=0; g<groups_count; ++g) {
+        auto& group = dataset.add_group("group #" + std::to_string(g));
+        for (size_t p=0; p<group_points_count; ++p) {
+            group.add_point(x(generator), y(generator), z(generator), weight(generator));
+        }
+    }
+    Correlator<T> correlator(dataset, resolution, Scorer::Sphere, diameter);
+    correlator.compute_points_cache(Caching::File, directory / "points_cache");
+    const size_t points_count = correlator.get_density_map().get_size();
+    logger.notice("Computed dense cache for", points_count, "points");
+
+    // compact it
+    Caching::SparseFileScorerCache<T>::write(*correlator.get_points_cache(), points_count, directory / "points_cache.sparse");
+    const size_t dense_size = std::filesystem::file_size(directory / "points_cache");
+    const size_t sparse_size = std::filesystem::file_size(directory / "points_cache.sparse");
+    logger.message("Dense cache takes", dense_size, "bytes, sparse cache takes", sparse_size, "bytes");
+
+    // round trip: every score within half a quantization step
+    std::shared_ptr<Caching::ScorerCache<T>> sparse_cache(Caching::Manager::make<T>(Caching::SparseFile, dataset.get_groups(), directory / "points_cache.sparse"));
+    std::vector<uint32_t> indices;
+    std::vector<T> values;
+    for (uint32_t point_hash=0; point_hash<points_count+3; ++point_hash) {
+        const std::vector<T> expected = correlator.get_points_cache()->get_score_map(point_hash);
+        const std::vector<T> result = sparse_cache->get_score_map(point_hash);
+        T max = 0;
+        for (const T& value : expected) {
+            max = std::max(max, std::abs(value));
+        }
+        const T step = max / std::numeric_limits<int16_t>::max();
+        for (size_t g=0; g<groups_count; ++g) {
+            if (std::abs(result[g] - expected[g]) > 0.5 * step * (1 + 1e-9)) {
+                except("Score differs for point", point_hash, "and group", g, ":", result[g], "instead of", expected[g]);
+            }
+        }
+        sparse_cache->get_sparse_score_map(point_hash, indices, values);
+        for (size_t i=0; i<indices.size(); ++i) {
+            if (values[i] == 0 || result[indices[i]] != values[i] || (i && indices[i] <= indices[i - 1])) {
+                except("Sparse score map is inconsistent for point", point_hash);
+            }
+        }
+    }
+    logger.message("Round trip is within half a quantization step");
+
+    // correlations with both caches
+    std::vector<std::vector<std::vector<Types::Point<T>>>> queries(queries_count);
+    for (auto& query : queries) {
+        query.push_back({});
+        for (size_t p=0; p<10; ++p) {
+            query.back().push_back({x(generator), y(generator), z(generator), weight(generator)});
+        }
+    }
+    std::vector<ScoredGroupList<T>> expected;
+    for (const auto& query : queries) {
+        expected.push_back(correlator.correlate(query, false));
+    }
+    correlator.load_points_cache(Caching::SparseFile, directory / "points_cache.sparse");
+    for (size_t q=0; q<queries_count; ++q) {
+        const ScoredGroupList<T> result = correlator.correlate(queries[q], false);
+        T max = 0;
+        for (const auto& scored_group : expected[q]) {
+            max = std::max(max, std::abs(scored_group.scores[0]));
+        }
+        for (size_t g=0; g<groups_count; ++g) {
+            if (std::abs(result[g].scores[0] - expected[q][g].scores[0]) > tolerance * max) {
+                except("Correlation differs for query", q, "and group", g, ":", result[g].scores[0], "instead of", expected[q][g].scores[0]);
+            }
+        }
+    }
+    logger.message("Sparse correlations are within", tolerance, "of the largest dense score");
+
+    // truncated or corrupted files are rejected, either when mapped or when a row is read
+    {
+        std::ifstream source(directory / "points_cache.sparse", std::ios::binary);
+        const std::string contents((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+        const size_t table_offset = Caching::SparseFileScorerCache<T>::header_size;
+        const size_t data_offset = table_offset + (points_count + 1) * sizeof(Caching::SparseFileScorerCache<T>::TableEntry);
+        const auto expect_bad_data = [&] (const std::string& description, const std::string& corrupted_contents, const bool when_reading) {
+            std::ofstream(directory / "corrupted.sparse", std::ios::binary) << corrupted_contents;
+            try {
+                Caching::SparseFileScorerCache<T> cache(dataset.get_groups(), directory / "corrupted.sparse");
+                if (!when_reading) {
+                    except("Sparse cache should not be mapped from file", description);
+                }
+                for (uint32_t point_hash=0; point_hash<points_count; ++point_hash) {
+                    cache.get_sparse_score_map(point_hash, indices, values);
+                }
+                except("Sparse cache should not be read from file", description);
+            } catch (const Exceptions::BadDataException&) {
+            }
+        };
+        expect_bad_data("with truncated header", contents.substr(0, 100), false);
+        expect_bad_data("with truncated table", contents.substr(0, data_offset - 1), false);
+        expect_bad_data("with truncated data", contents.substr(0, contents.size() - 1), false);
+        std::string corrupted_contents = contents;
+        const uint64_t offset = -1;
+        memcpy(corrupted_contents.data() + table_offset, &offset, sizeof(offset));
+        expect_bad_data("with an offset out of bounds", corrupted_contents, false);
+        corrupted_contents = contents;
+        std::fill(corrupted_contents.begin() + data_offset, corrupted_contents.end(), '\xff');
+        expect_bad_data("with corrupted rows", corrupted_contents, true);
+    }
+    logger.message("Corrupted sparse caches are rejected");
+
+    // scores that are not finite are stored as zeros, and short writes are reported
+    {
+        Caching::MemoryScorerCache<T> memory_cache(dataset.get_groups());
+        std::vector<T> row(groups_count, 0);
+        row[0] = NAN;
+        row[1] = INFINITY;
+        row[2] = 0.5;
+        memory_cache.integrate(0, row);
+        Caching::SparseFileScorerCache<T>::write(memory_cache, 1, directory / "not_finite.sparse");
+        Caching::SparseFileScorerCache<T> cache(dataset.get_groups(), directory / "not_finite.sparse");
+        const std::vector<T> decoded = cache.get_score_map(0);
+        if (decoded[0] != 0 || decoded[1] != 0 || std::abs(decoded[2] - 0.5) > tolerance) {
+            except("Scores that are not finite should be stored as zeros, got", decoded[0], decoded[1], decoded[2]);
+        }
+        if (std::filesystem::exists("/dev/full")) {
+            try {
+                Caching::SparseFileScorerCache<T>::write(*correlator.get_points_cache(), points_count, "/dev/full");
+                except("Writing to a full device should fail");
+            } catch (const Exceptions::Exception& error) {
+                if (std::string(error.what()).find("Could not write") == std::string::npos) {
+                    throw;
+                }
+            }
+        }
+    }
+    logger.message("Scores that are not finite are dropped, short writes fail");
+
+    // the end!
+    std::filesystem::remove_all(directory);
+    logger.message("All tests passed");
+    return 0;
+}
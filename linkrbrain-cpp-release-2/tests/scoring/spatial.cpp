@@ -0,0 +1,102 @@
+#include "Conversion/JSON.hpp"
+#include "LinkRbrain/Models/Group.hpp"
+#include "LinkRbrain/Scoring/Scorer.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+
+static const size_t groups_count = 20000;
+static const double diameter = 10.0;
+static const int seed = 1;
+
+
+const std::vector<Types::Point<double>> make_points(std::mt19937& generator, const size_t count, const double scale=1.0) {
+    std::uniform_real_distribution<double> x(-68, 70), y(-108, 68), z(-70, 78), weight(-1, 1);
+    std::vector<Types::Point<double>> points;
+    for (size_t i=0; i<count; ++i) {
+        points.push_back({scale * x(generator), scale * y(generator), scale * z(generator), weight(generator)});
+    }
+    return points;
+}
+
+
+int main(int argc, char const *argv[]) {
+    using namespace LinkRbrain::Scoring;
+
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("scoring");
+    std::mt19937 generator(seed);
+
+    // compare grid scoring with brute force scoring, on sparse, dense & empty clouds
+    for (const auto mode : {Scorer::Distance, Scorer::Sphere}) {
+        Scorer scorer(mode, diameter);
+        for (const double scale : {1.0, 0.1}) {
+            for (const size_t size : {0, 1, 10, 1000, 5000}) {
+                const auto points1 = make_points(generator, size, scale);
+                const auto points2 = make_points(generator, size + 7, scale);
+                const double expected = scorer.score(points1, points2);
+                const double result = scorer.score(
+                    SpatialBucketIndex<double>(points1, diameter),
+                    SpatialBucketIndex<double>(points2, diameter)
+                );
+                if (std::abs(result - expected) > 1e-9 * std::max(std::abs(expected), 1.0)) {
+                    except("Grid score differs for size", size, "and scale", scale, ":", result, "instead of", expected);
+                }
+            }
+        }
+    }
+    // distant groups are pruned without looking at cells
+    const std::vector<Types::Point<double>> left = {{-60, 0, 0, 1}, {-55, 0, 0, 1}};
+    const std::vector<Types::Point<double>> right = {{60, 0, 0, 1}, {55, 0, 0, 1}};
+    if (!SpatialBucketIndex<double>(left, diameter).is_out_of_range(SpatialBucketIndex<double>(right, diameter), diameter)) {
+        except("Distant groups should be out of range");
+    }
+    logger.message("Grid scores match brute force scores");
+
+    // generate a genes-sized dataset
+    std::vector<LinkRbrain::Models::Group<double>> groups(groups_count);
+    for (size_t i=0; i<groups_count; ++i) {
+        for (const auto& point : make_points(generator, 100 + i % 400)) {
+            groups[i].add_point(point);
+        }
+    }
+    std::deque<Types::PackedPoints<double>> packed_groups;
+    std::deque<SpatialBucketIndex<double>> groups_indexes;
+    for (const auto& group : groups) {
+        packed_groups.emplace_back(group.get_points());
+        groups_indexes.emplace_back(group.get_points(), diameter);
+    }
+    logger.notice("Generated", groups_count, "groups with 100 to 500 points each");
+
+    // benchmark, for several query sizes
+    Scorer scorer(Scorer::Sphere, diameter);
+    for (const size_t query_size : {10, 100, 300, 1000}) {
+        const auto query = make_points(generator, query_size);
+        const Types::PackedPoints<double> packed_query(query);
+        const SpatialBucketIndex<double> query_index(query, diameter);
+        double t0 = Logging::Logger::get_millitime();
+        double expected = 0.0;
+        for (const auto& packed_group : packed_groups) {
+            expected += scorer.score(packed_group, packed_query);
+        }
+        const double packed_dt = Logging::Logger::get_millitime() - t0;
+        t0 = Logging::Logger::get_millitime();
+        double result = 0.0;
+        for (const auto& group_index : groups_indexes) {
+            result += scorer.score(group_index, query_index);
+        }
+        const double grid_dt = Logging::Logger::get_millitime() - t0;
+        if (std::abs(result - expected) > 1e-9 * std::max(std::abs(expected), 1.0)) {
+            except("Benchmark results differ for query size", query_size, ":", result, "instead of", expected);
+        }
+        logger.message("Query of", query_size, "points, packed:", packed_dt, "s, grid:", grid_dt, "s");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
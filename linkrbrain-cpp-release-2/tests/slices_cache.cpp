@@ -0,0 +1,145 @@
+#include "LinkRbrain/PDF/SlicesCache.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using LinkRbrain::PDF::SlicesCache;
+
+
+static const size_t threads_count = 8;
+static const size_t requests_count = 250;
+static const size_t reports_count = 100;
+static const std::vector<std::string> planes = {"yzx", "xzy", "xyz"};
+
+
+// origins of 2D views, in millimeters, as in `QueryDocument::add_2d_view_section`
+
+struct Origins {
+    std::mt19937 generator;
+    std::uniform_int_distribution<int> coordinate;
+    Origins(const int seed) : generator(seed), coordinate(-70, 70) {}
+    inline const int operator() () {
+        return coordinate(generator);
+    }
+};
+
+const bool is_png(const std::string& buffer) {
+    return buffer.size() > 8 && buffer.compare(0, 8, "\x89PNG\r\n\x1a\n") == 0;
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("slices");
+
+    // crops of one image share its decoded surface
+    {
+        SlicesCache cache;
+        for (const int position : {-20, -19, 0, 15, -20}) {
+            for (const std::string& plane : planes) {
+                const SlicesCache::PNG png = cache.get_cached_png_slice(plane, position);
+                if (!is_png(*png)) {
+                    except("Slice should be encoded as PNG");
+                }
+                if (*png != cache.get_png_slice(SlicesCache::get_slice(plane, position))) {
+                    except("Cached slice should be identical to a computed one");
+                }
+            }
+        }
+        const SlicesCache::Stats stats = cache.get_stats();
+        if (stats.surfaces.misses != 3 || stats.surfaces.count != 3) {
+            except("Each source image should only be decoded once, got", stats.surfaces.misses);
+        }
+        // -20 & -19 give the same crop, -20 is requested twice
+        if (stats.pngs.misses != 9 || stats.pngs.hits != 6) {
+            except("Same crops should be served from cache, got", stats.pngs.hits, "hits &", stats.pngs.misses, "misses");
+        }
+    }
+    logger.message("Source images are decoded once");
+
+    // bounded encoded slices
+    {
+        SlicesCache cache("var/www/images/brain", 64 << 20, 64 << 10);
+        Origins origin(1);
+        for (size_t i=0; i<200; ++i) {
+            cache.get_cached_png_slice(planes[i % 3], origin());
+        }
+        const SlicesCache::Stats stats = cache.get_stats();
+        if (stats.pngs.evictions == 0 || stats.pngs.size > (64 << 10)) {
+            except("Encoded slices should be evicted beyond the maximum size");
+        }
+        logger.message("Kept", stats.pngs.count, "slices in", stats.pngs.size, "bytes, after", stats.pngs.evictions, "evictions");
+    }
+
+    // concurrent accesses
+    {
+        SlicesCache reference_cache;
+        SlicesCache cache("var/www/images/brain", 64 << 20, 256 << 10);
+        std::atomic<size_t> wrong_count(0);
+        std::vector<std::thread> threads;
+        for (size_t t=0; t<threads_count; ++t) {
+            threads.emplace_back([&, t] {
+                Origins origin(t);
+                for (size_t i=0; i<requests_count; ++i) {
+                    const std::string& plane = planes[(t + i) % 3];
+                    const int position = origin();
+                    if (*cache.get_cached_png_slice(plane, position) != *reference_cache.get_cached_png_slice(plane, position)) {
+                        ++wrong_count;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const SlicesCache::Stats stats = cache.get_stats();
+        if (wrong_count) {
+            except("Wrong slices were returned");
+        }
+        if (stats.pngs.hits + stats.pngs.misses != threads_count * requests_count || stats.pngs.size > (256 << 10)) {
+            except("Inconsistent stats after concurrent accesses");
+        }
+        logger.message(threads_count, "threads made", threads_count * requests_count, "requests:", stats.pngs.hits, "hits,", stats.pngs.misses, "misses,", stats.pngs.evictions, "evictions");
+    }
+
+    // benchmark on the 2D views of 100 reports
+    {
+        Origins origin(0);
+        std::vector<int> origins;
+        for (size_t i=0; i<3*reports_count; ++i) {
+            origins.push_back(origin());
+        }
+        size_t size = 0;
+        double t0 = Logging::Logger::get_millitime();
+        for (size_t r=0; r<reports_count; ++r) {
+            SlicesCache cache;
+            for (size_t p=0; p<3; ++p) {
+                size += cache.get_png_slice(SlicesCache::get_slice(planes[p], origins[3*r + p])).size();
+            }
+        }
+        const double uncached_dt = Logging::Logger::get_millitime() - t0;
+        SlicesCache cache;
+        t0 = Logging::Logger::get_millitime();
+        for (size_t r=0; r<reports_count; ++r) {
+            for (size_t p=0; p<3; ++p) {
+                size -= cache.get_cached_png_slice(planes[p], origins[3*r + p])->size();
+            }
+        }
+        const double cached_dt = Logging::Logger::get_millitime() - t0;
+        if (size != 0) {
+            except("Cache should not change slices");
+        }
+        const SlicesCache::Stats stats = cache.get_stats();
+        logger.message(reports_count, "reports, decoding every slice:", uncached_dt, "s, with cache:", cached_dt, "s (", stats.pngs.hits, "hits,", stats.pngs.misses, "misses)");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "Types/FlatMap.hpp"
+#include "Types/Variant.hpp"
+#include "Conversion/JSON.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <map>
+#include <random>
+#include <string>
+
+
+static const size_t groups_count = 20000;
+static const size_t benchmark_iterations_count = 10;
+
+
+// checks a flat map against `std::map` after the same operations
+
+template <typename FlatMapType, typename MapType>
+void compare(const FlatMapType& flatmap, const MapType& map) {
+    if (flatmap.size() != map.size()) {
+        except("Wrong size:", flatmap.size(), "instead of", map.size());
+    }
+    auto it = map.begin();
+    for (const auto& [key, value] : flatmap) {
+        if (key != it->first || value != it->second) {
+            except("Wrong item:", key, "instead of", it->first);
+        }
+        ++it;
+    }
+}
+
+// looks like what `DatasetController::serialize_groups` builds
+
+void serialize_groups(Types::Variant& destination, const std::vector<std::string>& labels, const Types::Variant& metadata) {
+    destination["data"].set_vector();
+    Types::VariantVector& groups = destination["data"].get_vector();
+    groups.reserve(labels.size());
+    int64_t id = 0;
+    for (const std::string& label : labels) {
+        groups.push_back({
+            {"id", ++id},
+            {"label", label},
+            {"metadata", metadata}
+        });
+    }
+    destination["total"] = (int64_t) labels.size();
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("flatmap");
+
+    // same behaviour as `std::map`, with both search strategies
+    for (const size_t keys_count : {5, 12, 200, 5000}) {
+        std::mt19937 generator(keys_count);
+        std::uniform_int_distribution<size_t> key(0, 2 * keys_count);
+        Types::FlatMap<std::string, int> flatmap;
+        std::map<std::string, int> map;
+        for (size_t i=0; i<4*keys_count; ++i) {
+            const std::string k = "key" + std::to_string(key(generator));
+            switch (i % 4) {
+                case 0:
+                    flatmap[k] = i;
+                    map[k] = i;
+                    break;
+                case 1:
+                    if (flatmap.insert({k, (int) i}).second != map.insert({k, (int) i}).second) {
+                        except("Insertion should not replace existing values");
+                    }
+                    break;
+                case 2:
+                    if (flatmap.erase(k) != map.erase(k)) {
+                        except("Wrong erased count");
+                    }
+                    break;
+                case 3:
+                    if (flatmap.count(k) != map.count(k) || (map.count(k) && flatmap.at(k) != map.at(k))) {
+                        except("Wrong lookup");
+                    }
+                    break;
+            }
+        }
+        compare(flatmap, map);
+        if (flatmap.find("missing") != flatmap.end()) {
+            except("Missing key was found");
+        }
+        try {
+            flatmap.at("missing");
+            except("Missing key was accessed");
+        } catch (const std::out_of_range&) {}
+    }
+    {
+        const Types::FlatMap<std::string, int> flatmap = {{"b", 1}, {"a", 2}, {"b", 3}};
+        compare(flatmap, std::map<std::string, int>{{"b", 1}, {"a", 2}, {"b", 3}});
+    }
+    logger.message("Flat maps behave like `std::map`");
+
+    // variants use flat maps and are written in the same order
+    {
+        Types::Variant variant;
+        variant["zeta"] = (int64_t) 1;
+        variant["alpha"] = "a";
+        variant["mu"]["nested"] = true;
+        variant["beta"].push_back(1.5);
+        variant["alpha"] = "b";
+        if (Conversion::JSON::serialize(variant) != R"({"alpha":"b","beta":[1.5],"mu":{"nested":true},"zeta":1})") {
+            except("Keys should be written sorted:", Conversion::JSON::serialize(variant));
+        }
+        if (variant.get_map().size() != 4 || !variant.get_map().count("mu") || variant.get_map().count("nested")) {
+            except("Wrong map size or lookup");
+        }
+        const Types::Variant initialized = {{"b", (int64_t) 1}, {"a", (int64_t) 2}, {"b", (int64_t) 3}};
+        if (Conversion::JSON::serialize(initialized) != R"({"a":2,"b":1})") {
+            except("First duplicate should win in initializer lists:", Conversion::JSON::serialize(initialized));
+        }
+        const std::map<std::string, int64_t> source = {{"y", 2}, {"x", 1}};
+        const Types::Variant converted = source;
+        if (Conversion::JSON::serialize(converted) != R"({"x":1,"y":2})" || (std::map<std::string, int64_t>) converted != source) {
+            except("Wrong conversion from and to `std::map`");
+        }
+        Types::Variant parsed;
+        Conversion::JSON::parse(R"({"d": 4, "c": {"f": 6, "e": 5}, "d": 7})", parsed);
+        if (Conversion::JSON::serialize(parsed) != R"({"c":{"e":5,"f":6},"d":7})") {
+            except("Parsed objects should be sorted, last duplicate winning:", Conversion::JSON::serialize(parsed));
+        }
+        if (parsed == converted || parsed != Types::Variant(parsed)) {
+            except("Wrong comparison");
+        }
+        {
+            Types::VariantArena arena;
+            Types::VariantArena::Scope scope(arena);
+            Types::Variant inside;
+            inside["key"] = "value";
+            if (inside.get_map().get_allocator().get_resource() != arena.get_resource()) {
+                except("Flat maps should be allocated in the arena");
+            }
+        }
+    }
+    logger.message("Variant maps are compatible with JSON output");
+
+    // benchmark on group descriptors
+    {
+        std::vector<std::string> labels;
+        for (size_t i=0; i<groups_count; ++i) {
+            labels.push_back("Group #" + std::to_string(i) + " of the dataset");
+        }
+        const Types::Variant metadata = {{"doi", "10.1000/182"}, {"year", (int64_t) 2019}, {"authors", "Someone et al."}};
+        size_t size;
+        double build_dt = 0.0, serialize_dt = 0.0;
+        for (size_t i=0; i<benchmark_iterations_count; ++i) {
+            Types::Variant response;
+            const double t0 = Logging::Logger::get_millitime();
+            serialize_groups(response, labels, metadata);
+            const double t1 = Logging::Logger::get_millitime();
+            size = Conversion::JSON::serialize(response).size();
+            const double t2 = Logging::Logger::get_millitime();
+            build_dt += t1 - t0;
+            serialize_dt += t2 - t1;
+        }
+        logger.message(groups_count, "group descriptors (", size, "bytes) built in", build_dt / benchmark_iterations_count, "s, serialized in", serialize_dt / benchmark_iterations_count, "s");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "Types/LRUCache.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+typedef std::shared_ptr<const std::string> Value;
+typedef Types::LRUCache<int, Value> Cache;
+
+
+static const size_t threads_count = 8;
+static const size_t operations_count = 100000;
+
+
+const Value make_value(const int key) {
+    return std::make_shared<const std::string>("value #" + std::to_string(key));
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("lrucache");
+
+    // least recently used values are evicted first
+    {
+        Cache cache(300, 1);
+        for (int key=0; key<3; ++key) {
+            cache.put(key, make_value(key), 100);
+        }
+        if (!cache.get(0)) {
+            except("Value should be cached");
+        }
+        cache.put(3, make_value(3), 100);
+        if (cache.get(1) || !cache.get(0) || !cache.get(2) || !cache.get(3)) {
+            except("Least recently used value should have been evicted");
+        }
+        const Value kept = cache.get(2);
+        cache.put(4, make_value(4), 250);
+        if (cache.get(0) || cache.get(2) || cache.get(3) || !cache.get(4) || *kept != "value #2") {
+            except("Large value should evict several others, which stay alive while used");
+        }
+        cache.put(5, make_value(5), 301);
+        if (cache.get(5) || !cache.get(4)) {
+            except("Values larger than the cache should not be stored");
+        }
+        cache.put(4, make_value(40), 50);
+        const Cache::Stats stats = cache.get_stats();
+        if (*cache.get(4) != "value #40" || stats.size != 50 || stats.count != 1) {
+            except("Value should be replaced, with its size");
+        }
+        if (stats.evictions != 4 || stats.hits != 7 || stats.misses != 5) {
+            except("Wrong stats:", stats.hits, "hits,", stats.misses, "misses,", stats.evictions, "evictions");
+        }
+        cache.set_max_size(10);
+        if (cache.get_stats().count != 0) {
+            except("Shrinking should evict");
+        }
+    }
+    logger.message("Least recently used values are evicted");
+
+    // shards share the size
+    {
+        Cache cache(16 * 1000, 16);
+        for (int key=0; key<1000; ++key) {
+            cache.put(key, make_value(key), 100);
+        }
+        const Cache::Stats stats = cache.get_stats();
+        if (cache.get_max_size() != 16 * 1000 || stats.size > 16 * 1000 || stats.count < 100 || stats.size != 100 * stats.count || stats.evictions != 1000 - stats.count) {
+            except("Wrong bound across shards");
+        }
+        size_t computed_count = 0;
+        for (int key=2000; key<2010; ++key) {
+            for (int i=0; i<3; ++i) {
+                cache.get_or_compute(key, [&computed_count, key] (size_t& size) {
+                    ++computed_count;
+                    size = 10;
+                    return make_value(key);
+                });
+            }
+        }
+        if (computed_count != 10) {
+            except("Values should only be computed once");
+        }
+    }
+    logger.message("Shards share the size");
+
+    // concurrent accesses
+    {
+        Cache cache(64 * 200, 8);
+        std::atomic<size_t> wrong_count(0);
+        std::vector<std::thread> threads;
+        const double t0 = Logging::Logger::get_millitime();
+        for (size_t t=0; t<threads_count; ++t) {
+            threads.emplace_back([&cache, &wrong_count, t] {
+                std::mt19937 generator(t);
+                std::uniform_int_distribution<int> key(0, 400);
+                for (size_t i=0; i<operations_count; ++i) {
+                    const int k = key(generator);
+                    const Value value = cache.get_or_compute(k, [k] (size_t& size) {
+                        size = 64;
+                        return make_value(k);
+                    });
+                    if (*value != "value #" + std::to_string(k)) {
+                        ++wrong_count;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const double dt = Logging::Logger::get_millitime() - t0;
+        const Cache::Stats stats = cache.get_stats();
+        if (wrong_count) {
+            except("Wrong values were returned");
+        }
+        if (stats.hits + stats.misses != threads_count * operations_count || stats.size > 64 * 200 || stats.size != 64 * stats.count) {
+            except("Inconsistent stats after concurrent accesses");
+        }
+        logger.message(threads_count, "threads made", threads_count * operations_count, "accesses in", dt, "s:", stats.hits, "hits,", stats.misses, "misses,", stats.evictions, "evictions");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include "Types/VariantArena.hpp"
+#include "Conversion/JSON.hpp"
+#include "Exceptions/Exception.hpp"
+#include "Logging/Loggers.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+
+
+static const size_t correlations_count = 20000;
+static const size_t benchmark_iterations_count = 10;
+
+
+// count every allocation made on the heap
+
+static std::atomic<size_t> allocations_count = 0;
+
+void* operator new(size_t size) {
+    ++allocations_count;
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+// not inlined, otherwise GCC sees `free` called on what `operator new` returned
+[[gnu::noinline]] void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+[[gnu::noinline]] void operator delete(void* pointer, size_t size) noexcept {
+    std::free(pointer);
+}
+// used by `std::pmr::new_delete_resource`
+void* operator new(size_t size, std::align_val_t alignment) {
+    ++allocations_count;
+    const size_t alignment_size = std::max(sizeof(void*), (size_t) alignment);
+    void* pointer;
+    if (posix_memalign(&pointer, alignment_size, size ? size : 1) == 0) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+    std::free(pointer);
+}
+[[gnu::noinline]] void operator delete(void* pointer, size_t size, std::align_val_t alignment) noexcept {
+    std::free(pointer);
+}
+
+
+// looks like what `DatasetController::format_query` builds
+
+struct Correlation {
+    int64_t id;
+    std::string label;
+    Types::Variant metadata;
+    std::vector<double> scores;
+};
+
+const std::vector<Correlation> make_correlations(const size_t count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> score(0, 1);
+    std::vector<Correlation> correlations(count);
+    for (size_t i=0; i<count; ++i) {
+        correlations[i].id = i;
+        correlations[i].label = "Group #" + std::to_string(i) + " of the dataset";
+        correlations[i].metadata = {{"doi", "10.1000/" + std::to_string(i)}, {"year", (int64_t) (1990 + i % 30)}};
+        correlations[i].scores = {score(generator), score(generator), score(generator), score(generator)};
+    }
+    return correlations;
+}
+
+void format_correlations(Types::Variant& destination, const std::vector<Correlation>& correlations) {
+    destination.set_vector();
+    Types::VariantVector& formatted_correlations = destination.get_vector();
+    for (const auto& correlation : correlations) {
+        formatted_correlations.push_back({
+            {"id", correlation.id},
+            {"label", correlation.label},
+            {"metadata", correlation.metadata},
+            {"scores", correlation.scores}});
+    }
+}
+
+const std::string make_query_body() {
+    Types::Variant body;
+    for (int g=0; g<3; ++g) {
+        Types::Variant& group = body["groups"].push_back();
+        group["label"] = "Group " + std::to_string(g);
+        for (int p=0; p<1000; ++p) {
+            group["points"].push_back({1.5 * p, -2.5 * p, 0.25 * p, 1.0});
+        }
+    }
+    return Conversion::JSON::serialize(body);
+}
+
+
+int main(int argc, char const *argv[]) {
+    Logging::add_output(Logging::Output::StandardError).set_color(true);
+    Logging::Logger& logger = Logging::get_logger("variant");
+
+    // containers are allocated from the arena only inside a scope
+    {
+        Types::VariantArena arena;
+        Types::Variant outside;
+        outside.set_vector();
+        if (outside.get_vector().get_allocator().get_resource() != std::pmr::new_delete_resource()) {
+            except("Variants should be allocated on the heap outside of arenas");
+        }
+        {
+            Types::VariantArena::Scope scope(arena);
+            Types::Variant inside;
+            inside["key"].set_vector();
+            if (inside.get_map().get_allocator().get_resource() != arena.get_resource() || inside["key"].get_vector().get_allocator().get_resource() != arena.get_resource()) {
+                except("Variants should be allocated in the arena inside a scope");
+            }
+            {
+                Types::VariantArena nested_arena;
+                Types::VariantArena::Scope nested_scope(nested_arena);
+                if (Types::variant_memory_resource != nested_arena.get_resource()) {
+                    except("Nested scope should use its own arena");
+                }
+            }
+            if (Types::variant_memory_resource != arena.get_resource()) {
+                except("Nested scope should restore the previous arena");
+            }
+        }
+        if (Types::variant_memory_resource != std::pmr::new_delete_resource()) {
+            except("Scope should restore the heap");
+        }
+    }
+    logger.message("Scopes select the memory resource");
+
+    // copies outlive their arena, moves keep it
+    {
+        std::string json;
+        Types::Variant copy;
+        {
+            Types::VariantArena arena;
+            Types::VariantArena::Scope scope(arena);
+            Types::Variant original;
+            Conversion::JSON::parse(R"({"a": [1, {"b": [2.5, "c"]}], "d": {"e": null}})", original);
+            json = Conversion::JSON::serialize(original);
+            const Types::Variant constructed_copy = original;
+            copy = original;
+            for (const Types::Variant* variant : {&constructed_copy, (const Types::Variant*) &copy}) {
+                if ((*variant)["a"].get_vector().get_allocator().get_resource() != std::pmr::new_delete_resource() || (*variant)["a"][1]["b"].get_vector().get_allocator().get_resource() != std::pmr::new_delete_resource()) {
+                    except("Copies should be allocated on the heap");
+                }
+            }
+            const Types::Variant moved = std::move(original);
+            if (moved.get_map().get_allocator().get_resource() != arena.get_resource()) {
+                except("Moved variants should stay in the arena");
+            }
+        }
+        if (Conversion::JSON::serialize(copy) != json) {
+            except("Copy should survive its arena");
+        }
+    }
+    logger.message("Copies are allocated on the heap");
+
+    // far fewer allocations for a parsed request
+    {
+        const std::string body = make_query_body();
+        size_t heap_count, arena_count;
+        {
+            const size_t count = allocations_count;
+            Types::Variant data;
+            Conversion::JSON::parse(body, data);
+            heap_count = allocations_count - count;
+        }
+        {
+            const size_t count = allocations_count;
+            Types::VariantArena arena;
+            Types::VariantArena::Scope scope(arena);
+            Types::Variant data;
+            Conversion::JSON::parse(body, data);
+            arena_count = allocations_count - count;
+        }
+        logger.message("Parsing a query with", heap_count, "allocations on the heap, with", arena_count, "in an arena");
+        if (arena_count * 20 > heap_count) {
+            except("Arena should save most allocations");
+        }
+    }
+
+    // benchmark on formatted correlations
+    {
+        const std::vector<Correlation> correlations = make_correlations(correlations_count);
+        size_t heap_count, arena_count, heap_size, arena_size;
+        size_t count = allocations_count;
+        double t0 = Logging::Logger::get_millitime();
+        for (size_t i=0; i<benchmark_iterations_count; ++i) {
+            Types::Variant response;
+            format_correlations(response["correlations"], correlations);
+            heap_size = Conversion::JSON::serialize(response).size();
+        }
+        const double heap_dt = (Logging::Logger::get_millitime() - t0) / benchmark_iterations_count;
+        heap_count = (allocations_count - count) / benchmark_iterations_count;
+        count = allocations_count;
+        t0 = Logging::Logger::get_millitime();
+        for (size_t i=0; i<benchmark_iterations_count; ++i) {
+            Types::VariantArena arena;
+            Types::VariantArena::Scope scope(arena);
+            Types::Variant response;
+            format_correlations(response["correlations"], correlations);
+            arena_size = Conversion::JSON::serialize(response).size();
+        }
+        const double arena_dt = (Logging::Logger::get_millitime() - t0) / benchmark_iterations_count;
+        arena_count = (allocations_count - count) / benchmark_iterations_count;
+        if (heap_size != arena_size) {
+            except("Arena should not change the result");
+        }
+        logger.message(correlations_count, "correlations formatted & serialized, heap:", heap_dt, "s (", heap_count, "allocations), arena:", arena_dt, "s (", arena_count, "allocations)");
+    }
+
+    // the end!
+    logger.message("All tests passed");
+    return 0;
+}
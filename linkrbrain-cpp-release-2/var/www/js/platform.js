@@ -461,8 +461,24 @@ var query = new (function(selector){
                 blocking: true
             });
         }
+        // computations run as background jobs: wait for them, then reload the query
+        var waitForJob = function(response, callback) {
+            if (!response.job || (response.job.status != 'queued' && response.job.status != 'running')) {
+                callback(response);
+                return;
+            }
+            setTimeout(function(){
+                requester.get('/jobs/' + response.job.id, function(job) {
+                    if (job.status == 'queued' || job.status == 'running') {
+                        waitForJob({job: job}, callback);
+                    } else {
+                        requester.get('/queries/' + queryData.id, callback);
+                    }
+                });
+            }, 500);
+        };
         // perform & interpret request
-        requester[method](url, data, function(response) {
+        requester[method](url, data, function(response) { waitForJob(response, function(response) {
             if (!skip_dialog_and_reload) {
                 if (!response.id){
                     queryNew();
@@ -499,7 +515,7 @@ var query = new (function(selector){
             if ($.isFunction(callback)) {
                 callback(response);
             }
-        }, function(error) {
+        }); }, function(error) {
             console.log('Server disagreed to this: ' + action + ' query.');
         });
     };
@@ -1744,31 +1760,41 @@ var query = new (function(selector){
                     return {x:x, y:y};
                 };
                 //    Draw edges
-                $.each(edges, function(i, row){
-                    var centerI = onscreenCoordinates(nodes[i]);
-                    var isGroup = (nodes[i].source == 'query');
-                    $.each(row, function(j, score){
-                        if (score > 0) {
-                            var color;
-                            if (nodes[i].source == 'query') {
-                                if (nodes[j].source == 'query') {
-                                    color = Raphael.hsb(0.5*(nodes[i].hue + nodes[j].hue), 0.8, 0.8);
-                                } else {
-                                    color = Raphael.hsb(nodes[i].hue, 0.8, 0.8);
-                                }
+                var drawEdge = function(i, j, score){
+                    if (score > 0) {
+                        var centerI = onscreenCoordinates(nodes[i]);
+                        var color;
+                        if (nodes[i].source == 'query') {
+                            if (nodes[j].source == 'query') {
+                                color = Raphael.hsb(0.5*(nodes[i].hue + nodes[j].hue), 0.8, 0.8);
                             } else {
-                                color = '#888';
+                                color = Raphael.hsb(nodes[i].hue, 0.8, 0.8);
                             }
-                            var centerJ = onscreenCoordinates(nodes[j]);
-                            var width =  Math.max(0.0, 3 + Math.log10(score));
-                            var opacity = width / 3.0;
-                            paper.line(centerI.x, centerI.y, centerJ.x, centerJ.y).attr({
-                                opacity: opacity,
-                                stroke: color,
-                                'stroke-width': width});
+                        } else {
+                            color = '#888';
                         }
+                        var centerJ = onscreenCoordinates(nodes[j]);
+                        var width =  Math.max(0.0, 3 + Math.log10(score));
+                        var opacity = width / 3.0;
+                        paper.line(centerI.x, centerI.y, centerJ.x, centerJ.y).attr({
+                            opacity: opacity,
+                            stroke: color,
+                            'stroke-width': width});
+                    }
+                };
+                if (settings.format == 'sparse') {
+                    //    List of [i, j, score]
+                    $.each(edges, function(k, edge){
+                        drawEdge(edge[0], edge[1], edge[2]);
                     });
-                });
+                } else {
+                    //    Matrix of scores
+                    $.each(edges, function(i, row){
+                        $.each(row, function(j, score){
+                            drawEdge(i, j, score);
+                        });
+                    });
+                }
                 //    Draw nodes
                 $.each(nodes, function(i){
                     var center = onscreenCoordinates(this);
@@ -2067,6 +2093,17 @@ var query = new (function(selector){
                 requester.post('/queries/' + queryData.id + '/pdf', exportPdfParameters, pdfCreateCallback);
             };
             pdfCreateCallback = function(response){
+                // rendering runs in background: poll until the file is available
+                if (response.status == 'queued' || response.status == 'running') {
+                    setTimeout(function(){
+                        requester.get('/queries/' + queryData.id + '/pdf/' + response.id, pdfCreateCallback);
+                    }, 500);
+                    return;
+                }
+                if (response.status != 'done') {
+                    liUpdate('failed.');
+                    return;
+                }
                 liUpdate('done.');
                 $('<a>').addClass('button').text('Click here to view the generated PDF').attr({
                     href: response.url,